@@ -7,6 +7,7 @@
 #include <boost/system/system_error.hpp>
 #include <functional>
 #include <unordered_map>
+#include "algorithms/Employee.h"
 
 template<typename T, typename... Args>
 std::unique_ptr<T> make_unique(Args&&... args)
@@ -228,18 +229,6 @@ TEST(algorithms, simple_sort) {
     std::sort(begin(v2), end(v2), [](int a, int b) {return std::abs(a) > std::abs(b);});
 }
 
-class Employee {
-public:
-    Employee(std::string first, std::string last, int sal): first_(first), last_(last), sal_(sal) {};
-    int getSalary() const {return sal_;};
-    std::string getSortingName() const {return last_ + ", " + first_;};
-    bool operator<(const Employee that) const {return sal_ < that.sal_;};       // needs < operator to use std::sort
-private:
-    std::string first_;
-    std::string last_;
-    int sal_;
-};
-
 TEST(algorithms, simple_sort2) {
     auto staff = std::vector<Employee> {
             {"Kate", "Greg", 1000},
@@ -0,0 +1,39 @@
+#include "Compact.h"
+
+namespace algorithms {
+namespace simd {
+
+namespace detail {
+
+namespace {
+
+constexpr LeftPackTables make_left_pack_tables() {
+    LeftPackTables tables{};
+    for (unsigned mask = 0; mask < 256; mask++) {
+        int kept = 0;
+        for (unsigned lane = 0; lane < 8; lane++) {
+            if (mask & (1u << lane)) {
+                tables.lanes32[mask][kept++] = lane;
+            }
+        }
+    }
+    for (unsigned mask = 0; mask < 16; mask++) {
+        int kept = 0;
+        for (unsigned lane = 0; lane < 4; lane++) {
+            if (mask & (1u << lane)) {
+                tables.lanes64[mask][kept++] = 2 * lane;
+                tables.lanes64[mask][kept++] = 2 * lane + 1;
+            }
+        }
+    }
+    return tables;
+}
+
+}// namespace
+
+constexpr LeftPackTables left_pack_tables = make_left_pack_tables();
+
+}// namespace detail
+
+}// namespace simd
+}// namespace algorithms
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "Simd.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ALGORITHMS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace algorithms {
+namespace simd {
+
+// Stream compaction
+// std::remove_if / copy_if branch on the predicate for every element: at 50% selectivity half of those branches are
+// mispredicted, and copy_if into a back_inserter grows the vector one element at a time. Here:
+// -> branchless: every element is written to the output position, the position only moves on when it is kept
+// -> avx2 left pack (4 and 8 byte types): the predicate results of one register of elements form a bit mask, a
+//    permute table entry moves the kept elements to the front, the whole register is stored and the output moves
+//    on by popcount(mask)
+// -> avx512: the compress instruction does the same for 16 / 8 elements without a table
+// The predicate is called once per element, in order (twice for the vector copy_if, which counts first to
+// allocate the result once). Element types of 1 and 2 bytes always use the branchless loop.
+
+namespace detail {
+
+struct alignas(32) LeftPackTables {
+    // for every mask: the lanes to move to the front, as 32 bit permute indices
+    uint32_t lanes32[256][8];
+    uint32_t lanes64[16][8];
+};
+
+extern const LeftPackTables left_pack_tables;
+
+template<typename T, typename Keep>
+unsigned keep_mask(const T *p, Keep &keep, int n) {
+    unsigned mask = 0;
+    for (int i = 0; i < n; i++) {
+        mask |= unsigned(bool(keep(p[i]))) << i;
+    }
+    return mask;
+}
+
+// out may be first (in place): the output never passes the input. Writes stop at out_end, which leaves room for
+// at least the kept elements.
+template<typename T, typename Keep>
+T *compact_branchless(const T *first, const T *last, T *out, T *out_end, Keep &keep) {
+    for (; first < last && out < out_end; first++) {
+        T x = *first;
+        *out = x;
+        out += bool(keep(x));
+    }
+    return out;
+}
+
+#ifdef ALGORITHMS_X86_SIMD
+template<typename T, typename Keep>
+__attribute__((target("avx2")))
+T *compact_avx2(const T *first, const T *last, T *out, T *out_end, Keep &keep) {
+    constexpr int lanes = 32 / sizeof(T);
+    // a register is stored whole: only while there is room for all of it
+    for (; last - first >= lanes && out_end - out >= lanes; first += lanes) {
+        auto mask = keep_mask(first, keep, lanes);
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+        auto indices = _mm256_load_si256(reinterpret_cast<const __m256i *>(
+                sizeof(T) == 4 ? left_pack_tables.lanes32[mask] : left_pack_tables.lanes64[mask]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_permutevar8x32_epi32(v, indices));
+        out += __builtin_popcount(mask);
+    }
+    return compact_branchless(first, last, out, out_end, keep);
+}
+
+template<typename T, typename Keep>
+__attribute__((target("avx512f")))
+T *compact_avx512(const T *first, const T *last, T *out, T *out_end, Keep &keep) {
+    constexpr int lanes = 64 / sizeof(T);
+    for (; last - first >= lanes && out_end - out >= lanes; first += lanes) {
+        auto mask = keep_mask(first, keep, lanes);
+        auto v = _mm512_loadu_si512(first);
+        auto packed = sizeof(T) == 4 ? _mm512_maskz_compress_epi32(__mmask16(mask), v)
+                                     : _mm512_maskz_compress_epi64(__mmask8(mask), v);
+        _mm512_storeu_si512(out, packed);
+        out += __builtin_popcount(mask);
+    }
+    return compact_branchless(first, last, out, out_end, keep);
+}
+#endif
+
+template<typename T>
+using is_packable = std::integral_constant<bool, sizeof(T) == 4 || sizeof(T) == 8>;
+
+template<typename T, typename Keep>
+T *compact(const T *first, const T *last, T *out, T *out_end, Keep &keep, Kernel kernel, std::true_type) {
+#ifdef ALGORITHMS_X86_SIMD
+    if (kernel == Kernel::avx512) {
+        return compact_avx512(first, last, out, out_end, keep);
+    }
+    if (kernel == Kernel::avx2) {
+        return compact_avx2(first, last, out, out_end, keep);
+    }
+#endif
+    return compact_branchless(first, last, out, out_end, keep);
+}
+
+template<typename T, typename Keep>
+T *compact(const T *first, const T *last, T *out, T *out_end, Keep &keep, Kernel, std::false_type) {
+    return compact_branchless(first, last, out, out_end, keep);
+}
+
+template<typename T, typename Keep>
+T *compact(const T *first, const T *last, T *out, T *out_end, Keep &keep, Kernel kernel) {
+    static_assert(std::is_arithmetic<T>::value, "compaction is for arithmetic types");
+    return compact(first, last, out, out_end, keep, resolve(kernel), is_packable<T>());
+}
+
+// fixed size blocks: the compiler vectorizes those for simple predicates, an open ended loop it doesn't at -O2
+template<typename T, typename Keep>
+std::size_t count_branchless(const T *first, const T *last, Keep &keep) {
+    std::size_t n = 0;
+    for (; last - first >= 256; first += 256) {
+        uint32_t block = 0;
+        for (int i = 0; i < 256; i++) {
+            block += bool(keep(first[i]));
+        }
+        n += block;
+    }
+    for (; first < last; first++) {
+        n += bool(keep(*first));
+    }
+    return n;
+}
+
+#ifdef ALGORITHMS_X86_SIMD
+template<typename T, typename Keep>
+__attribute__((target("avx2")))
+std::size_t count_avx2(const T *first, const T *last, Keep &keep) {
+    return count_branchless(first, last, keep);
+}
+#endif
+
+}// namespace detail
+
+// std::count_if without a branch per element
+template<typename T, typename Predicate>
+std::size_t count_if(const T *first, const T *last, Predicate pred, Kernel kernel = Kernel::automatic) {
+#ifdef ALGORITHMS_X86_SIMD
+    if (resolve(kernel) >= Kernel::avx2) {
+        return detail::count_avx2(first, last, pred);
+    }
+#endif
+    return detail::count_branchless(first, last, pred);
+}
+
+// same as std::remove_if: the kept elements are moved to the front, the new end is returned
+template<typename T, typename Predicate>
+T *remove_if(T *first, T *last, Predicate pred, Kernel kernel = Kernel::automatic) {
+    auto keep = [&pred](const T &x) { return !pred(x); };
+    return detail::compact(first, last, first, last, keep, kernel);
+}
+
+// same as std::copy_if, but out must have room for last - first elements: the left pack stores whole registers
+template<typename T, typename Predicate>
+T *copy_if(const T *first, const T *last, T *out, Predicate pred, Kernel kernel = Kernel::automatic) {
+    return detail::compact(first, last, out, out + (last - first), pred, kernel);
+}
+
+// the elements of v for which pred is true, counted first so the result is allocated once
+template<typename T, typename Predicate>
+std::vector<T> copy_if(const std::vector<T> &v, Predicate pred, Kernel kernel = Kernel::automatic) {
+    auto first = v.data();
+    auto last = first + v.size();
+    std::vector<T> result(count_if(first, last, pred, kernel));
+    detail::compact(first, last, result.data(), result.data() + result.size(), pred, kernel);
+    return result;
+}
+
+// v.erase(std::remove_if(...), v.end()) in one pass
+template<typename T, typename Predicate>
+void erase_if(std::vector<T> &v, Predicate pred, Kernel kernel = Kernel::automatic) {
+    v.resize(remove_if(v.data(), v.data() + v.size(), pred, kernel) - v.data());
+}
+
+}// namespace simd
+}// namespace algorithms
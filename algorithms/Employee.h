@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+class Employee {
+public:
+    Employee(std::string first, std::string last, int sal): first_(first), last_(last), sal_(sal) {};
+    int getSalary() const {return sal_;};
+    const std::string& getFirstName() const {return first_;};
+    const std::string& getLastName() const {return last_;};
+    std::string getSortingName() const {return last_ + ", " + first_;};
+    bool operator<(const Employee that) const {return sal_ < that.sal_;};       // needs < operator to use std::sort
+private:
+    std::string first_;
+    std::string last_;
+    int sal_;
+};
@@ -0,0 +1,17 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace algorithms {
+
+std::size_t default_parallelism() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+boost::asio::thread_pool &default_pool() {
+    static boost::asio::thread_pool pool(default_parallelism());
+    return pool;
+}
+
+}// namespace algorithms
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+namespace algorithms {
+
+// shared pool for the parallel algorithms, one thread per core
+boost::asio::thread_pool &default_pool();
+
+std::size_t default_parallelism();
+
+// Runs f(0) ... f(tasks - 1) on the pool and waits for all of them; the first exception is rethrown.
+// Must not be called from a task on the same pool: the caller blocks without helping.
+template<typename F>
+void parallel_for(std::size_t tasks, F &&f, boost::asio::thread_pool &pool = default_pool()) {
+    if (tasks == 1) {
+        f(std::size_t(0));
+        return;
+    }
+    std::mutex mutex;
+    std::condition_variable done;
+    std::size_t remaining = tasks;
+    std::exception_ptr error;
+    for (std::size_t i = 0; i < tasks; i++) {
+        boost::asio::post(pool, [&, i]() {
+            std::exception_ptr caught;
+            try {
+                f(i);
+            } catch (...) {
+                caught = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (caught && !error) {
+                error = caught;
+            }
+            if (--remaining == 0) {
+                done.notify_one();
+            }
+        });
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return remaining == 0; });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+}// namespace algorithms
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace algorithms {
+namespace pipeline {
+
+// Fused pipelines
+// std::generate_n -> std::transform -> std::copy_if through back_inserters (algorithms.cpp) makes one pass and one
+// full vector per stage. Here the stages are composed first and run in one pass, without intermediate vectors:
+//     pipeline::generate_n(n, g) | pipeline::transform(f) | pipeline::filter(p) | pipeline::into(v)
+// -> every element is pushed through the whole chain before the next one is produced; each stage is a small sink
+//    object calling the next one, which the compiler inlines into a single loop
+// -> unfiltered chains know their size: into() allocates once and writes through a pointer, a loop the compiler
+//    vectorizes for simple stages as it does std::transform (-O3: it checks at run time that input and output don't
+//    overlap, the -O2 cost model doesn't)
+// -> filtered chains of trivially copyable values are collected branchless: every value is written to a block buffer,
+//    the position only moves on when it is kept
+// A stage only sees the values the stages before it kept, each function is called once per value, in order.
+// Nothing runs until a terminal (into / to_vector) is applied; a pipeline runs once.
+
+namespace detail {
+
+constexpr std::size_t block_size = 256;
+
+template<typename Next, typename Function>
+class TransformSink {
+public:
+    TransformSink(Next &next, Function &f) : next_(next), f_(f) {}
+
+    template<typename X>
+    void operator()(X &&x) { next_(f_(std::forward<X>(x))); }
+
+    template<typename X>
+    void push_if(X &&x, bool keep) {
+        if (keep) {
+            (*this)(std::forward<X>(x));
+        }
+    }
+
+private:
+    Next &next_;
+    Function &f_;
+};
+
+template<typename Next, typename Predicate>
+class FilterSink {
+public:
+    FilterSink(Next &next, Predicate &p) : next_(next), p_(p) {}
+
+    template<typename X>
+    void operator()(X &&x) {
+        bool keep = p_(x);
+        next_.push_if(std::forward<X>(x), keep);
+    }
+
+    template<typename X>
+    void push_if(X &&x, bool keep) {
+        if (keep) {
+            (*this)(std::forward<X>(x));
+        }
+    }
+
+private:
+    Next &next_;
+    Predicate &p_;
+};
+
+// sized chains of trivially copyable values: into storage allocated up front
+template<typename T>
+class WriteSink {
+public:
+    explicit WriteSink(T *out) : out_(out) {}
+
+    template<typename X>
+    void operator()(X &&x) { *out_++ = std::forward<X>(x); }
+
+private:
+    T *out_;
+};
+
+template<typename T>
+class PushBackSink {
+public:
+    explicit PushBackSink(std::vector<T> &out) : out_(out) {}
+
+    template<typename X>
+    void operator()(X &&x) { out_.push_back(std::forward<X>(x)); }
+
+    template<typename X>
+    void push_if(X &&x, bool keep) {
+        if (keep) {
+            out_.push_back(std::forward<X>(x));
+        }
+    }
+
+private:
+    std::vector<T> &out_;
+};
+
+// filtered chains of trivially copyable values: a dropped value is written too and overwritten by the next one, so
+// the filter doesn't branch; full blocks are appended to out at once
+template<typename T>
+class BufferSink {
+public:
+    explicit BufferSink(std::vector<T> &out) : out_(out) {}
+
+    template<typename X>
+    void operator()(X &&x) { push_if(std::forward<X>(x), true); }
+
+    template<typename X>
+    void push_if(X &&x, bool keep) {
+        buffer_[size_] = std::forward<X>(x);
+        size_ += keep;
+        if (size_ == block_size) {
+            flush();
+        }
+    }
+
+    void flush() {
+        out_.insert(out_.end(), buffer_, buffer_ + size_);
+        size_ = 0;
+    }
+
+private:
+    std::vector<T> &out_;
+    T buffer_[block_size];
+    std::size_t size_ = 0;
+};
+
+}// namespace detail
+
+// Sources: value_type, sized (size() is the exact number of values) and run(sink), which pushes every value into sink
+
+template<typename It>
+class Range {
+public:
+    using value_type = typename std::iterator_traits<It>::value_type;
+    static constexpr bool sized = std::is_base_of<std::random_access_iterator_tag,
+            typename std::iterator_traits<It>::iterator_category>::value;
+
+    Range(It first, It last) : first_(first), last_(last) {}
+
+    std::size_t size() const { return std::distance(first_, last_); }
+
+    template<typename Sink>
+    void run(Sink &sink) {
+        for (auto it = first_; it != last_; ++it) {
+            sink(*it);
+        }
+    }
+
+private:
+    It first_;
+    It last_;
+};
+
+template<typename Generator>
+class Generate {
+public:
+    using value_type = std::decay_t<decltype(std::declval<Generator &>()())>;
+    static constexpr bool sized = true;
+
+    Generate(std::size_t n, Generator g) : n_(n), g_(std::move(g)) {}
+
+    std::size_t size() const { return n_; }
+
+    template<typename Sink>
+    void run(Sink &sink) {
+        for (std::size_t i = 0; i < n_; i++) {
+            sink(g_());
+        }
+    }
+
+private:
+    std::size_t n_;
+    Generator g_;
+};
+
+template<typename It>
+Range<It> from(It first, It last) { return {first, last}; }
+
+// the container must outlive the pipeline
+template<typename Container>
+Range<typename Container::const_iterator> from(const Container &c) { return {c.begin(), c.end()}; }
+
+// n values of g(), as std::generate_n
+template<typename Generator>
+Generate<Generator> generate_n(std::size_t n, Generator g) { return {n, std::move(g)}; }
+
+// Stages
+
+template<typename Function>
+struct Transform {
+    Function f;
+};
+
+template<typename Predicate>
+struct Filter {
+    Predicate p;
+};
+
+template<typename Function>
+Transform<Function> transform(Function f) { return {std::move(f)}; }
+
+// keeps the values for which p is true
+template<typename Predicate>
+Filter<Predicate> filter(Predicate p) { return {std::move(p)}; }
+
+template<typename Source, typename Function>
+class Transformed {
+public:
+    using value_type = std::decay_t<decltype(std::declval<Function &>()(std::declval<typename Source::value_type>()))>;
+    static constexpr bool sized = Source::sized;
+
+    Transformed(Source source, Function f) : source_(std::move(source)), f_(std::move(f)) {}
+
+    std::size_t size() const { return source_.size(); }
+
+    template<typename Sink>
+    void run(Sink &sink) {
+        detail::TransformSink<Sink, Function> stage(sink, f_);
+        source_.run(stage);
+    }
+
+private:
+    Source source_;
+    Function f_;
+};
+
+template<typename Source, typename Predicate>
+class Filtered {
+public:
+    using value_type = typename Source::value_type;
+    static constexpr bool sized = false;
+
+    Filtered(Source source, Predicate p) : source_(std::move(source)), p_(std::move(p)) {}
+
+    template<typename Sink>
+    void run(Sink &sink) {
+        detail::FilterSink<Sink, Predicate> stage(sink, p_);
+        source_.run(stage);
+    }
+
+private:
+    Source source_;
+    Predicate p_;
+};
+
+template<typename Source, typename Function>
+Transformed<Source, Function> operator|(Source source, Transform<Function> stage) {
+    return {std::move(source), std::move(stage.f)};
+}
+
+template<typename Source, typename Predicate>
+Filtered<Source, Predicate> operator|(Source source, Filter<Predicate> stage) {
+    return {std::move(source), std::move(stage.p)};
+}
+
+// Terminals: run the pipeline
+
+template<typename T>
+struct Into {
+    std::vector<T> &out;
+};
+
+struct ToVector {
+};
+
+// appends the values to out
+template<typename T>
+Into<T> into(std::vector<T> &out) { return {out}; }
+
+inline ToVector to_vector() { return {}; }
+
+namespace detail {
+
+template<typename T>
+using is_bufferable = std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                                   std::is_default_constructible<T>::value>;
+
+template<typename Source, typename T>
+void collect(Source &source, std::vector<T> &out, std::true_type /*sized*/, std::true_type /*bufferable*/) {
+    auto size = out.size();
+    out.resize(size + source.size());
+    WriteSink<T> sink(out.data() + size);
+    source.run(sink);
+}
+
+template<typename Source, typename T>
+void collect(Source &source, std::vector<T> &out, std::false_type /*sized*/, std::true_type /*bufferable*/) {
+    BufferSink<T> sink(out);
+    source.run(sink);
+    sink.flush();
+}
+
+template<typename Source, typename T>
+void collect(Source &source, std::vector<T> &out, std::true_type /*sized*/, std::false_type /*bufferable*/) {
+    out.reserve(out.size() + source.size());
+    PushBackSink<T> sink(out);
+    source.run(sink);
+}
+
+template<typename Source, typename T>
+void collect(Source &source, std::vector<T> &out, std::false_type /*sized*/, std::false_type /*bufferable*/) {
+    PushBackSink<T> sink(out);
+    source.run(sink);
+}
+
+}// namespace detail
+
+template<typename Source, typename T>
+std::vector<T> &operator|(Source source, Into<T> terminal) {
+    detail::collect(source, terminal.out, std::integral_constant<bool, Source::sized>(),
+                    detail::is_bufferable<T>());
+    return terminal.out;
+}
+
+template<typename Source>
+std::vector<typename Source::value_type> operator|(Source source, ToVector) {
+    std::vector<typename Source::value_type> result;
+    std::move(source) | into(result);
+    return result;
+}
+
+}// namespace pipeline
+}// namespace algorithms
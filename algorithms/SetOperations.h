@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace algorithms {
+
+// how set_intersection / set_difference / set_union match the two inputs
+enum class SetMethod {
+    automatic,
+    nested_loop, // n * m comparisons, for a handful of elements
+    hash,        // hash join: n + m hashes
+    merge,       // sorted inputs only: one step through both
+    gallop       // sorted inputs only: exponential search in the larger one, for skewed sizes
+};
+
+// automatic: merge / gallop when both inputs are sorted (gallop from this size ratio on), nested_loop below this
+// many pairs, hash otherwise
+constexpr std::size_t gallop_ratio = 32;
+constexpr std::size_t nested_loop_pairs = 256;
+
+namespace detail {
+
+// Open addressing index over values that live elsewhere (the inputs): ids are given out in insertion order, a slot
+// holds the id and 32 bits of the hash, so a probe compares values only when those bits match. Linear probing, at
+// most half full, up to 2^32 - 1 values.
+template<typename T, typename Hash, typename Equal>
+class HashIndex {
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    HashIndex(std::size_t capacity, const Hash &hash, const Equal &equal) : hash_(hash), equal_(equal) {
+        std::size_t slots = 16;
+        while (slots < 2 * capacity) {
+            slots *= 2;
+        }
+        slots_.resize(slots);
+        mask_ = slots - 1;
+        values_.reserve(capacity);
+    }
+
+    // id of value, added when it's new
+    std::pair<uint32_t, bool> insert(const T &value) {
+        auto h = mix(value);
+        for (auto i = h & mask_;; i = (i + 1) & mask_) {
+            auto &slot = slots_[i];
+            if (slot.id == 0) {
+                values_.push_back(&value);
+                slot = {static_cast<uint32_t>(values_.size()), static_cast<uint32_t>(h >> 32)};
+                return {slot.id - 1, true};
+            }
+            if (slot.hash == static_cast<uint32_t>(h >> 32) && equal_(*values_[slot.id - 1], value)) {
+                return {slot.id - 1, false};
+            }
+        }
+    }
+
+    uint32_t find(const T &value) const {
+        auto h = mix(value);
+        for (auto i = h & mask_;; i = (i + 1) & mask_) {
+            auto &slot = slots_[i];
+            if (slot.id == 0) {
+                return npos;
+            }
+            if (slot.hash == static_cast<uint32_t>(h >> 32) && equal_(*values_[slot.id - 1], value)) {
+                return slot.id - 1;
+            }
+        }
+    }
+
+    std::size_t size() const { return values_.size(); }
+
+    const T &operator[](uint32_t id) const { return *values_[id]; }
+
+private:
+    struct Slot {
+        uint32_t id; // id + 1, 0 is empty
+        uint32_t hash;
+    };
+
+    // std::hash of an integer is the integer: spread it over all 64 bits
+    uint64_t mix(const T &value) const { return uint64_t(hash_(value)) * 0x9e3779b97f4a7c15ull; }
+
+    Hash hash_;
+    Equal equal_;
+    std::vector<Slot> slots_;
+    std::size_t mask_;
+    std::vector<const T *> values_;
+};
+
+// first position at or after i where !(v[position] < value), searched with steps of 1, 2, 4, ... and then a binary
+// search in the last step: log(distance) comparisons instead of distance
+template<typename T, typename Compare>
+std::size_t gallop(const std::vector<T> &v, std::size_t i, const T &value, Compare &less) {
+    std::size_t step = 1;
+    auto low = i;
+    auto high = i;
+    while (high < v.size() && less(v[high], value)) {
+        low = high + 1;
+        high = i + step;
+        step *= 2;
+    }
+    high = std::min(high, v.size());
+    return std::lower_bound(v.begin() + low, v.begin() + high, value, less) - v.begin();
+}
+
+// Walks two sorted inputs in step: runs of only_a, then of only_b values, or a value in both. The runs are skipped
+// at once with galloping, or one element at a time for merge.
+template<typename T, typename Compare, typename OnlyA, typename Both, typename OnlyB>
+void walk_sorted(const std::vector<T> &a, const std::vector<T> &b, Compare less, bool galloping, OnlyA only_a,
+                 Both both, OnlyB only_b) {
+    auto skip = [&](const std::vector<T> &v, std::size_t i, const T &value) {
+        if (galloping) {
+            return gallop(v, i, value, less);
+        }
+        while (i < v.size() && less(v[i], value)) {
+            i++;
+        }
+        return i;
+    };
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (less(a[i], b[j])) {
+            auto end = skip(a, i, b[j]);
+            only_a(i, end);
+            i = end;
+        } else if (less(b[j], a[i])) {
+            auto end = skip(b, j, a[i]);
+            only_b(j, end);
+            j = end;
+        } else {
+            auto &value = a[i];
+            both(value);
+            while (i < a.size() && !less(value, a[i])) {
+                i++;
+            }
+            while (j < b.size() && !less(value, b[j])) {
+                j++;
+            }
+        }
+    }
+    only_a(i, a.size());
+    only_b(j, b.size());
+}
+
+// appends v[first, last) without the repeated values
+template<typename T, typename Compare>
+void append_unique(std::vector<T> &result, const std::vector<T> &v, std::size_t first, std::size_t last,
+                   Compare &less) {
+    for (auto i = first; i < last; i++) {
+        if (i == first || less(v[i - 1], v[i])) {
+            result.push_back(v[i]);
+        }
+    }
+}
+
+template<typename T, typename Compare>
+SetMethod choose(const std::vector<T> &a, const std::vector<T> &b, SetMethod method, Compare &less) {
+    if (method != SetMethod::automatic) {
+        return method;
+    }
+    auto small = std::min(a.size(), b.size());
+    auto large = std::max(a.size(), b.size());
+    if (std::is_sorted(a.begin(), a.end(), less) && std::is_sorted(b.begin(), b.end(), less)) {
+        return large >= gallop_ratio * small ? SetMethod::gallop : SetMethod::merge;
+    }
+    return small * large <= nested_loop_pairs ? SetMethod::nested_loop : SetMethod::hash;
+}
+
+template<typename T, typename Equal>
+bool contains(const std::vector<T> &v, const T &value, Equal &equal) {
+    return std::any_of(v.begin(), v.end(), [&](const T &x) { return equal(x, value); });
+}
+
+}// namespace detail
+
+// Set operations on vectors, the inputs are taken as sets: results hold every value once. Intersection and
+// difference keep the order of a, union is a followed by the new values of b; for sorted inputs (merge / gallop)
+// that means sorted results. merge and gallop don't check that the inputs are sorted, automatic does.
+// Values must be hashable (Hash / Equal) and ordered (Compare).
+
+template<typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>, typename Compare = std::less<T>>
+std::vector<T> set_intersection(const std::vector<T> &a, const std::vector<T> &b,
+                                SetMethod method = SetMethod::automatic, Hash hash = Hash(), Equal equal = Equal(),
+                                Compare less = Compare()) {
+    std::vector<T> result;
+    auto chosen = detail::choose(a, b, method, less);
+    switch (chosen) {
+        case SetMethod::nested_loop:
+            for (auto &x : a) {
+                if (detail::contains(b, x, equal) && !detail::contains(result, x, equal)) {
+                    result.push_back(x);
+                }
+            }
+            break;
+        case SetMethod::merge:
+        case SetMethod::gallop:
+            detail::walk_sorted(a, b, less, chosen == SetMethod::gallop, [](std::size_t, std::size_t) {},
+                                [&](const T &x) { result.push_back(x); }, [](std::size_t, std::size_t) {});
+            break;
+        default:
+            if (b.size() <= a.size()) {
+                // index the smaller input, probe with a: a's order comes for free
+                detail::HashIndex<T, Hash, Equal> index(b.size(), hash, equal);
+                for (auto &x : b) {
+                    index.insert(x);
+                }
+                std::vector<char> emitted(index.size());
+                for (auto &x : a) {
+                    auto id = index.find(x);
+                    if (id != index.npos && !emitted[id]) {
+                        emitted[id] = 1;
+                        result.push_back(x);
+                    }
+                }
+            } else {
+                // ids are in order of first appearance in a
+                detail::HashIndex<T, Hash, Equal> index(a.size(), hash, equal);
+                for (auto &x : a) {
+                    index.insert(x);
+                }
+                std::vector<char> found(index.size());
+                for (auto &x : b) {
+                    auto id = index.find(x);
+                    if (id != index.npos) {
+                        found[id] = 1;
+                    }
+                }
+                for (uint32_t id = 0; id < index.size(); id++) {
+                    if (found[id]) {
+                        result.push_back(index[id]);
+                    }
+                }
+            }
+    }
+    return result;
+}
+
+// the values of a that are not in b
+template<typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>, typename Compare = std::less<T>>
+std::vector<T> set_difference(const std::vector<T> &a, const std::vector<T> &b,
+                              SetMethod method = SetMethod::automatic, Hash hash = Hash(), Equal equal = Equal(),
+                              Compare less = Compare()) {
+    std::vector<T> result;
+    auto chosen = detail::choose(a, b, method, less);
+    switch (chosen) {
+        case SetMethod::nested_loop:
+            for (auto &x : a) {
+                if (!detail::contains(b, x, equal) && !detail::contains(result, x, equal)) {
+                    result.push_back(x);
+                }
+            }
+            break;
+        case SetMethod::merge:
+        case SetMethod::gallop:
+            detail::walk_sorted(a, b, less, chosen == SetMethod::gallop,
+                                [&](std::size_t first, std::size_t last) {
+                                    detail::append_unique(result, a, first, last, less);
+                                },
+                                [](const T &) {}, [](std::size_t, std::size_t) {});
+            break;
+        default: {
+            // a is indexed in any case, to drop its repeated values
+            detail::HashIndex<T, Hash, Equal> index(a.size(), hash, equal);
+            for (auto &x : a) {
+                index.insert(x);
+            }
+            std::vector<char> in_b(index.size());
+            for (auto &x : b) {
+                auto id = index.find(x);
+                if (id != index.npos) {
+                    in_b[id] = 1;
+                }
+            }
+            for (uint32_t id = 0; id < index.size(); id++) {
+                if (!in_b[id]) {
+                    result.push_back(index[id]);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+template<typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>, typename Compare = std::less<T>>
+std::vector<T> set_union(const std::vector<T> &a, const std::vector<T> &b, SetMethod method = SetMethod::automatic,
+                         Hash hash = Hash(), Equal equal = Equal(), Compare less = Compare()) {
+    std::vector<T> result;
+    auto chosen = detail::choose(a, b, method, less);
+    switch (chosen) {
+        case SetMethod::nested_loop:
+            for (auto *v : {&a, &b}) {
+                for (auto &x : *v) {
+                    if (!detail::contains(result, x, equal)) {
+                        result.push_back(x);
+                    }
+                }
+            }
+            break;
+        case SetMethod::merge:
+        case SetMethod::gallop:
+            detail::walk_sorted(a, b, less, chosen == SetMethod::gallop,
+                                [&](std::size_t first, std::size_t last) {
+                                    detail::append_unique(result, a, first, last, less);
+                                },
+                                [&](const T &x) { result.push_back(x); },
+                                [&](std::size_t first, std::size_t last) {
+                                    detail::append_unique(result, b, first, last, less);
+                                });
+            break;
+        default: {
+            detail::HashIndex<T, Hash, Equal> index(a.size() + b.size(), hash, equal);
+            for (auto *v : {&a, &b}) {
+                for (auto &x : *v) {
+                    index.insert(x);
+                }
+            }
+            result.reserve(index.size());
+            for (uint32_t id = 0; id < index.size(); id++) {
+                result.push_back(index[id]);
+            }
+        }
+    }
+    return result;
+}
+
+}// namespace algorithms
@@ -0,0 +1,537 @@
+#include "Simd.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ALGORITHMS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// The kernels below are written once against a traits type per instruction set and type (load, set1, min, max,
+// mask_eq, count_eq). The avx2 instantiations are flattened into target("avx2") entry points, so no avx vector ever
+// crosses a call boundary; gcc still warns about the abi of the uninlined templates.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace algorithms {
+namespace simd {
+
+namespace {
+
+template<typename T>
+struct Scalar {
+    using value_type = T;
+    using V = T;
+    using Counter = std::size_t;
+    static constexpr int width = 1;
+
+    static V load(const T *p) { return *p; }
+
+    static void store(T *p, V v) { *p = v; }
+
+    static V set1(T v) { return v; }
+
+    static V min(V a, V b) { return b < a ? b : a; }
+
+    static V max(V a, V b) { return a < b ? b : a; }
+
+    static unsigned mask_eq(V a, V b) { return a == b; }
+
+    static Counter zero() { return 0; }
+
+    static Counter count_eq(Counter c, V a, V b) { return c + (a == b); }
+
+    static std::size_t total(Counter c) { return c; }
+};
+
+#ifdef ALGORITHMS_X86_SIMD
+// per lane counters: a compare mask is -1 per matching lane, subtracting it counts the match
+inline std::size_t lane_total(const uint32_t *lanes, int width) {
+    std::size_t total = 0;
+    for (int i = 0; i < width; i++) {
+        total += lanes[i];
+    }
+    return total;
+}
+
+template<typename T>
+struct Sse2;
+
+template<>
+struct Sse2<int32_t> {
+    using value_type = int32_t;
+    using V = __m128i;
+    using Counter = __m128i;
+    static constexpr int width = 4;
+
+    static V load(const int32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+
+    static void store(int32_t *p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+
+    static V set1(int32_t v) { return _mm_set1_epi32(v); }
+
+    // pminsd / pmaxsd are sse4.1
+    static V min(V a, V b) {
+        auto b_smaller = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(b_smaller, b), _mm_andnot_si128(b_smaller, a));
+    }
+
+    static V max(V a, V b) {
+        auto b_larger = _mm_cmpgt_epi32(b, a);
+        return _mm_or_si128(_mm_and_si128(b_larger, b), _mm_andnot_si128(b_larger, a));
+    }
+
+    static unsigned mask_eq(V a, V b) { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+
+    static Counter zero() { return _mm_setzero_si128(); }
+
+    static Counter count_eq(Counter c, V a, V b) { return _mm_sub_epi32(c, _mm_cmpeq_epi32(a, b)); }
+
+    static std::size_t total(Counter c) {
+        uint32_t lanes[width];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), c);
+        return lane_total(lanes, width);
+    }
+};
+
+template<>
+struct Sse2<float> {
+    using value_type = float;
+    using V = __m128;
+    using Counter = __m128i;
+    static constexpr int width = 4;
+
+    static V load(const float *p) { return _mm_loadu_ps(p); }
+
+    static void store(float *p, V v) { _mm_storeu_ps(p, v); }
+
+    static V set1(float v) { return _mm_set1_ps(v); }
+
+    static V min(V a, V b) { return _mm_min_ps(a, b); }
+
+    static V max(V a, V b) { return _mm_max_ps(a, b); }
+
+    static unsigned mask_eq(V a, V b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+
+    static Counter zero() { return _mm_setzero_si128(); }
+
+    static Counter count_eq(Counter c, V a, V b) { return _mm_sub_epi32(c, _mm_castps_si128(_mm_cmpeq_ps(a, b))); }
+
+    static std::size_t total(Counter c) { return Sse2<int32_t>::total(c); }
+};
+
+template<typename T>
+struct Avx2;
+
+template<>
+struct Avx2<int32_t> {
+    using value_type = int32_t;
+    using V = __m256i;
+    using Counter = __m256i;
+    static constexpr int width = 8;
+
+    __attribute__((target("avx2")))
+    static V load(const int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+
+    __attribute__((target("avx2")))
+    static void store(int32_t *p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+
+    __attribute__((target("avx2")))
+    static V set1(int32_t v) { return _mm256_set1_epi32(v); }
+
+    __attribute__((target("avx2")))
+    static V min(V a, V b) { return _mm256_min_epi32(a, b); }
+
+    __attribute__((target("avx2")))
+    static V max(V a, V b) { return _mm256_max_epi32(a, b); }
+
+    __attribute__((target("avx2")))
+    static unsigned mask_eq(V a, V b) {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+    }
+
+    __attribute__((target("avx2")))
+    static Counter zero() { return _mm256_setzero_si256(); }
+
+    __attribute__((target("avx2")))
+    static Counter count_eq(Counter c, V a, V b) { return _mm256_sub_epi32(c, _mm256_cmpeq_epi32(a, b)); }
+
+    __attribute__((target("avx2")))
+    static std::size_t total(Counter c) {
+        uint32_t lanes[width];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), c);
+        return lane_total(lanes, width);
+    }
+};
+
+template<>
+struct Avx2<float> {
+    using value_type = float;
+    using V = __m256;
+    using Counter = __m256i;
+    static constexpr int width = 8;
+
+    __attribute__((target("avx2")))
+    static V load(const float *p) { return _mm256_loadu_ps(p); }
+
+    __attribute__((target("avx2")))
+    static void store(float *p, V v) { _mm256_storeu_ps(p, v); }
+
+    __attribute__((target("avx2")))
+    static V set1(float v) { return _mm256_set1_ps(v); }
+
+    __attribute__((target("avx2")))
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+
+    __attribute__((target("avx2")))
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+
+    __attribute__((target("avx2")))
+    static unsigned mask_eq(V a, V b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+
+    __attribute__((target("avx2")))
+    static Counter zero() { return _mm256_setzero_si256(); }
+
+    __attribute__((target("avx2")))
+    static Counter count_eq(Counter c, V a, V b) {
+        return _mm256_sub_epi32(c, _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)));
+    }
+
+    __attribute__((target("avx2")))
+    static std::size_t total(Counter c) { return Avx2<int32_t>::total(c); }
+};
+#endif
+
+template<typename S, typename T = typename S::value_type>
+std::size_t count_kernel(const T *first, const T *last, T value) {
+    const auto needle = S::set1(value);
+    // a lane counter gains at most 1 per step, flushing every 2^30 steps keeps it below 2^32
+    const std::size_t block = std::size_t(2 * S::width) << 30;
+    std::size_t result = 0;
+    while (last - first >= 2 * S::width) {
+        auto end = first + std::min<std::size_t>((last - first) / (2 * S::width) * (2 * S::width), block);
+        auto even = S::zero();
+        auto odd = S::zero();
+        for (; first < end; first += 2 * S::width) {
+            even = S::count_eq(even, S::load(first), needle);
+            odd = S::count_eq(odd, S::load(first + S::width), needle);
+        }
+        result += S::total(even) + S::total(odd);
+    }
+    for (; first < last; first++) {
+        result += *first == value;
+    }
+    return result;
+}
+
+template<typename S, typename T = typename S::value_type>
+const T *find_kernel(const T *first, const T *last, T value) {
+    const auto needle = S::set1(value);
+    constexpr int w = S::width;
+    for (; last - first >= 4 * w; first += 4 * w) {
+        auto mask = uint64_t(S::mask_eq(S::load(first), needle)) |
+                    uint64_t(S::mask_eq(S::load(first + w), needle)) << w |
+                    uint64_t(S::mask_eq(S::load(first + 2 * w), needle)) << 2 * w |
+                    uint64_t(S::mask_eq(S::load(first + 3 * w), needle)) << 3 * w;
+        if (mask) {
+            return first + __builtin_ctzll(mask);
+        }
+    }
+    for (; last - first >= w; first += w) {
+        if (auto mask = S::mask_eq(S::load(first), needle)) {
+            return first + __builtin_ctz(mask);
+        }
+    }
+    for (; first < last; first++) {
+        if (*first == value) {
+            return first;
+        }
+    }
+    return last;
+}
+
+template<typename S, typename T = typename S::value_type>
+const T *find_last_kernel(const T *first, const T *last, T value) {
+    const auto needle = S::set1(value);
+    constexpr int w = S::width;
+    auto end = last;
+    for (; end - first >= 4 * w; end -= 4 * w) {
+        auto block = end - 4 * w;
+        auto mask = uint64_t(S::mask_eq(S::load(block), needle)) |
+                    uint64_t(S::mask_eq(S::load(block + w), needle)) << w |
+                    uint64_t(S::mask_eq(S::load(block + 2 * w), needle)) << 2 * w |
+                    uint64_t(S::mask_eq(S::load(block + 3 * w), needle)) << 3 * w;
+        if (mask) {
+            return block + (63 - __builtin_clzll(mask));
+        }
+    }
+    while (end > first) {
+        if (*--end == value) {
+            return end;
+        }
+    }
+    return last;
+}
+
+// smallest and largest value of a non-empty range, four registers of each to keep the dependency chains short
+template<typename S, typename T = typename S::value_type>
+std::pair<T, T> minmax_kernel(const T *first, const T *last) {
+    constexpr int w = S::width;
+    T low = *first;
+    T high = *first;
+    if (last - first >= 4 * w) {
+        typename S::V min[4], max[4];
+        for (int i = 0; i < 4; i++) {
+            min[i] = max[i] = S::load(first + i * w);
+        }
+        for (first += 4 * w; last - first >= 4 * w; first += 4 * w) {
+            for (int i = 0; i < 4; i++) {
+                auto v = S::load(first + i * w);
+                min[i] = S::min(min[i], v);
+                max[i] = S::max(max[i], v);
+            }
+        }
+        T lanes[w];
+        S::store(lanes, S::min(S::min(min[0], min[1]), S::min(min[2], min[3])));
+        low = *std::min_element(lanes, lanes + w);
+        S::store(lanes, S::max(S::max(max[0], max[1]), S::max(max[2], max[3])));
+        high = *std::max_element(lanes, lanes + w);
+    }
+    for (; first < last; first++) {
+        low = Scalar<T>::min(low, *first);
+        high = Scalar<T>::max(high, *first);
+    }
+    return {low, high};
+}
+
+template<typename S, typename T = typename S::value_type>
+T min_kernel(const T *first, const T *last) {
+    constexpr int w = S::width;
+    T low = *first;
+    if (last - first >= 4 * w) {
+        typename S::V min[4];
+        for (int i = 0; i < 4; i++) {
+            min[i] = S::load(first + i * w);
+        }
+        for (first += 4 * w; last - first >= 4 * w; first += 4 * w) {
+            for (int i = 0; i < 4; i++) {
+                min[i] = S::min(min[i], S::load(first + i * w));
+            }
+        }
+        T lanes[w];
+        S::store(lanes, S::min(S::min(min[0], min[1]), S::min(min[2], min[3])));
+        low = *std::min_element(lanes, lanes + w);
+    }
+    for (; first < last; first++) {
+        low = Scalar<T>::min(low, *first);
+    }
+    return low;
+}
+
+template<typename S, typename T = typename S::value_type>
+T max_kernel(const T *first, const T *last) {
+    constexpr int w = S::width;
+    T high = *first;
+    if (last - first >= 4 * w) {
+        typename S::V max[4];
+        for (int i = 0; i < 4; i++) {
+            max[i] = S::load(first + i * w);
+        }
+        for (first += 4 * w; last - first >= 4 * w; first += 4 * w) {
+            for (int i = 0; i < 4; i++) {
+                max[i] = S::max(max[i], S::load(first + i * w));
+            }
+        }
+        T lanes[w];
+        S::store(lanes, S::max(S::max(max[0], max[1]), S::max(max[2], max[3])));
+        high = *std::max_element(lanes, lanes + w);
+    }
+    for (; first < last; first++) {
+        high = Scalar<T>::max(high, *first);
+    }
+    return high;
+}
+
+template<typename T>
+struct Kernels {
+    std::size_t (*count)(const T *, const T *, T);
+    const T *(*find)(const T *, const T *, T);
+    const T *(*find_last)(const T *, const T *, T);
+    T (*min)(const T *, const T *);
+    T (*max)(const T *, const T *);
+    std::pair<T, T> (*minmax)(const T *, const T *);
+};
+
+template<typename S, typename T = typename S::value_type>
+Kernels<T> make_kernels() {
+    return {&count_kernel<S>, &find_kernel<S>, &find_last_kernel<S>, &min_kernel<S>, &max_kernel<S>,
+            &minmax_kernel<S>};
+}
+
+#ifdef ALGORITHMS_X86_SIMD
+// the avx2 instantiations, with the helpers of Avx2<T> inlined into them
+template<typename T>
+struct Avx2Kernels {
+    using S = Avx2<T>;
+
+    __attribute__((target("avx2"), flatten))
+    static std::size_t count(const T *first, const T *last, T value) { return count_kernel<S>(first, last, value); }
+
+    __attribute__((target("avx2"), flatten))
+    static const T *find(const T *first, const T *last, T value) { return find_kernel<S>(first, last, value); }
+
+    __attribute__((target("avx2"), flatten))
+    static const T *find_last(const T *first, const T *last, T value) {
+        return find_last_kernel<S>(first, last, value);
+    }
+
+    __attribute__((target("avx2"), flatten))
+    static T min(const T *first, const T *last) { return min_kernel<S>(first, last); }
+
+    __attribute__((target("avx2"), flatten))
+    static T max(const T *first, const T *last) { return max_kernel<S>(first, last); }
+
+    __attribute__((target("avx2"), flatten))
+    static std::pair<T, T> minmax(const T *first, const T *last) { return minmax_kernel<S>(first, last); }
+
+    static Kernels<T> get() { return {&count, &find, &find_last, &min, &max, &minmax}; }
+};
+#endif
+
+template<typename T>
+const Kernels<T> &kernels(Kernel kernel) {
+    static const Kernels<T> scalar = make_kernels<Scalar<T>>();
+#ifdef ALGORITHMS_X86_SIMD
+    static const Kernels<T> sse2 = make_kernels<Sse2<T>>();
+    static const Kernels<T> avx2 = Avx2Kernels<T>::get();
+    switch (resolve(kernel)) {
+        case Kernel::sse2:
+            return sse2;
+        case Kernel::avx2:
+        case Kernel::avx512: // nothing to gain over avx2 for these
+            return avx2;
+        default:
+            break;
+    }
+#else
+    resolve(kernel);
+#endif
+    return scalar;
+}
+
+template<typename T>
+const T *min_element(const T *first, const T *last, Kernel kernel) {
+    if (first == last) {
+        return last;
+    }
+    auto &k = kernels<T>(kernel);
+    auto result = k.find(first, last, k.min(first, last));
+    return result == last ? first : result; // only with NaNs
+}
+
+template<typename T>
+const T *max_element(const T *first, const T *last, Kernel kernel) {
+    if (first == last) {
+        return last;
+    }
+    auto &k = kernels<T>(kernel);
+    auto result = k.find(first, last, k.max(first, last));
+    return result == last ? first : result;
+}
+
+template<typename T>
+std::pair<const T *, const T *> minmax_element(const T *first, const T *last, Kernel kernel) {
+    if (first == last) {
+        return {last, last};
+    }
+    auto &k = kernels<T>(kernel);
+    auto values = k.minmax(first, last);
+    auto low = k.find(first, last, values.first);
+    auto high = k.find_last(first, last, values.second);
+    return {low == last ? first : low, high == last ? first : high};
+}
+
+}// namespace
+
+bool kernel_supported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::automatic:
+        case Kernel::scalar:
+            return true;
+#ifdef ALGORITHMS_X86_SIMD
+        case Kernel::sse2:
+            return true;
+        case Kernel::avx2:
+            return __builtin_cpu_supports("avx2");
+        case Kernel::avx512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+Kernel resolve(Kernel kernel) {
+    if (kernel == Kernel::automatic) {
+        static const Kernel best = kernel_supported(Kernel::avx512) ? Kernel::avx512
+                                 : kernel_supported(Kernel::avx2) ? Kernel::avx2
+                                 : kernel_supported(Kernel::sse2) ? Kernel::sse2
+                                 : Kernel::scalar;
+        return best;
+    }
+    if (!kernel_supported(kernel)) {
+        throw std::invalid_argument("simd: kernel not supported for this cpu");
+    }
+    return kernel;
+}
+
+std::size_t count(const int32_t *first, const int32_t *last, int32_t value, Kernel kernel) {
+    return kernels<int32_t>(kernel).count(first, last, value);
+}
+
+std::size_t count(const float *first, const float *last, float value, Kernel kernel) {
+    return kernels<float>(kernel).count(first, last, value);
+}
+
+const int32_t *find(const int32_t *first, const int32_t *last, int32_t value, Kernel kernel) {
+    return kernels<int32_t>(kernel).find(first, last, value);
+}
+
+const float *find(const float *first, const float *last, float value, Kernel kernel) {
+    return kernels<float>(kernel).find(first, last, value);
+}
+
+const int32_t *min_element(const int32_t *first, const int32_t *last, Kernel kernel) {
+    return min_element<int32_t>(first, last, kernel);
+}
+
+const float *min_element(const float *first, const float *last, Kernel kernel) {
+    return min_element<float>(first, last, kernel);
+}
+
+const int32_t *max_element(const int32_t *first, const int32_t *last, Kernel kernel) {
+    return max_element<int32_t>(first, last, kernel);
+}
+
+const float *max_element(const float *first, const float *last, Kernel kernel) {
+    return max_element<float>(first, last, kernel);
+}
+
+std::pair<const int32_t *, const int32_t *> minmax_element(const int32_t *first, const int32_t *last,
+                                                           Kernel kernel) {
+    return minmax_element<int32_t>(first, last, kernel);
+}
+
+std::pair<const float *, const float *> minmax_element(const float *first, const float *last, Kernel kernel) {
+    return minmax_element<float>(first, last, kernel);
+}
+
+}// namespace simd
+}// namespace algorithms
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace algorithms {
+namespace simd {
+
+// instruction set of the kernels, automatic picks the best one the cpu supports
+enum class Kernel {
+    automatic,
+    scalar,
+    sse2,
+    avx2,
+    avx512 // compaction only, the search kernels run the avx2 ones
+};
+
+bool kernel_supported(Kernel kernel);
+
+// automatic becomes the best kernel the cpu supports, others are checked: throws std::invalid_argument
+Kernel resolve(Kernel kernel);
+
+// Search kernels
+// libstdc++ runs std::count / find / min_element / max_element / minmax_element one element and one branch at a
+// time. These compare a whole register of elements at once:
+// -> count: the compare masks (-1 / 0 per lane) are subtracted from per lane counters
+// -> find: four registers are compared per step, the match masks are combined into one bit mask and the first set
+//    bit is the position
+// -> min / max: four running minimum / maximum registers, the element is found again with find afterwards
+// Same results as std, including which element is returned on ties: the first smallest, the first largest for
+// max_element and the last largest for minmax_element. Floats compare with ==, so NaNs are never found or counted;
+// the result of min / max over ranges containing NaNs is unspecified.
+// All of them throw std::invalid_argument for a kernel the cpu doesn't support.
+
+std::size_t count(const int32_t *first, const int32_t *last, int32_t value, Kernel kernel = Kernel::automatic);
+
+std::size_t count(const float *first, const float *last, float value, Kernel kernel = Kernel::automatic);
+
+// first element equal to value, or last
+const int32_t *find(const int32_t *first, const int32_t *last, int32_t value, Kernel kernel = Kernel::automatic);
+
+const float *find(const float *first, const float *last, float value, Kernel kernel = Kernel::automatic);
+
+const int32_t *min_element(const int32_t *first, const int32_t *last, Kernel kernel = Kernel::automatic);
+
+const float *min_element(const float *first, const float *last, Kernel kernel = Kernel::automatic);
+
+const int32_t *max_element(const int32_t *first, const int32_t *last, Kernel kernel = Kernel::automatic);
+
+const float *max_element(const float *first, const float *last, Kernel kernel = Kernel::automatic);
+
+std::pair<const int32_t *, const int32_t *> minmax_element(const int32_t *first, const int32_t *last,
+                                                           Kernel kernel = Kernel::automatic);
+
+std::pair<const float *, const float *> minmax_element(const float *first, const float *last,
+                                                       Kernel kernel = Kernel::automatic);
+
+template<typename T>
+bool any_of_equal(const T *first, const T *last, T value, Kernel kernel = Kernel::automatic) {
+    return find(first, last, value, kernel) != last;
+}
+
+// the same on vectors, returning iterators like the std versions
+
+template<typename T>
+std::size_t count(const std::vector<T> &v, typename std::vector<T>::value_type value,
+                  Kernel kernel = Kernel::automatic) {
+    return count(v.data(), v.data() + v.size(), value, kernel);
+}
+
+template<typename T>
+typename std::vector<T>::const_iterator find(const std::vector<T> &v, typename std::vector<T>::value_type value,
+                                             Kernel kernel = Kernel::automatic) {
+    return v.begin() + (find(v.data(), v.data() + v.size(), value, kernel) - v.data());
+}
+
+template<typename T>
+bool any_of_equal(const std::vector<T> &v, typename std::vector<T>::value_type value,
+                  Kernel kernel = Kernel::automatic) {
+    return any_of_equal(v.data(), v.data() + v.size(), value, kernel);
+}
+
+template<typename T>
+typename std::vector<T>::const_iterator min_element(const std::vector<T> &v, Kernel kernel = Kernel::automatic) {
+    return v.begin() + (min_element(v.data(), v.data() + v.size(), kernel) - v.data());
+}
+
+template<typename T>
+typename std::vector<T>::const_iterator max_element(const std::vector<T> &v, Kernel kernel = Kernel::automatic) {
+    return v.begin() + (max_element(v.data(), v.data() + v.size(), kernel) - v.data());
+}
+
+template<typename T>
+std::pair<typename std::vector<T>::const_iterator, typename std::vector<T>::const_iterator>
+minmax_element(const std::vector<T> &v, Kernel kernel = Kernel::automatic) {
+    auto result = minmax_element(v.data(), v.data() + v.size(), kernel);
+    return {v.begin() + (result.first - v.data()), v.begin() + (result.second - v.data())};
+}
+
+}// namespace simd
+}// namespace algorithms
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+
+#include "Parallel.h"
+
+namespace algorithms {
+
+// below this std::sort on one thread is faster than distributing the work
+constexpr std::size_t parallel_sort_threshold = 1 << 15;
+
+namespace detail {
+
+// uninitialized storage for n elements: elements are move constructed into it and destroyed by the caller
+template<typename T>
+class RawBuffer {
+public:
+    explicit RawBuffer(std::size_t n) : data_(std::allocator<T>().allocate(n)), size_(n) {}
+
+    ~RawBuffer() { std::allocator<T>().deallocate(data_, size_); }
+
+    RawBuffer(const RawBuffer &) = delete;
+
+    RawBuffer &operator=(const RawBuffer &) = delete;
+
+    T *data() const { return data_; }
+
+private:
+    T *data_;
+    std::size_t size_;
+};
+
+inline std::pair<std::size_t, std::size_t> block(std::size_t i, std::size_t blocks, std::size_t n) {
+    auto size = (n + blocks - 1) / blocks;
+    return {std::min(n, i * size), std::min(n, (i + 1) * size)};
+}
+
+}// namespace detail
+
+// Sample sort
+// std::sort on one core is the baseline; this spreads every phase over the pool:
+// -> 32 random samples per bucket are sorted to pick the bucket boundaries (4 buckets per thread)
+// -> each thread finds the bucket of every element of its block with a binary search over the boundaries
+// -> elements are moved to their bucket's range of a buffer, each thread to its own precomputed offsets
+// -> buckets are sorted with std::sort in parallel and moved back
+// Not stable. The comparison must not throw and elements must be copyable (the boundaries are copies).
+template<typename It, typename Compare = std::less<>>
+void parallel_sort(It first, It last, Compare comp = Compare(), std::size_t parallelism = default_parallelism(),
+                   boost::asio::thread_pool &pool = default_pool()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    const std::size_t n = last - first;
+    if (parallelism < 2 || n < parallel_sort_threshold) {
+        std::sort(first, last, comp);
+        return;
+    }
+    const std::size_t tasks = parallelism;
+    const std::size_t buckets = std::min<std::size_t>(tasks * 4, std::numeric_limits<uint16_t>::max());
+    const std::size_t oversampling = 32;
+
+    std::vector<T> sample;
+    sample.reserve(buckets * oversampling);
+    std::minstd_rand random(static_cast<unsigned>(n));
+    for (std::size_t i = 0; i < buckets * oversampling; i++) {
+        sample.push_back(first[random() % n]);
+    }
+    std::sort(sample.begin(), sample.end(), comp);
+    std::vector<T> splitters;
+    for (std::size_t b = 1; b < buckets; b++) {
+        splitters.push_back(sample[b * oversampling]);
+    }
+
+    std::vector<uint16_t> bucket_of(n);
+    std::vector<std::size_t> counts(tasks * buckets);
+    parallel_for(tasks, [&](std::size_t task) {
+        auto range = detail::block(task, tasks, n);
+        auto count = &counts[task * buckets];
+        for (auto i = range.first; i < range.second; i++) {
+            auto b = std::upper_bound(splitters.begin(), splitters.end(), first[i], comp) - splitters.begin();
+            bucket_of[i] = static_cast<uint16_t>(b);
+            count[b]++;
+        }
+    }, pool);
+
+    // bucket major: bucket b holds the elements of task 0, then task 1...
+    std::vector<std::size_t> offsets(tasks * buckets);
+    std::vector<std::size_t> bucket_begin(buckets + 1);
+    std::size_t offset = 0;
+    for (std::size_t b = 0; b < buckets; b++) {
+        bucket_begin[b] = offset;
+        for (std::size_t task = 0; task < tasks; task++) {
+            offsets[task * buckets + b] = offset;
+            offset += counts[task * buckets + b];
+        }
+    }
+    bucket_begin[buckets] = n;
+
+    detail::RawBuffer<T> buffer(n);
+    parallel_for(tasks, [&](std::size_t task) {
+        auto range = detail::block(task, tasks, n);
+        auto offset = &offsets[task * buckets];
+        for (auto i = range.first; i < range.second; i++) {
+            ::new(static_cast<void *>(buffer.data() + offset[bucket_of[i]]++)) T(std::move(first[i]));
+        }
+    }, pool);
+    parallel_for(buckets, [&](std::size_t b) {
+        std::sort(buffer.data() + bucket_begin[b], buffer.data() + bucket_begin[b + 1], comp);
+    }, pool);
+    parallel_for(tasks, [&](std::size_t task) {
+        auto range = detail::block(task, tasks, n);
+        for (auto i = range.first; i < range.second; i++) {
+            first[i] = std::move(buffer.data()[i]);
+            buffer.data()[i].~T();
+        }
+    }, pool);
+}
+
+// Merge sort: blocks are std::stable_sort'ed in parallel, then merged pairwise (std::inplace_merge) in rounds,
+// the merges of a round in parallel. Stable, elements only need to be movable.
+template<typename It, typename Compare = std::less<>>
+void parallel_stable_sort(It first, It last, Compare comp = Compare(),
+                          std::size_t parallelism = default_parallelism(),
+                          boost::asio::thread_pool &pool = default_pool()) {
+    const std::size_t n = last - first;
+    if (parallelism < 2 || n < parallel_sort_threshold) {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+    const std::size_t blocks = parallelism;
+    parallel_for(blocks, [&](std::size_t b) {
+        auto range = detail::block(b, blocks, n);
+        std::stable_sort(first + range.first, first + range.second, comp);
+    }, pool);
+    const std::size_t block_size = (n + blocks - 1) / blocks;
+    for (std::size_t width = block_size; width < n; width *= 2) {
+        auto merges = (n + 2 * width - 1) / (2 * width);
+        parallel_for(merges, [&](std::size_t m) {
+            auto begin = m * 2 * width;
+            auto middle = std::min(n, begin + width);
+            auto end = std::min(n, begin + 2 * width);
+            std::inplace_merge(first + begin, first + middle, first + end, comp);
+        }, pool);
+    }
+}
+
+namespace detail {
+
+// order preserving map of an integer to an unsigned integer: the sign bit flipped for signed types
+template<typename T>
+typename std::make_unsigned<T>::type radix_key(T value) {
+    using U = typename std::make_unsigned<T>::type;
+    return std::is_signed<T>::value ? static_cast<U>(static_cast<U>(value) ^ (U(1) << (sizeof(T) * 8 - 1)))
+                                    : static_cast<U>(value);
+}
+
+}// namespace detail
+
+// LSD radix sort for integers: one counting pass builds the histograms of all 8 bit digits, then one scatter pass
+// per digit, skipping digits that are the same for every element (e.g. the high bytes of small values).
+// O(n) with a buffer of n elements, the range must be contiguous (vector, array).
+template<typename It>
+void radix_sort(It first, It last) {
+    using T = typename std::iterator_traits<It>::value_type;
+    static_assert(std::is_integral<T>::value, "radix_sort sorts integers");
+    const std::size_t n = last - first;
+    if (n < 2) {
+        return;
+    }
+    constexpr std::size_t digits = sizeof(T);
+    std::vector<std::size_t> histograms(digits * 256);
+    T *data = &*first;
+    for (std::size_t i = 0; i < n; i++) {
+        auto key = detail::radix_key(data[i]);
+        for (std::size_t d = 0; d < digits; d++) {
+            histograms[d * 256 + ((key >> (d * 8)) & 0xff)]++;
+        }
+    }
+    std::vector<T> buffer(n);
+    T *from = data;
+    T *to = buffer.data();
+    for (std::size_t d = 0; d < digits; d++) {
+        auto histogram = &histograms[d * 256];
+        if (histogram[(detail::radix_key(from[0]) >> (d * 8)) & 0xff] == n) {
+            continue;
+        }
+        std::size_t offset = 0;
+        for (std::size_t digit = 0; digit < 256; digit++) {
+            auto count = histogram[digit];
+            histogram[digit] = offset;
+            offset += count;
+        }
+        for (std::size_t i = 0; i < n; i++) {
+            to[histogram[(detail::radix_key(from[i]) >> (d * 8)) & 0xff]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+    if (from != data) {
+        std::copy(from, from + n, data);
+    }
+}
+
+// Order preserving 64 bit prefixes of sort keys: a < b implies prefix(a) <= prefix(b), so records are ordered by
+// one integer compare and the full keys are only compared when the prefixes are equal.
+// -> integers: the value itself (sign bit flipped)
+// -> strings: the first 8 bytes, big endian, zero padded
+// -> tuples / pairs: the prefix of the first member, for a tuple starting with a 32 bit integer that integer and
+//    the top half of the second member's prefix
+// -> anything else: 0, every compare goes to the full key
+// Overloads for other key types are found by argument dependent lookup.
+template<typename Int>
+typename std::enable_if<std::is_integral<Int>::value, uint64_t>::type sort_key_prefix(Int value) {
+    return std::is_signed<Int>::value ? detail::radix_key(static_cast<int64_t>(value)) : static_cast<uint64_t>(value);
+}
+
+inline uint64_t sort_key_prefix(boost::string_view text) {
+    unsigned char bytes[8] = {};
+    if (!text.empty()) {
+        std::memcpy(bytes, text.data(), std::min<std::size_t>(8, text.size()));
+    }
+    uint64_t prefix = 0;
+    for (auto byte : bytes) {
+        prefix = prefix << 8 | byte;
+    }
+    return prefix;
+}
+
+inline uint64_t sort_key_prefix(const std::string &text) {
+    return sort_key_prefix(boost::string_view(text));
+}
+
+template<typename... Ts>
+uint64_t sort_key_prefix(const std::tuple<Ts...> &key);
+
+template<typename A, typename B>
+uint64_t sort_key_prefix(const std::pair<A, B> &key);
+
+namespace detail {
+
+template<typename Key>
+auto key_prefix(const Key &key, int) -> decltype(sort_key_prefix(key)) {
+    return sort_key_prefix(key);
+}
+
+template<typename Key>
+uint64_t key_prefix(const Key &, long) {
+    return 0;
+}
+
+}// namespace detail
+
+namespace detail {
+
+// a 32 bit first member leaves room for the top half of the second one's prefix
+template<typename Tuple, std::size_t size = std::tuple_size<Tuple>::value>
+typename std::enable_if<(size >= 2 && std::is_integral<typename std::tuple_element<0, Tuple>::type>::value &&
+                         sizeof(typename std::tuple_element<0, Tuple>::type) <= 4), uint64_t>::type
+tuple_prefix(const Tuple &key, int) {
+    auto head = static_cast<uint32_t>(radix_key(static_cast<int32_t>(std::get<0>(key))));
+    if (!std::is_signed<typename std::tuple_element<0, Tuple>::type>::value) {
+        head = static_cast<uint32_t>(std::get<0>(key));
+    }
+    return uint64_t(head) << 32 | key_prefix(std::get<1>(key), 0) >> 32;
+}
+
+template<typename Tuple>
+uint64_t tuple_prefix(const Tuple &key, long) {
+    return key_prefix(std::get<0>(key), 0);
+}
+
+}// namespace detail
+
+template<typename... Ts>
+uint64_t sort_key_prefix(const std::tuple<Ts...> &key) {
+    return detail::tuple_prefix(key, 0);
+}
+
+template<typename A, typename B>
+uint64_t sort_key_prefix(const std::pair<A, B> &key) {
+    return detail::key_prefix(key.first, 0);
+}
+
+// Decorate-sort-undecorate: sorts by a key computed once per element instead of twice per comparison.
+//   sort_by_key(begin(staff), end(staff), [](const Employee &e) { return e.getSortingName(); });
+// is n calls to getSortingName() (n string allocations) where a comparator calling it makes ~2 n log n.
+// -> the keys go to a side array of (prefix, position, key) records, the sort moves records, not elements
+// -> records with equal prefixes compare the full keys, then positions: equal keys keep their order
+// -> the elements are moved into place once at the end
+// Keys must be values (a string_view into the element is fine, keys are not used after the sort):
+//   [](const Employee &e) {
+//       return std::make_tuple(e.getSalary(), boost::string_view(e.getLastName()),
+//                              boost::string_view(e.getFirstName()));
+//   }
+template<typename It, typename KeyFunction>
+void sort_by_key(It first, It last, KeyFunction key, std::size_t parallelism = default_parallelism(),
+                 boost::asio::thread_pool &pool = default_pool()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    using Key = typename std::decay<decltype(key(*first))>::type;
+    struct Record {
+        uint64_t prefix;
+        std::size_t position;
+        Key key;
+    };
+    const std::size_t n = last - first;
+    std::vector<Record> records;
+    records.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+        auto k = key(first[i]);
+        auto prefix = detail::key_prefix(k, 0);
+        records.push_back(Record{prefix, i, std::move(k)});
+    }
+    parallel_sort(records.begin(), records.end(), [](const Record &a, const Record &b) {
+        if (a.prefix != b.prefix) {
+            return a.prefix < b.prefix;
+        }
+        return a.key < b.key || (!(b.key < a.key) && a.position < b.position);
+    }, parallelism, pool);
+    std::vector<T> sorted;
+    sorted.reserve(n);
+    for (auto &record : records) {
+        sorted.push_back(std::move(first[record.position]));
+    }
+    std::move(sorted.begin(), sorted.end(), first);
+}
+
+}// namespace algorithms
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "Parallel.h"
+#include "Sort.h"
+
+namespace algorithms {
+
+// up to this k a heap keeps the best elements, above it a buffer that is cut back with nth_element
+constexpr std::size_t top_k_heap_limit = 256;
+
+// Streaming top-K
+// partial_sort_copy needs the whole input in one range and keeps it sorted while it runs. TopK takes the input in
+// any number of chunks and keeps only the k best by Compare (the k smallest with std::less, the k largest with
+// std::greater), so the input doesn't have to fit in memory:
+// -> small k: a bounded heap with the worst kept element on top, a new element is compared with that one and only
+//    enters (log k) when it is better
+// -> large k: a buffer of up to 2k elements; when it is full nth_element keeps the k best, and the worst of those is
+//    the threshold a new element has to beat to be buffered at all
+// Which of several equal elements are kept is unspecified.
+template<typename T, typename Compare = std::less<T>>
+class TopK {
+public:
+    explicit TopK(std::size_t k, Compare comp = Compare()) : k_(k), comp_(comp), heap_(k <= top_k_heap_limit) {
+        values_.reserve(heap_ ? k : 2 * k);
+    }
+
+    std::size_t k() const { return k_; }
+
+    void push(const T &value) {
+        if (heap_) {
+            push_heap(value);
+        } else if (!pruned_ || comp_(value, values_[k_ - 1])) {
+            values_.push_back(value);
+            if (values_.size() == 2 * k_) {
+                prune();
+            }
+        }
+    }
+
+    template<typename It>
+    void push(It first, It last) {
+        if (heap_) {
+            for (; first != last && values_.size() < k_; ++first) {
+                push_heap(*first);
+            }
+            // full: one compare with the worst kept element for most of them
+            for (; first != last && k_ > 0; ++first) {
+                if (comp_(*first, values_.front())) {
+                    replace_top(*first);
+                }
+            }
+            return;
+        }
+        for (; first != last && !pruned_; ++first) {
+            push(*first);
+        }
+        if (first == last) {
+            return;
+        }
+        auto threshold = values_[k_ - 1];
+        for (; first != last; ++first) {
+            if (comp_(*first, threshold)) {
+                values_.push_back(*first);
+                if (values_.size() == 2 * k_) {
+                    prune();
+                    threshold = values_[k_ - 1];
+                }
+            }
+        }
+    }
+
+    // adds the k best of other, e.g. the result of another thread
+    void merge(const TopK &other) { push(other.values_.begin(), other.values_.end()); }
+
+    // the k best so far (fewer when less were pushed), best first
+    std::vector<T> sorted() const {
+        auto result = values_;
+        if (result.size() > k_) {
+            std::nth_element(result.begin(), result.begin() + (k_ - 1), result.end(), comp_);
+            result.erase(result.begin() + k_, result.end());
+        }
+        std::sort(result.begin(), result.end(), comp_);
+        return result;
+    }
+
+private:
+    void push_heap(const T &value) {
+        if (values_.size() < k_) {
+            values_.push_back(value);
+            std::push_heap(values_.begin(), values_.end(), comp_);
+        } else if (k_ > 0 && comp_(value, values_.front())) {
+            replace_top(value);
+        }
+    }
+
+    // value replaces the worst kept element: one sift down where pop_heap + push_heap would sift twice
+    void replace_top(const T &value) {
+        const std::size_t n = values_.size();
+        std::size_t hole = 0;
+        for (std::size_t child = 1; child < n; child = 2 * hole + 1) {
+            if (child + 1 < n && comp_(values_[child], values_[child + 1])) {
+                child++;
+            }
+            if (!comp_(value, values_[child])) {
+                break;
+            }
+            values_[hole] = std::move(values_[child]);
+            hole = child;
+        }
+        values_[hole] = value;
+    }
+
+    void prune() {
+        std::nth_element(values_.begin(), values_.begin() + (k_ - 1), values_.end(), comp_);
+        values_.erase(values_.begin() + k_, values_.end());
+        pruned_ = true; // values_[k - 1] is the threshold now, until the next prune
+    }
+
+    std::size_t k_;
+    Compare comp_;
+    bool heap_;
+    bool pruned_ = false;
+    std::vector<T> values_;
+};
+
+template<typename It, typename Compare = std::less<typename std::iterator_traits<It>::value_type>>
+std::vector<typename std::iterator_traits<It>::value_type> top_k(It first, It last, std::size_t k,
+                                                                Compare comp = Compare()) {
+    TopK<typename std::iterator_traits<It>::value_type, Compare> top(k, comp);
+    top.push(first, last);
+    return top.sorted();
+}
+
+// One TopK per task over its block of a random access range, then the per task results are merged pairwise in
+// rounds, the merges of a round in parallel.
+template<typename It, typename Compare = std::less<typename std::iterator_traits<It>::value_type>>
+std::vector<typename std::iterator_traits<It>::value_type> parallel_top_k(
+        It first, It last, std::size_t k, Compare comp = Compare(), std::size_t parallelism = default_parallelism(),
+        boost::asio::thread_pool &pool = default_pool()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    const std::size_t n = last - first;
+    if (parallelism < 2 || n < parallel_sort_threshold) {
+        return top_k(first, last, k, comp);
+    }
+    const std::size_t tasks = parallelism;
+    std::vector<TopK<T, Compare>> partial(tasks, TopK<T, Compare>(k, comp));
+    parallel_for(tasks, [&](std::size_t task) {
+        auto range = detail::block(task, tasks, n);
+        partial[task].push(first + range.first, first + range.second);
+    }, pool);
+    for (std::size_t width = 1; width < tasks; width *= 2) {
+        auto merges = (tasks + 2 * width - 1) / (2 * width);
+        parallel_for(merges, [&](std::size_t m) {
+            auto target = m * 2 * width;
+            if (target + width < tasks) {
+                partial[target].merge(partial[target + width]);
+            }
+        }, pool);
+    }
+    return partial[0].sorted();
+}
+
+}// namespace algorithms
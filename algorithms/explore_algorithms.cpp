@@ -0,0 +1,947 @@
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <list>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+
+#include "Compact.h"
+#include "Employee.h"
+#include "Pipeline.h"
+#include "SetOperations.h"
+#include "Simd.h"
+#include "Sort.h"
+#include "TopK.h"
+#include "benchmark/Allocations.h"
+#include "benchmark/Timer.h"
+
+// Sorting
+// algorithms.cpp sorts with std::sort / std::stable_sort on one core, and simple_sort2 builds two strings per
+// comparison with getSortingName().
+
+namespace {
+std::vector<int> random_ints(std::size_t n, int range, unsigned seed = 1) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> distribution(-range, range);
+    std::vector<int> v(n);
+    for (auto &x : v) {
+        x = distribution(random);
+    }
+    return v;
+}
+
+std::vector<Employee> random_staff(std::size_t n, const std::string &last_name_suffix = "") {
+    const char *first[] = {"Kate", "Ob", "Fake", "Alan", "Frace", "Anita", "Grace", "Ada", "Linus", "Barbara"};
+    const char *last[] = {"Greg", "Art", "Name", "Turing", "Hopper", "Borg", "Lovelace", "Torvalds", "Liskov"};
+    std::mt19937 random(5);
+    std::vector<Employee> staff;
+    staff.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+        staff.emplace_back(first[random() % 10] + std::to_string(random() % 100), last[random() % 9] + last_name_suffix,
+                           1000 * int(random() % 20));
+    }
+    return staff;
+}
+
+// the two step sort of simple_sort2: by name, then stable by salary
+void sort_by_salary_then_name(std::vector<Employee> &staff) {
+    std::sort(begin(staff), end(staff), [](auto &&a, auto &&b) { return a.getSortingName() < b.getSortingName(); });
+    std::stable_sort(begin(staff), end(staff), [](auto &&a, auto &&b) { return a < b; });
+}
+
+auto salary_and_name = [](const Employee &e) {
+    return std::make_tuple(e.getSalary(), boost::string_view(e.getLastName()), boost::string_view(e.getFirstName()));
+};
+}
+
+TEST(sort, parallel_sort_same_as_std_sort) {
+    for (std::size_t n : {0, 1, 1000, 100000, 1000000}) {
+        for (int range : {5, 1 << 30}) { // many duplicates, mostly distinct
+            auto v = random_ints(n, range);
+            auto expected = v;
+            std::sort(expected.begin(), expected.end());
+            algorithms::parallel_sort(v.begin(), v.end(), std::less<>(), 4);
+            ASSERT_EQ(expected, v) << n << " " << range;
+
+            std::sort(expected.begin(), expected.end(), std::greater<>());
+            algorithms::parallel_sort(v.begin(), v.end(), std::greater<>(), 3);
+            ASSERT_EQ(expected, v) << n << " " << range;
+        }
+    }
+    std::vector<std::string> words;
+    for (auto x : random_ints(200000, 1 << 20)) {
+        words.push_back("w" + std::to_string(x));
+    }
+    auto expected = words;
+    std::sort(expected.begin(), expected.end());
+    algorithms::parallel_sort(words.begin(), words.end(), std::less<>(), 4);
+    EXPECT_EQ(expected, words);
+}
+
+TEST(sort, parallel_stable_sort_keeps_order_of_equals) {
+    auto keys = random_ints(300000, 50);
+    std::vector<std::pair<int, int>> v;
+    for (int i = 0; i < int(keys.size()); i++) {
+        v.emplace_back(keys[i], i);
+    }
+    auto by_key = [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first < b.first; };
+    auto expected = v;
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    algorithms::parallel_stable_sort(v.begin(), v.end(), by_key, 5);
+    EXPECT_EQ(expected, v);
+}
+
+TEST(sort, radix_sort) {
+    auto ints = random_ints(100000, std::numeric_limits<int>::max());
+    ints.push_back(std::numeric_limits<int>::min());
+    auto expected = ints;
+    std::sort(expected.begin(), expected.end());
+    algorithms::radix_sort(ints.begin(), ints.end());
+    EXPECT_EQ(expected, ints);
+
+    std::mt19937_64 random(2);
+    std::vector<uint64_t> wide(100000);
+    for (auto &x : wide) {
+        x = random() >> (random() % 64);
+    }
+    auto expected_wide = wide;
+    std::sort(expected_wide.begin(), expected_wide.end());
+    algorithms::radix_sort(wide.begin(), wide.end());
+    EXPECT_EQ(expected_wide, wide);
+
+    std::vector<int8_t> small = {5, -1, 127, -128, 0, 3, -1};
+    algorithms::radix_sort(small.begin(), small.end());
+    EXPECT_EQ((std::vector<int8_t>{-128, -1, -1, 0, 3, 5, 127}), small);
+}
+
+TEST(sort, employees_by_precomputed_key) {
+    auto staff = std::vector<Employee>{
+            {"Kate", "Greg", 1000},
+            {"Ob", "Art", 2000},
+            {"Fake", "Name", 1000},
+            {"Alan", "Turing", 2000},
+            {"Frace", "Hopper", 2000},
+            {"Anita", "Borg", 2000},
+    };
+    algorithms::sort_by_key(begin(staff), end(staff), salary_and_name);
+    std::vector<std::string> names;
+    for (auto &e : staff) {
+        names.push_back(e.getSortingName());
+    }
+    EXPECT_EQ((std::vector<std::string>{"Greg, Kate", "Name, Fake", "Art, Ob", "Borg, Anita", "Hopper, Frace",
+                                        "Turing, Alan"}), names);
+
+    auto many = random_staff(100000);
+    auto expected = many;
+    sort_by_salary_then_name(expected);
+    algorithms::sort_by_key(begin(many), end(many), salary_and_name, 4);
+    for (std::size_t i = 0; i < many.size(); i++) {
+        ASSERT_EQ(expected[i].getSortingName(), many[i].getSortingName());
+        ASSERT_EQ(expected[i].getSalary(), many[i].getSalary());
+    }
+}
+
+TEST(sort, key_prefixes_preserve_order) {
+    std::mt19937 random(9);
+    auto word = [&]() {
+        std::string w(random() % 12, 'a');
+        for (auto &c : w) {
+            c = static_cast<char>(random() % 4 ? 'a' + random() % 3 : random() % 256);
+        }
+        return w;
+    };
+    for (int i = 0; i < 100000; i++) {
+        auto a = word();
+        auto b = word();
+        if (a < b) {
+            ASSERT_LE(algorithms::sort_key_prefix(a), algorithms::sort_key_prefix(b)) << a << " " << b;
+        }
+        auto x = static_cast<int64_t>(random()) - static_cast<int64_t>(random());
+        auto y = static_cast<int>(random());
+        if (x < y) {
+            ASSERT_LT(algorithms::sort_key_prefix(x), algorithms::sort_key_prefix(y));
+        }
+    }
+    EXPECT_LT(algorithms::sort_key_prefix(std::make_tuple(-1, std::string("b"))),
+              algorithms::sort_key_prefix(std::make_tuple(1, std::string("a"))));
+    EXPECT_LT(algorithms::sort_key_prefix(std::make_tuple(1000, boost::string_view("Art"))),
+              algorithms::sort_key_prefix(std::make_tuple(1000, boost::string_view("Borg"))));
+    EXPECT_LT(algorithms::sort_key_prefix(std::make_tuple(-1000, boost::string_view("Zed"))),
+              algorithms::sort_key_prefix(std::make_tuple(1000, boost::string_view("Art"))));
+}
+
+TEST(sort, sort_by_key_computes_each_key_once) {
+    auto staff = random_staff(10000, "-Montgomery"); // "Art-Montgomery, Ob7": no small string optimization
+    auto expected = staff;
+
+    // one getSortingName() per employee, whatever it costs
+    auto before = benchmark::thread_allocations();
+    for (auto &e : staff) {
+        benchmark::DoNotOptimize(e.getSortingName());
+    }
+    auto per_pass = benchmark::thread_allocations() - before;
+    ASSERT_GE(per_pass, staff.size()); // the names are longer than the small string buffer
+
+    before = benchmark::thread_allocations();
+    std::sort(begin(expected), end(expected),
+              [](auto &&a, auto &&b) { return a.getSortingName() < b.getSortingName(); });
+    auto comparator_allocations = benchmark::thread_allocations() - before;
+
+    before = benchmark::thread_allocations();
+    algorithms::sort_by_key(begin(staff), end(staff), [](const Employee &e) { return e.getSortingName(); }, 1);
+    auto key_allocations = benchmark::thread_allocations() - before;
+
+    std::cout << "n = " << staff.size() << ": comparator " << comparator_allocations << ", sort_by_key "
+              << key_allocations << " allocations" << std::endl;
+    EXPECT_EQ(per_pass + 2, key_allocations); // + the records and the moved elements
+    EXPECT_GT(comparator_allocations, 10 * per_pass); // 2 per comparison, ~n log n comparisons
+    for (std::size_t i = 0; i < staff.size(); i++) {
+        ASSERT_EQ(expected[i].getSortingName(), staff[i].getSortingName());
+    }
+}
+
+// 1K (10000 times), 100K (100 times), 10M and 100M ints
+TEST(algorithms_benchmark, DISABLED_sort_1k_to_100m) {
+    std::cout << "[benchmark] " << algorithms::default_parallelism() << " threads" << std::endl;
+    for (std::size_t n : {std::size_t(1000), std::size_t(100000), std::size_t(10000000), std::size_t(100000000)}) {
+        auto repeat = std::max<std::size_t>(1, 10000000 / n);
+        auto input = random_ints(n, std::numeric_limits<int>::max(), 7);
+        auto label = std::to_string(n) + " ints x" + std::to_string(repeat) + ", ";
+        std::vector<int> v;
+        std::vector<int> expected;
+        {
+            benchmark::Timer t(label + "std::sort");
+            for (std::size_t r = 0; r < repeat; r++) {
+                v = input;
+                std::sort(v.begin(), v.end());
+            }
+        }
+        expected.swap(v);
+        {
+            benchmark::Timer t(label + "algorithms::parallel_sort");
+            for (std::size_t r = 0; r < repeat; r++) {
+                v = input;
+                algorithms::parallel_sort(v.begin(), v.end());
+            }
+        }
+        EXPECT_EQ(expected, v);
+        {
+            benchmark::Timer t(label + "algorithms::radix_sort");
+            for (std::size_t r = 0; r < repeat; r++) {
+                v = input;
+                algorithms::radix_sort(v.begin(), v.end());
+            }
+        }
+        EXPECT_EQ(expected, v);
+    }
+}
+
+// 1M employees by (salary, name): simple_sort2's two sorts against keys computed once
+TEST(algorithms_benchmark, DISABLED_employees_sort_by_key) {
+    auto staff = random_staff(1000000);
+    auto expected = staff;
+    {
+        benchmark::Timer t("1M employees, sort by getSortingName() then stable_sort by salary");
+        sort_by_salary_then_name(expected);
+    }
+    auto by_name = staff;
+    {
+        benchmark::Timer t("1M employees, algorithms::sort_by_key (salary, name views)");
+        algorithms::sort_by_key(begin(staff), end(staff), salary_and_name);
+    }
+    for (std::size_t i = 0; i < staff.size(); i++) {
+        ASSERT_EQ(expected[i].getSortingName(), staff[i].getSortingName());
+    }
+
+    auto by_name_expected = by_name;
+    {
+        benchmark::Timer t("1M employees, std::sort comparing getSortingName()");
+        std::sort(begin(by_name_expected), end(by_name_expected),
+                  [](auto &&a, auto &&b) { return a.getSortingName() < b.getSortingName(); });
+    }
+    {
+        benchmark::Timer t("1M employees, algorithms::sort_by_key(getSortingName)");
+        algorithms::sort_by_key(begin(by_name), end(by_name), [](const Employee &e) { return e.getSortingName(); });
+    }
+    for (std::size_t i = 0; i < by_name.size(); i++) {
+        ASSERT_EQ(by_name_expected[i].getSortingName(), by_name[i].getSortingName());
+    }
+}
+
+// Search kernels
+// algorithms.cpp counts, finds and takes the min / max of vector<int> with the std algorithms, one element at a time.
+
+namespace {
+const algorithms::simd::Kernel kernels[] = {algorithms::simd::Kernel::scalar, algorithms::simd::Kernel::sse2,
+                                            algorithms::simd::Kernel::avx2, algorithms::simd::Kernel::avx512};
+
+std::vector<float> random_floats(std::size_t n, int range, unsigned seed = 1) {
+    std::vector<float> v;
+    for (auto x : random_ints(n, range, seed)) {
+        v.push_back(x * 0.5f);
+    }
+    return v;
+}
+
+// every size up to a few registers, so each kernel runs its unrolled loop, single registers and the scalar tail
+template<typename T>
+void expect_same_as_std(const std::vector<T> &all, algorithms::simd::Kernel kernel) {
+    for (std::size_t n = 0; n <= 100; n++) {
+        for (std::size_t offset : {0, 1, 3}) { // unaligned starts
+            auto first = all.data() + offset;
+            auto last = first + n;
+            // last[0] is still inside all: a value just past the range
+            std::vector<T> values = {last[0], T(-7), T(123456)};
+            if (n > 0) {
+                values.insert(values.end(), {first[0], first[n / 2], last[-1]});
+            }
+            for (T value : values) {
+                ASSERT_EQ(std::size_t(std::count(first, last, value)),
+                          algorithms::simd::count(first, last, value, kernel)) << n;
+                ASSERT_EQ(std::find(first, last, value), algorithms::simd::find(first, last, value, kernel)) << n;
+            }
+            ASSERT_EQ(std::min_element(first, last), algorithms::simd::min_element(first, last, kernel)) << n;
+            ASSERT_EQ(std::max_element(first, last), algorithms::simd::max_element(first, last, kernel)) << n;
+            ASSERT_EQ(std::minmax_element(first, last), algorithms::simd::minmax_element(first, last, kernel)) << n;
+        }
+    }
+}
+}
+
+TEST(simd, same_as_std_for_every_kernel) {
+    for (auto kernel : kernels) {
+        if (!algorithms::simd::kernel_supported(kernel)) {
+            std::cout << "kernel " << int(kernel) << " not supported" << std::endl;
+            continue;
+        }
+        // few distinct values: many ties for min / max and many matches
+        expect_same_as_std(random_ints(200, 4), kernel);
+        expect_same_as_std(random_ints(200, 1 << 30), kernel);
+        expect_same_as_std(random_floats(200, 4), kernel);
+        expect_same_as_std(random_floats(200, 1 << 20), kernel);
+    }
+}
+
+TEST(simd, vectors_and_special_values) {
+    std::vector<int> v = {3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5};
+    EXPECT_EQ(3u, algorithms::simd::count(v, 5));
+    EXPECT_EQ(v.begin() + 5, algorithms::simd::find(v, 9));
+    EXPECT_EQ(v.end(), algorithms::simd::find(v, 7));
+    EXPECT_TRUE(algorithms::simd::any_of_equal(v, 2));
+    EXPECT_FALSE(algorithms::simd::any_of_equal(v, 8));
+    EXPECT_EQ(v.begin() + 1, algorithms::simd::min_element(v));
+    auto minmax = algorithms::simd::minmax_element(v);
+    EXPECT_EQ(v.begin() + 1, minmax.first);
+    EXPECT_EQ(v.begin() + 5, minmax.second);
+
+    std::vector<int> empty;
+    EXPECT_EQ(0u, algorithms::simd::count(empty, 1));
+    EXPECT_EQ(empty.end(), algorithms::simd::min_element(empty));
+    EXPECT_EQ(empty.end(), algorithms::simd::minmax_element(empty).second);
+
+    std::vector<int> extremes(100, 0);
+    extremes[40] = std::numeric_limits<int>::min();
+    extremes[70] = std::numeric_limits<int>::max();
+    for (auto kernel : kernels) {
+        if (algorithms::simd::kernel_supported(kernel)) {
+            EXPECT_EQ(extremes.begin() + 40, algorithms::simd::min_element(extremes, kernel));
+            EXPECT_EQ(extremes.begin() + 70, algorithms::simd::max_element(extremes, kernel));
+        }
+    }
+
+    // -0 == 0: the first of them is the smallest, as for std::min_element
+    std::vector<float> zeros(50, 1.0f);
+    zeros[20] = 0.0f;
+    zeros[30] = -0.0f;
+    EXPECT_EQ(zeros.begin() + 20, algorithms::simd::min_element(zeros));
+    EXPECT_EQ(2u, algorithms::simd::count(zeros, 0.0f));
+    zeros[10] = std::numeric_limits<float>::quiet_NaN();
+    EXPECT_EQ(0u, algorithms::simd::count(zeros, zeros[10]));
+    EXPECT_EQ(zeros.end(), algorithms::simd::find(zeros, zeros[10]));
+}
+
+// 4K (L1) and 4M (memory) element ranges, 400M elements per measurement
+TEST(algorithms_benchmark, DISABLED_simd_search_vs_std) {
+    using algorithms::simd::Kernel;
+    for (std::size_t n : {std::size_t(4096), std::size_t(4) << 20}) {
+        auto ints = random_ints(n, 1 << 30, 3);
+        auto floats = random_floats(n, 1 << 20, 3);
+        const int absent = (1 << 30) + 1; // outside the range, find scans everything
+        auto repeat = 400000000 / n;
+        auto label = std::to_string(n) + " x" + std::to_string(repeat) + ", ";
+        auto measure = [&](const std::string &name, auto &&f) {
+            std::size_t sink = 0;
+            {
+                benchmark::Timer t(label + name);
+                for (std::size_t r = 0; r < repeat; r++) {
+                    sink += f();
+                    benchmark::DoNotOptimize(sink);
+                }
+            }
+            return sink;
+        };
+        auto first = ints.data();
+        auto last = first + n;
+        auto first_float = floats.data();
+        auto last_float = first_float + n;
+
+        auto expected = measure("int std::count", [&]() { return std::count(first, last, ints[7]); });
+        EXPECT_EQ(expected, measure("int simd::count", [&]() { return algorithms::simd::count(ints, ints[7]); }));
+        expected = measure("int std::find (absent)", [&]() { return std::find(first, last, absent) - first; });
+        EXPECT_EQ(expected, measure("int simd::find (absent)",
+                                    [&]() { return algorithms::simd::find(ints, absent) - ints.begin(); }));
+        expected = measure("int std::any_of(== x)",
+                           [&]() { return std::any_of(first, last, [&](int x) { return x == absent; }); });
+        EXPECT_EQ(expected, measure("int simd::any_of_equal",
+                                    [&]() { return algorithms::simd::any_of_equal(ints, absent); }));
+        expected = measure("int std::min_element", [&]() { return std::min_element(first, last) - first; });
+        EXPECT_EQ(expected, measure("int simd::min_element",
+                                    [&]() { return algorithms::simd::min_element(ints) - ints.begin(); }));
+        expected = measure("int std::minmax_element", [&]() {
+            auto r = std::minmax_element(first, last);
+            return (r.first - first) * n + (r.second - first);
+        });
+        EXPECT_EQ(expected, measure("int simd::minmax_element", [&]() {
+            auto r = algorithms::simd::minmax_element(ints);
+            return (r.first - ints.begin()) * n + (r.second - ints.begin());
+        }));
+
+        expected = measure("float std::count", [&]() { return std::count(first_float, last_float, floats[7]); });
+        EXPECT_EQ(expected, measure("float simd::count",
+                                    [&]() { return algorithms::simd::count(floats, floats[7]); }));
+        expected = measure("float std::max_element",
+                           [&]() { return std::max_element(first_float, last_float) - first_float; });
+        EXPECT_EQ(expected, measure("float simd::max_element",
+                                    [&]() { return algorithms::simd::max_element(floats) - floats.begin(); }));
+        EXPECT_EQ(expected, measure("float simd::max_element (sse2)", [&]() {
+            return algorithms::simd::max_element(floats, Kernel::sse2) - floats.begin();
+        }));
+    }
+}
+
+// Compaction
+// remove / remove3 in algorithms.cpp erase with std::remove_if, copy / back_inserter collect with std::copy_if into a
+// back_inserter.
+
+namespace {
+template<typename T>
+void expect_compaction_same_as_std(const std::vector<T> &all, T threshold, algorithms::simd::Kernel kernel) {
+    auto below = [threshold](T x) { return x < threshold; };
+    for (std::size_t n = 0; n <= 100; n++) {
+        std::vector<T> v(all.begin(), all.begin() + n);
+
+        std::vector<T> expected;
+        std::copy_if(v.begin(), v.end(), std::back_inserter(expected), below);
+        ASSERT_EQ(expected, algorithms::simd::copy_if(v, below, kernel)) << n;
+
+        std::vector<T> out(n);
+        auto end = algorithms::simd::copy_if(v.data(), v.data() + n, out.data(), below, kernel);
+        ASSERT_EQ(expected, std::vector<T>(out.data(), end)) << n;
+
+        auto removed = v;
+        removed.erase(std::remove_if(removed.begin(), removed.end(), below), removed.end());
+        algorithms::simd::erase_if(v, below, kernel);
+        ASSERT_EQ(removed, v) << n;
+    }
+}
+}
+
+TEST(compaction, same_as_std_for_every_kernel_and_size) {
+    auto ints = random_ints(100, 100, 4);
+    for (auto kernel : kernels) {
+        if (!algorithms::simd::kernel_supported(kernel)) {
+            continue;
+        }
+        for (int threshold : {-100, -98, 0, 98, 101}) { // none, few, half, most and all kept
+            expect_compaction_same_as_std(ints, threshold, kernel);
+            expect_compaction_same_as_std(random_floats(100, 100, 4), threshold * 0.5f, kernel);
+            expect_compaction_same_as_std(std::vector<int64_t>(ints.begin(), ints.end()), int64_t(threshold), kernel);
+            expect_compaction_same_as_std(std::vector<double>(ints.begin(), ints.end()), double(threshold), kernel);
+            expect_compaction_same_as_std(std::vector<int16_t>(ints.begin(), ints.end()), int16_t(threshold), kernel);
+        }
+    }
+}
+
+TEST(compaction, examples_of_algorithms_cpp) {
+    auto v = std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9};
+    algorithms::simd::erase_if(v, [](int i) { return i % 2; }); // remove3
+    EXPECT_EQ((std::vector<int>{2, 4, 6, 8}), v);
+
+    auto v3 = std::vector<int>{3, 6, 1, 0, -2, 5, -2};
+    auto v4 = algorithms::simd::copy_if(v3, [](int e) { return e != 3; }); // back_inserter
+    EXPECT_EQ((std::vector<int>{6, 1, 0, -2, 5, -2}), v4);
+    EXPECT_EQ(v4.size(), v4.capacity()); // allocated once
+    EXPECT_EQ(6u, algorithms::simd::count_if(v3.data(), v3.data() + v3.size(), [](int e) { return e != 3; }));
+}
+
+// 10M ints with 50% and 1% of them kept
+TEST(algorithms_benchmark, DISABLED_compaction_vs_std) {
+    const std::size_t n = 10000000;
+    auto input = random_ints(n, 1000000, 6);
+    for (int percent : {50, 1}) {
+        const int threshold = -1000000 + 20000 * percent;
+        auto keep = [threshold](int x) { return x < threshold; };
+        auto drop = [threshold](int x) { return !(x < threshold); };
+        auto label = std::to_string(percent) + "% kept, ";
+        std::vector<int> expected;
+        {
+            benchmark::Timer t(label + "std::copy_if into back_inserter");
+            std::copy_if(input.begin(), input.end(), std::back_inserter(expected), keep);
+        }
+        for (auto kernel : kernels) {
+            if (algorithms::simd::kernel_supported(kernel)) {
+                std::vector<int> result;
+                {
+                    benchmark::Timer t(label + "simd::copy_if, kernel " + std::to_string(int(kernel)));
+                    result = algorithms::simd::copy_if(input, keep, kernel);
+                }
+                EXPECT_EQ(expected, result);
+            }
+        }
+
+        auto v = input;
+        {
+            benchmark::Timer t(label + "erase(std::remove_if)");
+            v.erase(std::remove_if(v.begin(), v.end(), drop), v.end());
+        }
+        EXPECT_EQ(expected, v);
+        for (auto kernel : kernels) {
+            if (algorithms::simd::kernel_supported(kernel)) {
+                v = input;
+                {
+                    benchmark::Timer t(label + "simd::erase_if, kernel " + std::to_string(int(kernel)));
+                    algorithms::simd::erase_if(v, drop, kernel);
+                }
+                EXPECT_EQ(expected, v);
+            }
+        }
+    }
+}
+
+// Set operations
+// simple_match_in_lists in explore_cpp.cpp intersected two lists with a nested loop: n * m string compares.
+
+namespace {
+const algorithms::SetMethod set_methods[] = {algorithms::SetMethod::automatic, algorithms::SetMethod::nested_loop,
+                                             algorithms::SetMethod::hash, algorithms::SetMethod::merge,
+                                             algorithms::SetMethod::gallop};
+
+std::vector<std::string> random_words(std::size_t n, int range, unsigned seed) {
+    std::vector<std::string> words;
+    for (auto x : random_ints(n, range, seed)) {
+        words.push_back("word-" + std::to_string(x));
+    }
+    return words;
+}
+
+// reference results from std::set, in the documented order
+template<typename T>
+void expect_set_operations(const std::vector<T> &a, const std::vector<T> &b, algorithms::SetMethod method) {
+    std::set<T> in_a(a.begin(), a.end());
+    std::set<T> in_b(b.begin(), b.end());
+    std::vector<T> intersection, difference, union_;
+    std::set<T> seen;
+    for (auto &x : a) {
+        if (seen.insert(x).second) {
+            (in_b.count(x) ? intersection : difference).push_back(x);
+            union_.push_back(x);
+        }
+    }
+    for (auto &x : b) {
+        if (seen.insert(x).second) {
+            union_.push_back(x);
+        }
+    }
+    auto sorted = method == algorithms::SetMethod::merge || method == algorithms::SetMethod::gallop ||
+                  (method == algorithms::SetMethod::automatic && std::is_sorted(a.begin(), a.end()) &&
+                   std::is_sorted(b.begin(), b.end()));
+    if (sorted) {
+        std::sort(union_.begin(), union_.end());
+    }
+    ASSERT_EQ(intersection, algorithms::set_intersection(a, b, method)) << int(method);
+    ASSERT_EQ(difference, algorithms::set_difference(a, b, method)) << int(method);
+    ASSERT_EQ(union_, algorithms::set_union(a, b, method)) << int(method);
+}
+}
+
+TEST(set_operations, same_results_for_every_method) {
+    for (std::size_t n : {0, 1, 5, 100, 3000}) {
+        for (std::size_t m : {0, 1, 7, 100, 5000}) {
+            for (int range : {10, 5000}) { // many repeated values, mostly distinct
+                auto a = random_ints(n, range, 1);
+                auto b = random_ints(m, range, 2);
+                auto a_words = random_words(n, range, 1);
+                auto b_words = random_words(m, range, 2);
+                for (auto method : set_methods) {
+                    auto sorted = method == algorithms::SetMethod::merge || method == algorithms::SetMethod::gallop;
+                    if (sorted) {
+                        std::sort(a.begin(), a.end());
+                        std::sort(b.begin(), b.end());
+                        std::sort(a_words.begin(), a_words.end());
+                        std::sort(b_words.begin(), b_words.end());
+                    }
+                    expect_set_operations(a, b, method);
+                    expect_set_operations(a_words, b_words, method);
+                }
+            }
+        }
+    }
+}
+
+TEST(set_operations, automatic_choice) {
+    std::vector<std::string> a{"a", "b", "c", "d", "e"};
+    std::vector<std::string> b{"d", "e", "f", "g", "h"};
+    EXPECT_EQ((std::vector<std::string>{"d", "e"}), algorithms::set_intersection(a, b)); // nested loop, sorted
+    std::reverse(a.begin(), a.end());
+    EXPECT_EQ((std::vector<std::string>{"e", "d"}), algorithms::set_intersection(a, b)); // order of a
+    EXPECT_EQ((std::vector<std::string>{"c", "b", "a"}), algorithms::set_difference(a, b));
+    EXPECT_EQ((std::vector<std::string>{"e", "d", "c", "b", "a", "f", "g", "h"}), algorithms::set_union(a, b));
+
+    // 1000 against 1M sorted: galloping compares a few times per element of the small one
+    std::vector<int> large(1000000);
+    std::iota(large.begin(), large.end(), 0);
+    std::vector<int> small;
+    for (int i = 0; i < 1000; i++) {
+        small.push_back(i * 997);
+    }
+    std::size_t compares = 0;
+    auto counting_less = [&compares](int x, int y) {
+        compares++;
+        return x < y;
+    };
+    auto result = algorithms::set_intersection(small, large, algorithms::SetMethod::gallop, std::hash<int>(),
+                                               std::equal_to<int>(), counting_less);
+    EXPECT_EQ(small, result);
+    EXPECT_LT(compares, 50 * small.size());
+}
+
+// two lists of 1M strings with half of them in common; the nested loop of simple_match_in_lists on 10K of them
+TEST(algorithms_benchmark, DISABLED_set_intersection_1m_strings) {
+    const std::size_t n = 1000000;
+    auto a = random_words(n, int(n), 11);
+    auto b = random_words(n, int(n), 12);
+    std::vector<std::string> expected;
+    {
+        std::vector<std::string> a_10k(a.begin(), a.begin() + 10000);
+        std::vector<std::string> b_10k(b.begin(), b.begin() + 10000);
+        std::vector<std::string> c;
+        benchmark::Timer t("10K x 10K strings, nested loop");
+        for (auto &x : a_10k) {
+            for (auto &y : b_10k) {
+                if (x == y) {
+                    c.push_back(x);
+                    break;
+                }
+            }
+        }
+    }
+    {
+        benchmark::Timer t("1M x 1M strings, std::unordered_set");
+        std::unordered_set<std::string> in_b(b.begin(), b.end());
+        std::unordered_set<std::string> emitted;
+        for (auto &x : a) {
+            if (in_b.count(x) && emitted.insert(x).second) {
+                expected.push_back(x);
+            }
+        }
+    }
+    {
+        benchmark::Timer t("1M x 1M strings, algorithms::set_intersection (hash)");
+        EXPECT_EQ(expected, algorithms::set_intersection(a, b));
+    }
+    std::vector<std::string> sorted_intersection;
+    {
+        benchmark::Timer t("1M x 1M strings, std::sort + std::set_intersection");
+        auto sorted_a = a;
+        auto sorted_b = b;
+        std::sort(sorted_a.begin(), sorted_a.end());
+        std::sort(sorted_b.begin(), sorted_b.end());
+        std::set_intersection(sorted_a.begin(), sorted_a.end(), sorted_b.begin(), sorted_b.end(),
+                              std::back_inserter(sorted_intersection));
+    }
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    {
+        benchmark::Timer t("1M x 1M sorted strings, algorithms::set_intersection (merge)");
+        auto result = algorithms::set_intersection(a, b);
+        sorted_intersection.erase(std::unique(sorted_intersection.begin(), sorted_intersection.end()),
+                                  sorted_intersection.end());
+        EXPECT_EQ(sorted_intersection, result);
+    }
+    std::vector<std::string> small;
+    for (std::size_t i = 0; i < a.size(); i += 1000) {
+        small.push_back(a[i]);
+    }
+    {
+        benchmark::Timer t("1K x 1M sorted strings, std::set_intersection");
+        expected.clear();
+        std::set_intersection(small.begin(), small.end(), b.begin(), b.end(), std::back_inserter(expected));
+    }
+    {
+        benchmark::Timer t("1K x 1M sorted strings, algorithms::set_intersection (gallop)");
+        auto result = algorithms::set_intersection(small, b, algorithms::SetMethod::gallop);
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        EXPECT_EQ(expected, result);
+    }
+}
+
+// Top-K
+// partial_sort_rotate_stable_partition in algorithms.cpp takes the top n with partial_sort_copy into an output as
+// large as the input: a full sort.
+
+namespace {
+std::vector<int> expected_top(std::vector<int> v, std::size_t k) {
+    std::sort(v.begin(), v.end());
+    v.resize(std::min(k, v.size()));
+    return v;
+}
+}
+
+TEST(top_k, same_as_sort_for_heap_and_nth_element) {
+    for (std::size_t n : {0, 1, 100, 100000}) {
+        auto v = random_ints(n, 1000000);
+        for (std::size_t k : {std::size_t(0), std::size_t(1), std::size_t(10), algorithms::top_k_heap_limit,
+                              algorithms::top_k_heap_limit + 1, std::size_t(5000)}) {
+            ASSERT_EQ(expected_top(v, k), algorithms::top_k(v.begin(), v.end(), k)) << n << " " << k;
+
+            auto descending = v; // every element is better than the ones before it
+            std::sort(descending.begin(), descending.end(), std::greater<>());
+            ASSERT_EQ(expected_top(v, k), algorithms::top_k(descending.begin(), descending.end(), k)) << n;
+        }
+    }
+    auto few_values = random_ints(10000, 3);
+    EXPECT_EQ(expected_top(few_values, 1000), algorithms::top_k(few_values.begin(), few_values.end(), 1000));
+}
+
+TEST(top_k, chunks_and_merges) {
+    auto v = random_ints(1000000, 1 << 30, 8);
+    for (std::size_t k : {std::size_t(20), std::size_t(2000)}) {
+        // the largest k, in chunks of 4096 as they would come from a file
+        algorithms::TopK<int, std::greater<int>> top(k);
+        for (std::size_t i = 0; i < v.size(); i += 4096) {
+            top.push(v.begin() + i, v.begin() + std::min(v.size(), i + 4096));
+        }
+        auto largest = v;
+        std::sort(largest.begin(), largest.end(), std::greater<>());
+        largest.resize(k);
+        EXPECT_EQ(largest, top.sorted());
+
+        algorithms::TopK<int, std::greater<int>> first_half(k), second_half(k);
+        first_half.push(v.begin(), v.begin() + v.size() / 2);
+        second_half.push(v.begin() + v.size() / 2, v.end());
+        first_half.merge(second_half);
+        EXPECT_EQ(largest, first_half.sorted());
+
+        for (std::size_t parallelism : {2, 3, 8}) {
+            EXPECT_EQ(largest, algorithms::parallel_top_k(v.begin(), v.end(), k, std::greater<>(), parallelism));
+        }
+    }
+
+    // top 3 salaries
+    auto staff = random_staff(1000);
+    auto best_paid = algorithms::top_k(staff.begin(), staff.end(), 3, [](const Employee &a, const Employee &b) {
+        return b < a;
+    });
+    ASSERT_EQ(3u, best_paid.size());
+    for (auto &e : staff) {
+        EXPECT_LE(e.getSalary(), best_paid[0].getSalary());
+    }
+}
+
+// top 10 / 1000 / 100000 of 10M ints
+TEST(algorithms_benchmark, DISABLED_top_k_10m) {
+    auto input = random_ints(10000000, 1 << 30, 13);
+    for (std::size_t k : {std::size_t(10), std::size_t(1000), std::size_t(100000)}) {
+        auto label = "top " + std::to_string(k) + " of 10M ints, ";
+        std::vector<int> expected(k);
+        {
+            benchmark::Timer t(label + "std::partial_sort_copy");
+            std::partial_sort_copy(input.begin(), input.end(), expected.begin(), expected.end());
+        }
+        {
+            benchmark::Timer t(label + "copy + std::nth_element + std::sort");
+            auto v = input;
+            std::nth_element(v.begin(), v.begin() + (k - 1), v.end());
+            std::sort(v.begin(), v.begin() + k);
+        }
+        {
+            benchmark::Timer t(label + "algorithms::top_k");
+            EXPECT_EQ(expected, algorithms::top_k(input.begin(), input.end(), k));
+        }
+        {
+            benchmark::Timer t(label + "algorithms::parallel_top_k");
+            EXPECT_EQ(expected, algorithms::parallel_top_k(input.begin(), input.end(), k));
+        }
+    }
+    {
+        benchmark::Timer t("10M ints, partial_sort_copy into 10M (algorithms.cpp)");
+        std::vector<int> all(input.size());
+        std::partial_sort_copy(input.begin(), input.end(), all.begin(), all.end());
+    }
+}
+
+// Pipelines
+// transform / back_inserter in algorithms.cpp chain std::generate_n, std::transform and std::copy_if through
+// back_inserters: a full vector per stage.
+
+namespace pipeline = algorithms::pipeline;
+
+namespace {
+template<typename T, typename Function, typename Predicate>
+std::vector<T> multi_pass(const std::vector<T> &v, Function f, Predicate p) {
+    std::vector<T> transformed;
+    std::transform(v.begin(), v.end(), std::back_inserter(transformed), f);
+    std::vector<T> kept;
+    std::copy_if(transformed.begin(), transformed.end(), std::back_inserter(kept), p);
+    return kept;
+}
+}
+
+TEST(pipeline, same_as_multi_pass) {
+    auto twice = [](int x) { return 2 * x; };
+    auto by_three = [](int x) { return x % 3 == 0; };
+    for (std::size_t n : {0, 1, 255, 256, 257, 1000, 100000}) {
+        auto v = random_ints(n, 100, 10);
+        auto expected = multi_pass(v, twice, by_three);
+        EXPECT_EQ(expected, pipeline::from(v) | pipeline::transform(twice) | pipeline::filter(by_three) |
+                            pipeline::to_vector()) << n;
+        EXPECT_EQ(expected, pipeline::from(v) | pipeline::filter(by_three) | pipeline::transform(twice) |
+                            pipeline::to_vector()) << n;
+
+        std::vector<int> twice_all;
+        std::transform(v.begin(), v.end(), std::back_inserter(twice_all), twice);
+        EXPECT_EQ(twice_all, pipeline::from(v) | pipeline::transform(twice) | pipeline::to_vector()) << n;
+
+        // not random access: unsized, no blocks
+        std::list<int> list(v.begin(), v.end());
+        EXPECT_EQ(expected, pipeline::from(list) | pipeline::transform(twice) | pipeline::filter(by_three) |
+                            pipeline::to_vector()) << n;
+        EXPECT_EQ(twice_all, pipeline::from(list) | pipeline::transform(twice) | pipeline::to_vector()) << n;
+
+        // two filters, into appends
+        std::vector<int> out{42};
+        pipeline::from(v) | pipeline::filter(by_three) | pipeline::filter([](int x) { return x > 0; }) |
+        pipeline::into(out);
+        std::vector<int> positive{42};
+        std::copy_if(v.begin(), v.end(), std::back_inserter(positive), [](int x) { return x % 3 == 0 && x > 0; });
+        EXPECT_EQ(positive, out) << n;
+
+        // values that are not trivially copyable
+        std::vector<std::string> strings;
+        std::transform(v.begin(), v.end(), std::back_inserter(strings), [](int x) { return std::to_string(x); });
+        auto shorter = [](const std::string &s) { return s.size() < 3; };
+        auto expected_strings = multi_pass(strings, [](const std::string &s) { return s + "!"; }, shorter);
+        EXPECT_EQ(expected_strings, pipeline::from(strings) |
+                                    pipeline::transform([](const std::string &s) { return s + "!"; }) |
+                                    pipeline::filter(shorter) | pipeline::to_vector()) << n;
+    }
+}
+
+TEST(pipeline, examples_of_algorithms_cpp) {
+    // back_inserter: generate_n, transform and copy_if
+    auto v1 = pipeline::generate_n(10, [n = 0]() mutable { return n++; }) | pipeline::to_vector();
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), v1);
+    auto v2 = pipeline::from(v1) | pipeline::transform([](int e) { return e * 2; }) | pipeline::to_vector();
+    EXPECT_EQ(4, v2[2]);
+    auto v3 = std::vector<int>{3, 6, 1, 0, -2, 5, -2};
+    auto v4 = pipeline::from(v3) | pipeline::filter([](int e) { return e != 3; }) | pipeline::to_vector();
+    EXPECT_EQ((std::vector<int>{6, 1, 0, -2, 5, -2}), v4);
+
+    // all three in one pass, the names of a staff: the value type changes on the way
+    auto staff = random_staff(100);
+    auto names = pipeline::from(staff) | pipeline::filter([](const Employee &e) { return e.getSalary() > 2000; }) |
+                 pipeline::transform([](const Employee &e) { return e.getFirstName(); }) | pipeline::to_vector();
+    std::size_t well_paid = std::count_if(staff.begin(), staff.end(),
+                                          [](const Employee &e) { return e.getSalary() > 2000; });
+    EXPECT_EQ(well_paid, names.size());
+}
+
+TEST(pipeline, stages_see_kept_values_once_in_order) {
+    auto v = std::vector<int>{4, 0, 5, 0, 10, 20};
+    std::vector<int> filtered, transformed;
+    auto result = pipeline::from(v) | pipeline::filter([&](int x) {
+        filtered.push_back(x);
+        return x != 0;
+    }) | pipeline::transform([&](int x) {
+        transformed.push_back(x);
+        return 100 / x; // never sees the zeros
+    }) | pipeline::to_vector();
+    EXPECT_EQ(v, filtered);
+    EXPECT_EQ((std::vector<int>{4, 5, 10, 20}), transformed);
+    EXPECT_EQ((std::vector<int>{25, 20, 10, 5}), result);
+
+    // sized: allocated once
+    auto before = benchmark::thread_allocations();
+    auto doubled = pipeline::from(v) | pipeline::transform([](int x) { return 2 * x; }) | pipeline::to_vector();
+    EXPECT_EQ(1u, benchmark::thread_allocations() - before);
+    EXPECT_EQ(v.size(), doubled.size());
+}
+
+// 10M generated ints through transform and a 50% filter
+TEST(algorithms_benchmark, DISABLED_pipeline_vs_multi_pass) {
+    const std::size_t n = 10000000;
+    auto generator = [x = 1u]() mutable {
+        x = x * 1664525u + 1013904223u;
+        return int(x >> 8);
+    };
+    auto f = [](int x) { return x * 3 + 1; };
+    auto p = [](int x) { return x < 3 * (1 << 23); };
+    std::vector<int> expected;
+    {
+        benchmark::Timer t("generate_n, transform, copy_if through back_inserters (algorithms.cpp)");
+        std::vector<int> generated;
+        std::generate_n(std::back_inserter(generated), n, generator);
+        std::vector<int> transformed;
+        std::transform(generated.begin(), generated.end(), std::back_inserter(transformed), f);
+        std::copy_if(transformed.begin(), transformed.end(), std::back_inserter(expected), p);
+    }
+    {
+        benchmark::Timer t("generate_n, transform in place, copy_if (preallocated)");
+        std::vector<int> v(n);
+        std::generate_n(v.begin(), n, generator);
+        std::transform(v.begin(), v.end(), v.begin(), f);
+        std::vector<int> kept;
+        std::copy_if(v.begin(), v.end(), std::back_inserter(kept), p);
+        EXPECT_EQ(expected, kept);
+    }
+    {
+        benchmark::Timer t("one hand written loop");
+        std::vector<int> kept;
+        auto g = generator;
+        for (std::size_t i = 0; i < n; i++) {
+            auto x = f(g());
+            if (p(x)) {
+                kept.push_back(x);
+            }
+        }
+        EXPECT_EQ(expected, kept);
+    }
+    {
+        benchmark::Timer t("pipeline generate_n | transform | filter | to_vector");
+        auto kept = pipeline::generate_n(n, generator) | pipeline::transform(f) | pipeline::filter(p) |
+                    pipeline::to_vector();
+        EXPECT_EQ(expected, kept);
+    }
+
+    // transform only: vectorized like std::transform into a new vector
+    auto input = random_ints(n, 1 << 20, 14);
+    std::vector<int> transformed;
+    {
+        benchmark::Timer t("transform 10M, std::transform into a new vector");
+        transformed.resize(n);
+        std::transform(input.begin(), input.end(), transformed.begin(), f);
+    }
+    {
+        benchmark::Timer t("transform 10M, pipeline from | transform | to_vector");
+        auto result = pipeline::from(input) | pipeline::transform(f) | pipeline::to_vector();
+        t.Stop();
+        EXPECT_EQ(transformed, result);
+    }
+}
@@ -0,0 +1,96 @@
+#include "Allocations.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace benchmark {
+namespace {
+thread_local uint64_t allocations = 0;
+
+void *allocate(std::size_t size) noexcept {
+    ++allocations;
+    return std::malloc(size ? size : 1);
+}
+
+void *allocate_or_throw(std::size_t size) {
+    if (void *p = allocate(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+#ifdef __cpp_aligned_new
+void *allocate(std::size_t size, std::align_val_t alignment) noexcept {
+    ++allocations;
+    auto align = static_cast<std::size_t>(alignment);
+    return std::aligned_alloc(align, (size + align - 1) / align * align); // a multiple of the alignment
+}
+
+void *allocate_or_throw(std::size_t size, std::align_val_t alignment) {
+    if (void *p = allocate(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+#endif
+}
+
+uint64_t thread_allocations() {
+    return allocations;
+}
+
+}// namespace benchmark
+
+// Every replaceable form is defined: which ones the standard library calls (e.g. the nothrow new of the temporary
+// buffer of std::stable_sort) depends on the toolchain, and a form left out would pair the allocator of the runtime
+// with std::free here.
+
+void *operator new(std::size_t size) { return benchmark::allocate_or_throw(size); }
+
+void *operator new[](std::size_t size) { return benchmark::allocate_or_throw(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return benchmark::allocate(size); }
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return benchmark::allocate(size); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete[](void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+
+#ifdef __cpp_aligned_new
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return benchmark::allocate_or_throw(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return benchmark::allocate_or_throw(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return benchmark::allocate(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return benchmark::allocate(size, alignment);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { std::free(p); }
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+namespace benchmark {
+
+// Number of global operator new calls made by the calling thread so far.
+// Allocations.cpp replaces the global operator new / delete of the test executable to count them;
+// take the difference around the code under test.
+uint64_t thread_allocations();
+
+}// namespace benchmark
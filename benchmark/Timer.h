@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace benchmark {
+
+// Benchmark tests are named <module>_benchmark.DISABLED_<name> so the default test run stays fast; run them with
+//     --gtest_also_run_disabled_tests --gtest_filter='*_benchmark.*'
+
+// Scoped timer for the benchmark tests: prints the elapsed time of the enclosing scope under a label.
+class Timer {
+public:
+    explicit Timer(std::string label) : label_(std::move(label)) {
+        startTimepoint_ = std::chrono::high_resolution_clock::now();
+    }
+
+    ~Timer() {
+        Stop();
+    }
+
+    double ElapsedMs() const {
+        auto duration = std::chrono::high_resolution_clock::now() - startTimepoint_;
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count() * 0.001;
+    }
+
+    void Stop() {
+        if (stopped_) return;
+        stopped_ = true;
+        std::cout << "[benchmark] " << label_ << ": " << ElapsedMs() << " ms" << std::endl;
+    }
+
+private:
+    std::string label_;
+    bool stopped_ = false;
+    std::chrono::time_point<std::chrono::high_resolution_clock> startTimepoint_;
+};
+
+// Keeps the optimizer from throwing away a benchmarked result.
+template<typename T>
+inline void DoNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}// namespace benchmark
@@ -8,6 +8,7 @@
 #include <functional>
 #include <unordered_map>
 #include <vector>
+#include "strings/FastCast.h"
 
 // Interpreter
 // A component that processes structured text data. Does so by turning it into separate lexical tokens (lexing) and
@@ -73,7 +74,7 @@ std::shared_ptr<Element> parse(const std::vector<Token> &tokens) {
 
         switch (token.type) {
             case Token::integer: {
-                int value = boost::lexical_cast<int>(token.text);
+                int value = strings::fast_cast<int>(token.text);
                 auto integer = std::make_shared<Integer>(value);
                 if (!have_lhs) {
                     result->lhs = integer;
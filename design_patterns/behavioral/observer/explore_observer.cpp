@@ -8,9 +8,9 @@
 #include <functional>
 #include <unordered_map>
 #include <vector>
-#include <boost/any.hpp>
 #include <mutex>
 #include <boost/signals2.hpp>
+#include "signals/Value.h"
 
 // Observer
 // An observer is an object that wishes to be informed about events happening in the system, typically by providing
@@ -103,12 +103,13 @@ TEST(observer, simple_observer) {
 
 struct Person;  // forward declaration
 
+// property values travel as signals::Value: scalars are stored inline, where boost::any allocates per notification
 struct PersonListener
 {
     virtual ~PersonListener() = default;
     virtual void PersonChanged(Person& p,
             const std::string& property_name,
-            const boost::any new_value) = 0;
+            const signals::Value& new_value) = 0;
 };
 
 // prevent concurency issues
@@ -159,7 +160,7 @@ struct Person {
         }
     }
 
-    void notify(const std::string& property_name, const boost::any new_value) {
+    void notify(const std::string& property_name, const signals::Value& new_value) {
         std::lock_guard<std::mutex> guard{mtx}; //prevent concurency issues
         for (const auto& listner: listners){
             if (listner) {
@@ -178,13 +179,13 @@ private:
 struct ConsoleListener : PersonListener { //outputs all changes to the command line.
     void PersonChanged(Person& p,
                        const std::string& property_name,
-                       const boost::any new_value) {
+                       const signals::Value& new_value) {
         std::cout << "person's " << property_name << "has been changed to ";
         if (property_name == "age"){
-            std::cout << boost::any_cast<int>(new_value);
+            std::cout << new_value.get<int>();
         }
         else if (property_name == "can_vote"){
-            std::cout << boost::any_cast<bool>(new_value);
+            std::cout << new_value.get<bool>();
         }
         std::cout << std::endl;
     }
@@ -194,7 +195,7 @@ struct ConsoleListener : PersonListener { //outputs all changes to the command l
 struct BadListner : PersonListener { //outputs all changes to the command line.
     void PersonChanged(Person& p,
                        const std::string& property_name,
-                       const boost::any new_value) {
+                       const signals::Value& new_value) {
         p.unsubscribe(this); // re-entry! my lock was already taken. now I have a deadlock!!
     }
 };
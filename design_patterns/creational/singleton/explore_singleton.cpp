@@ -13,6 +13,7 @@
 #include <functional>
 #include <unordered_map>
 #include <MacTypes.h>
+#include "strings/FastCast.h"
 
 // Singleton: A component which is instantiated only once.
 
@@ -44,7 +45,7 @@ private:
         std::string s, s2;
         while (std::getline(ifs, s)) {
             getline(ifs, s2);
-            int pop = boost::lexical_cast<int>(s2);
+            int pop = strings::fast_cast<int>(s2);
             capitals[s] = pop;
         }
 
@@ -133,7 +134,7 @@ private:
         std::string s, s2;
         while (std::getline(ifs, s)) {
             getline(ifs, s2);
-            int pop = boost::lexical_cast<int>(s2);
+            int pop = strings::fast_cast<int>(s2);
             capitals[s] = pop;
         }
 
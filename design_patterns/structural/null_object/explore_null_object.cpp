@@ -12,6 +12,7 @@
 #include <functional>
 #include <unordered_map>
 #include <boost/bimap.hpp>
+#include "strings/FastCast.h"
 
 // Null Object
 // A no-op object that satisfies the dependency requirement of same other object.
@@ -54,17 +55,17 @@ struct BankAccount {
 
     void deposit(int amount) {
         balance += amount;
-        log->info("Deposited $" + boost::lexical_cast<std::string>(amount) +
-                " to " + name + ", balance is now $" + boost::lexical_cast<std::string>(balance));
+        log->info("Deposited $" + strings::fast_cast<std::string>(amount) +
+                " to " + name + ", balance is now $" + strings::fast_cast<std::string>(balance));
     }
 
     void withdraw(int amount) {
         if (balance >= amount) {
             balance -= amount;
-            log->info("Withdrew $" + boost::lexical_cast<std::string>(amount) +
-                      " from " + name + ", $" + boost::lexical_cast<std::string>(balance) + " left.");
+            log->info("Withdrew $" + strings::fast_cast<std::string>(amount) +
+                      " from " + name + ", $" + strings::fast_cast<std::string>(balance) + " left.");
         } else {
-            log->warn("Tried to withdraw $" + boost::lexical_cast<std::string>(amount) +
+            log->warn("Tried to withdraw $" + strings::fast_cast<std::string>(amount) +
                       " from " + name + " but couldn't due to low balance.");
         }
     }
@@ -12,6 +12,7 @@
 #include <functional>
 #include <unordered_map>
 #include <boost/bimap.hpp>
+#include "strings/FastCast.h"
 
 // Proxy
 
@@ -34,17 +35,17 @@ struct CurrentBankAccount : BankAccount {
 
     void deposit(int amount) override {
         balance += amount;
-        std::cout << "Deposited $" + boost::lexical_cast<std::string>(amount) + ", balance is now $"
-                     + boost::lexical_cast<std::string>(balance) << std::endl;
+        std::cout << "Deposited $" + strings::fast_cast<std::string>(amount) + ", balance is now $"
+                     + strings::fast_cast<std::string>(balance) << std::endl;
     }
 
     void withdraw(int amount) override {
         if (balance >= amount) {
             balance -= amount;
-            std::cout << "Withdrew $" + boost::lexical_cast<std::string>(amount) + ", $"
-                         + boost::lexical_cast<std::string>(balance) + " left." << std::endl;
+            std::cout << "Withdrew $" + strings::fast_cast<std::string>(amount) + ", $"
+                         + strings::fast_cast<std::string>(balance) + " left." << std::endl;
         } else {
-            std::cout << "Tried to withdraw $" + boost::lexical_cast<std::string>(amount)
+            std::cout << "Tried to withdraw $" + strings::fast_cast<std::string>(amount)
                          + " but couldn't due to low balance." << std::endl;
         }
     }
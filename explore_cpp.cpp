@@ -7,6 +7,7 @@
 #include <boost/system/system_error.hpp>
 #include <functional>
 #include <unordered_map>
+#include "algorithms/SetOperations.h"
 
 template<typename T, typename... Args>
 std::unique_ptr<T> make_unique(Args&&... args)
@@ -501,29 +502,18 @@ TEST(programming, simple_match_in_lists) {
   b.emplace_back("g");
   b.emplace_back("h");
 
-  for(auto a_local: a){
-    for(auto b_local: b){
-        if ( a_local == b_local ) {
-            c.emplace_back(a_local);
-            std::cout << a_local << std::endl;
-
-        }
-    }
+  // a nested loop compares every pair: fine for 5 x 5, n * m string compares for lists of 10^6.
+  // set_intersection picks a hash join, a merge or a galloping search by size and sortedness.
+  c = algorithms::set_intersection(a, b);
+  for (auto& match: c) {
+      std::cout << match << std::endl;
   }
 
   EXPECT_NE(std::find(begin(c), end(c), "e"), c.end());
   EXPECT_NE(std::find(begin(c), end(c), "d"), c.end());
 
-  c.empty();
-  std::for_each(begin(a), end(a), [&](auto&& a_local){
-     std::for_each(begin(b), end(b), [&](auto&& b_local){
-         if ( a_local == b_local ) {
-             c.emplace_back(a_local);
-         }
-     });
-  });
-  EXPECT_NE(std::find(begin(c), end(c), "e"), c.end());
-  EXPECT_NE(std::find(begin(c), end(c), "d"), c.end());
+  c = algorithms::set_intersection(a, b, algorithms::SetMethod::hash);
+  EXPECT_EQ((std::vector<std::string>{"d", "e"}), c);
 }
 
 TEST(simple, simple1) {
@@ -0,0 +1,35 @@
+#include "Binding.h"
+
+namespace json {
+namespace detail {
+
+namespace {
+Target skip(void *) {
+    return {nullptr, &skip_handler()};
+}
+
+Target skip_key(void *, const char *, std::size_t) {
+    return {nullptr, &skip_handler()};
+}
+}
+
+const Handler &skip_handler() {
+    static const Handler handler{"anything",
+                                 [](void *, bool) {},
+                                 [](void *, int64_t) {},
+                                 [](void *, uint64_t) {},
+                                 [](void *, double) {},
+                                 [](void *, const char *, std::size_t) {},
+                                 [](void *) {},
+                                 &skip,
+                                 &skip_key,
+                                 [](void *) {}};
+    return handler;
+}
+
+void mismatch(const Handler &handler, const char *got) {
+    throw BindError(std::string("expected ") + handler.expected + ", got " + got);
+}
+
+}// namespace detail
+}// namespace json
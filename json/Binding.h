@@ -0,0 +1,421 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <tao/json.hpp>
+
+namespace json {
+
+class BindError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Compile-time field tables for taocpp::json: a struct is read straight from the parser's events and written straight
+// to a consumer's events, there is no tao::json::value in between.
+//
+//   struct Endpoint { std::string host; int port; };
+//   template<> struct json::Binding<Endpoint> {
+//       static constexpr auto fields() {
+//           return std::make_tuple(json::field("host", &Endpoint::host), json::field("port", &Endpoint::port));
+//       }
+//   };
+//   auto endpoint = json::parse<Endpoint>(R"({"host": "localhost", "port": 8080})");
+//   std::string text = json::serialize(endpoint);
+//
+// Members can be bool, integers (range checked), floating point, std::string, std::vector of any of these and
+// other bound structs. Missing keys keep their default, unknown keys are skipped, a type mismatch throws BindError.
+// null is a mismatch too, unless the member is a nullable_field: then null keeps the value, like a missing key.
+// (The Fields of NdjsonReader, Ndjson.h, are lenient instead: null keeps the default for every member.)
+
+template<typename T, typename M>
+struct Field {
+    const char *name;
+    M T::*member;
+    bool nullable;
+};
+
+template<typename T, typename M>
+constexpr Field<T, M> field(const char *name, M T::*member) {
+    return {name, member, false};
+}
+
+template<typename T, typename M>
+constexpr Field<T, M> nullable_field(const char *name, M T::*member) {
+    return {name, member, true};
+}
+
+template<typename T>
+struct Binding {
+};
+
+namespace detail {
+
+template<typename...>
+using void_t = void;
+
+template<typename T, typename = void>
+struct is_bound : std::false_type {
+};
+
+template<typename T>
+struct is_bound<T, void_t<decltype(Binding<T>::fields())>> : std::true_type {
+};
+
+// Where the events of one JSON value go: an object and the functions that store into it. A null function means
+// the JSON type is not accepted.
+struct Handler;
+
+struct Target {
+    void *object;
+    const Handler *handler;
+};
+
+struct Handler {
+    const char *expected;
+    void (*boolean)(void *, bool);
+    void (*integer)(void *, int64_t);
+    void (*unsigned_integer)(void *, uint64_t);
+    void (*real)(void *, double);
+    void (*string)(void *, const char *, std::size_t);
+    void (*begin_array)(void *);
+    Target (*element)(void *);
+    Target (*key)(void *, const char *, std::size_t);
+    void (*null)(void *);
+};
+
+// accepts and drops any value, for unknown keys
+const Handler &skip_handler();
+
+[[noreturn]] void mismatch(const Handler &handler, const char *got);
+
+template<typename T, typename = void>
+struct Handlers;
+
+template<typename T>
+Target target(T &object) {
+    return {&object, &Handlers<T>::get()};
+}
+
+// the handler of T that also accepts null, and ignores it
+template<typename T>
+Target nullable_target(T &object) {
+    static const Handler handler = [] {
+        auto copy = Handlers<T>::get();
+        copy.null = [](void *) {};
+        return copy;
+    }();
+    return {&object, &handler};
+}
+
+template<>
+struct Handlers<bool> {
+    static const Handler &get() {
+        static const Handler handler{"a boolean", [](void *o, bool v) { *static_cast<bool *>(o) = v; }};
+        return handler;
+    }
+};
+
+template<typename T>
+struct Handlers<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+    static void integer(void *o, int64_t v) {
+        if (v < int64_t(std::numeric_limits<T>::min()) ||
+            (v > 0 && uint64_t(v) > uint64_t(std::numeric_limits<T>::max()))) {
+            throw BindError("integer " + std::to_string(v) + " out of range");
+        }
+        *static_cast<T *>(o) = static_cast<T>(v);
+    }
+
+    static void unsigned_integer(void *o, uint64_t v) {
+        if (v > uint64_t(std::numeric_limits<T>::max())) {
+            throw BindError("integer " + std::to_string(v) + " out of range");
+        }
+        *static_cast<T *>(o) = static_cast<T>(v);
+    }
+
+    static const Handler &get() {
+        static const Handler handler{"an integer", nullptr, &integer, &unsigned_integer};
+        return handler;
+    }
+};
+
+template<typename T>
+struct Handlers<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+    static const Handler &get() {
+        static const Handler handler{"a number", nullptr,
+                                     [](void *o, int64_t v) { *static_cast<T *>(o) = static_cast<T>(v); },
+                                     [](void *o, uint64_t v) { *static_cast<T *>(o) = static_cast<T>(v); },
+                                     [](void *o, double v) { *static_cast<T *>(o) = static_cast<T>(v); }};
+        return handler;
+    }
+};
+
+template<>
+struct Handlers<std::string> {
+    static const Handler &get() {
+        static const Handler handler{"a string", nullptr, nullptr, nullptr, nullptr,
+                                     [](void *o, const char *v, std::size_t size) {
+                                         static_cast<std::string *>(o)->assign(v, size);
+                                     }};
+        return handler;
+    }
+};
+
+// std::vector<bool> has no bool & to store into: an element is appended when its value arrives
+template<>
+struct Handlers<std::vector<bool>> {
+    static const Handler &element() {
+        static const Handler handler{"a boolean", [](void *o, bool v) {
+            static_cast<std::vector<bool> *>(o)->push_back(v);
+        }};
+        return handler;
+    }
+
+    static const Handler &get() {
+        static const Handler handler{"an array", nullptr, nullptr, nullptr, nullptr, nullptr,
+                                     [](void *o) { static_cast<std::vector<bool> *>(o)->clear(); },
+                                     [](void *o) { return Target{o, &element()}; }};
+        return handler;
+    }
+};
+
+template<typename E>
+struct Handlers<std::vector<E>> {
+    static const Handler &get() {
+        static const Handler handler{"an array", nullptr, nullptr, nullptr, nullptr, nullptr,
+                                     [](void *o) { static_cast<std::vector<E> *>(o)->clear(); },
+                                     [](void *o) {
+                                         auto &vector = *static_cast<std::vector<E> *>(o);
+                                         vector.emplace_back();
+                                         return target(vector.back());
+                                     }};
+        return handler;
+    }
+};
+
+inline bool name_equals(const char *name, const char *key, std::size_t length) {
+    return std::strncmp(name, key, length) == 0 && name[length] == '\0';
+}
+
+template<typename T>
+struct Handlers<T, typename std::enable_if<is_bound<T>::value>::type> {
+    template<std::size_t... I>
+    static Target find(T &object, const char *key, std::size_t length, std::index_sequence<I...>) {
+        static constexpr auto fields = Binding<T>::fields();
+        Target result{nullptr, &skip_handler()};
+        // a linear scan over the table, unrolled at compile time
+        (void) std::initializer_list<int>{
+                (result.object == nullptr && name_equals(std::get<I>(fields).name, key, length)
+                 ? (result = std::get<I>(fields).nullable ? nullable_target(object.*(std::get<I>(fields).member))
+                                                          : target(object.*(std::get<I>(fields).member)), 0)
+                 : 0)...};
+        return result;
+    }
+
+    static Target key(void *o, const char *key, std::size_t length) {
+        constexpr auto size = std::tuple_size<decltype(Binding<T>::fields())>::value;
+        return find(*static_cast<T *>(o), key, length, std::make_index_sequence<size>());
+    }
+
+    static const Handler &get() {
+        static const Handler handler{"an object", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                     &key};
+        return handler;
+    }
+};
+
+// taocpp events consumer that stores into a Target: one frame per value being read, an object or array frame stays
+// until its parent's member() / element() pops it
+class Consumer {
+public:
+    explicit Consumer(Target root) { frames_.push_back({root, Mode::value}); }
+
+    void null() { apply(start_value(), &Handler::null, "null"); }
+
+    void boolean(bool v) { apply(start_value(), &Handler::boolean, "a boolean", v); }
+
+    void number(std::int64_t v) { apply(start_value(), &Handler::integer, "an integer", v); }
+
+    void number(std::uint64_t v) { apply(start_value(), &Handler::unsigned_integer, "an integer", v); }
+
+    void number(double v) { apply(start_value(), &Handler::real, "a number", v); }
+
+    template<typename S>
+    void string(const S &v) { apply(start_value(), &Handler::string, "a string", v.data(), v.size()); }
+
+    template<typename B>
+    void binary(const B &) { mismatch(*start_value().handler, "binary data"); }
+
+    void begin_array(std::size_t = 0) {
+        start_value();
+        auto &array = frames_.back();
+        apply(array.target, &Handler::begin_array, "an array");
+        array.mode = Mode::array;
+    }
+
+    void element() { frames_.pop_back(); }
+
+    void end_array(std::size_t = 0) {}
+
+    void begin_object(std::size_t = 0) {
+        start_value();
+        auto &object = frames_.back();
+        if (!object.target.handler->key) {
+            mismatch(*object.target.handler, "an object");
+        }
+        object.mode = Mode::object;
+    }
+
+    template<typename S>
+    void key(const S &name) {
+        auto &object = frames_.back().target;
+        frames_.push_back({object.handler->key(object.object, name.data(), name.size()), Mode::value});
+    }
+
+    void member() { frames_.pop_back(); }
+
+    void end_object(std::size_t = 0) {}
+
+private:
+    enum class Mode {
+        value,
+        array,
+        object
+    };
+
+    struct Frame {
+        Target target;
+        Mode mode;
+    };
+
+    // the target of the next value: a new element when the current frame is an array
+    Target start_value() {
+        auto &frame = frames_.back();
+        if (frame.mode == Mode::array) {
+            frames_.push_back({frame.target.handler->element(frame.target.object), Mode::value});
+        }
+        return frames_.back().target;
+    }
+
+    template<typename F, typename... Args>
+    static void apply(Target target, F Handler::*function, const char *got, Args... args) {
+        auto f = target.handler->*function;
+        if (!f) {
+            mismatch(*target.handler, got);
+        }
+        f(target.object, args...);
+    }
+
+    std::vector<Frame> frames_;
+};
+
+// Producer<T>::apply(consumer, value) sends the events of value to a taocpp events consumer
+template<typename T, typename = void>
+struct Producer;
+
+template<>
+struct Producer<bool> {
+    template<typename C>
+    static void apply(C &consumer, bool value) { consumer.boolean(value); }
+};
+
+template<typename T>
+struct Producer<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+    template<typename C>
+    static void apply(C &consumer, T value) {
+        using Number = typename std::conditional<std::is_signed<T>::value, std::int64_t, std::uint64_t>::type;
+        consumer.number(static_cast<Number>(value));
+    }
+};
+
+template<typename T>
+struct Producer<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+    template<typename C>
+    static void apply(C &consumer, T value) { consumer.number(static_cast<double>(value)); }
+};
+
+template<>
+struct Producer<std::string> {
+    template<typename C>
+    static void apply(C &consumer, const std::string &value) { consumer.string(value); }
+};
+
+template<typename E>
+struct Producer<std::vector<E>> {
+    template<typename C>
+    static void apply(C &consumer, const std::vector<E> &values) {
+        consumer.begin_array(values.size());
+        for (const auto &value : values) { // a bool by value for std::vector<bool>
+            Producer<E>::apply(consumer, value);
+            consumer.element();
+        }
+        consumer.end_array(values.size());
+    }
+};
+
+template<typename T>
+struct Producer<T, typename std::enable_if<is_bound<T>::value>::type> {
+    template<typename C, typename F>
+    static int member(C &consumer, const T &object, const F &field) {
+        consumer.key(std::string(field.name));
+        using M = typename std::decay<decltype(object.*(field.member))>::type;
+        Producer<M>::apply(consumer, object.*(field.member));
+        consumer.member();
+        return 0;
+    }
+
+    template<typename C, std::size_t... I>
+    static void members(C &consumer, const T &object, std::index_sequence<I...>) {
+        static constexpr auto fields = Binding<T>::fields();
+        (void) std::initializer_list<int>{member(consumer, object, std::get<I>(fields))...};
+    }
+
+    template<typename C>
+    static void apply(C &consumer, const T &object) {
+        constexpr auto size = std::tuple_size<decltype(Binding<T>::fields())>::value;
+        consumer.begin_object(size);
+        members(consumer, object, std::make_index_sequence<size>());
+        consumer.end_object(size);
+    }
+};
+
+}// namespace detail
+
+// events of value into any taocpp events consumer
+template<typename Consumer, typename T>
+void produce(Consumer &consumer, const T &value) {
+    detail::Producer<T>::apply(consumer, value);
+}
+
+// parses text into result, members that are not in the text keep their value
+template<typename T>
+void parse(const std::string &text, T &result) {
+    detail::Consumer consumer(detail::target(result));
+    tao::json::events::from_string(consumer, text);
+}
+
+template<typename T>
+T parse(const std::string &text) {
+    T result{};
+    parse(text, result);
+    return result;
+}
+
+template<typename T>
+std::string serialize(const T &value) {
+    std::ostringstream os;
+    tao::json::events::to_stream writer(os);
+    produce(writer, value);
+    return os.str();
+}
+
+}// namespace json
@@ -0,0 +1,105 @@
+#include "DocumentPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace json {
+namespace {
+constexpr std::size_t initial_stack_arena = 4 * 1024;
+constexpr std::size_t stack_capacity = 1024; // the default of rapidjson::Document
+}
+
+DocumentPool::Slot::Slot(std::size_t arena_size, std::size_t stack_arena_size)
+        : arena(new char[arena_size]),
+          arena_size(arena_size),
+          allocator(arena.get(), arena_size),
+          stack_arena(new char[stack_arena_size]),
+          stack_arena_size(stack_arena_size),
+          stack_allocator(stack_arena.get(), stack_arena_size),
+          document(&allocator, stack_capacity, &stack_allocator) {
+}
+
+DocumentPool::DocumentPool(std::size_t initial_arena, std::size_t max_arena, std::size_t max_idle)
+        : initial_arena_(initial_arena), max_arena_(max_arena), max_idle_(max_idle) {
+}
+
+DocumentPool &DocumentPool::local() {
+    thread_local DocumentPool pool;
+    return pool;
+}
+
+DocumentPool::Lease DocumentPool::acquire() {
+    assert(owner_ == std::this_thread::get_id());
+    std::unique_ptr<Slot> slot;
+    if (idle_.empty()) {
+        slot.reset(new Slot(initial_arena_, initial_stack_arena));
+        arenas_created_++;
+    } else {
+        slot = std::move(idle_.back());
+        idle_.pop_back();
+    }
+    return Lease(this, std::move(slot));
+}
+
+void DocumentPool::release(std::unique_ptr<Slot> slot) {
+    assert(owner_ == std::this_thread::get_id());
+    slot->document.SetNull(); // no value may point into the arena once it is cleared
+    if (idle_.size() >= max_idle_) {
+        return;
+    }
+    auto arena_size = grown(slot->allocator.Capacity(), slot->arena_size);
+    auto stack_arena_size = grown(slot->stack_allocator.Capacity(), slot->stack_arena_size);
+    if (arena_size != slot->arena_size || stack_arena_size != slot->stack_arena_size) {
+        // overflow chunks were needed: next time the whole document and its parse stack fit in the arenas
+        slot.reset(new Slot(arena_size, stack_arena_size));
+        arenas_created_++;
+    } else {
+        // the parse stack is empty after Parse, its memory can be reused
+        slot->allocator.Clear();
+        slot->stack_allocator.Clear();
+    }
+    idle_.push_back(std::move(slot));
+}
+
+std::size_t DocumentPool::grown(std::size_t used, std::size_t size) const {
+    if (used <= size || size >= max_arena_) {
+        return size;
+    }
+    return std::min(std::max(used + used / 4, 2 * size), max_arena_);
+}
+
+rapidjson::Value deep_copy(const rapidjson::Value &value, DocumentPool::Allocator &allocator) {
+    switch (value.GetType()) {
+        case rapidjson::kObjectType: {
+            rapidjson::Value object(rapidjson::kObjectType);
+            for (auto member = value.MemberBegin(); member != value.MemberEnd(); ++member) {
+                rapidjson::Value name(member->name.GetString(), member->name.GetStringLength(), allocator);
+                rapidjson::Value copy = deep_copy(member->value, allocator);
+                object.AddMember(name, copy, allocator);
+            }
+            return object;
+        }
+        case rapidjson::kArrayType: {
+            rapidjson::Value array(rapidjson::kArrayType);
+            array.Reserve(value.Size(), allocator);
+            for (auto element = value.Begin(); element != value.End(); ++element) {
+                rapidjson::Value copy = deep_copy(*element, allocator);
+                array.PushBack(copy, allocator);
+            }
+            return array;
+        }
+        case rapidjson::kStringType:
+            return rapidjson::Value(value.GetString(), value.GetStringLength(), allocator);
+        default: // null, booleans and numbers are stored inline
+            return rapidjson::Value(value, allocator);
+    }
+}
+
+void add_member_copy(rapidjson::Value &object, const char *name, const rapidjson::Value &value,
+                     DocumentPool::Allocator &allocator) {
+    rapidjson::Value key(name, allocator);
+    rapidjson::Value copy = deep_copy(value, allocator);
+    object.AddMember(key, copy, allocator);
+}
+
+}// namespace json
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "rapidjson/document.h"
+
+namespace json {
+
+// Recycles rapidjson Documents together with the memory of their MemoryPoolAllocator.
+// A default Document owns a MemoryPoolAllocator that mallocs 64KB chunks while parsing and frees them all in its
+// destructor, and a parse stack that is malloc'ed and freed on every Parse: a document per request is a steady stream
+// of allocations. Here every document parses into arenas that it keeps:
+// -> the values go to the user buffer of a MemoryPoolAllocator, Clear() between uses frees nothing but overflow chunks
+// -> the parse stacks (of the Document and of its reader) come from a second MemoryPoolAllocator with its own arena:
+//    freeing the stack at the end of Parse is a no-op for it, Clear() on release makes the memory available again
+// -> a document that needed overflow chunks gets arenas of its high water marks on release, so a steady workload
+//    stops allocating after the first few requests
+// The pool is meant to be used per thread (see local()): a Lease must be released on the thread that acquired it.
+class DocumentPool {
+public:
+    using Allocator = rapidjson::MemoryPoolAllocator<>;
+    // a rapidjson::Document whose parse stack is pooled too; its values are rapidjson::Values
+    using Document = rapidjson::GenericDocument<rapidjson::UTF8<>, Allocator, Allocator>;
+
+    explicit DocumentPool(std::size_t initial_arena = 64 * 1024, std::size_t max_arena = 16 * 1024 * 1024,
+                          std::size_t max_idle = 16);
+
+    DocumentPool(const DocumentPool &) = delete;
+    DocumentPool &operator=(const DocumentPool &) = delete;
+
+    // the pool of the calling thread
+    static DocumentPool &local();
+
+private:
+    struct Slot {
+        Slot(std::size_t arena_size, std::size_t stack_arena_size);
+
+        std::unique_ptr<char[]> arena;
+        std::size_t arena_size;
+        Allocator allocator;
+        std::unique_ptr<char[]> stack_arena;
+        std::size_t stack_arena_size;
+        Allocator stack_allocator;
+        Document document;
+    };
+
+public:
+    // RAII handle of a pooled document, returns it to the pool (reset) when destroyed
+    class Lease {
+    public:
+        Lease(Lease &&other) noexcept : pool_(other.pool_), slot_(std::move(other.slot_)) {}
+
+        Lease &operator=(Lease &&) = delete;
+
+        ~Lease() {
+            if (slot_) {
+                pool_->release(std::move(slot_));
+            }
+        }
+
+        Document &operator*() const { return slot_->document; }
+
+        Document *operator->() const { return &slot_->document; }
+
+        Allocator &allocator() const { return slot_->allocator; }
+
+        // the memory of the parse stack, not meant for values
+        const Allocator &stack_allocator() const { return slot_->stack_allocator; }
+
+    private:
+        friend class DocumentPool;
+
+        Lease(DocumentPool *pool, std::unique_ptr<Slot> slot) : pool_(pool), slot_(std::move(slot)) {}
+
+        DocumentPool *pool_;
+        std::unique_ptr<Slot> slot_;
+    };
+
+    // an empty (null) document
+    Lease acquire();
+
+    // arenas created, including the ones replaced by a larger arena
+    std::size_t arenas_created() const { return arenas_created_; }
+
+    std::size_t idle() const { return idle_.size(); }
+
+private:
+    void release(std::unique_ptr<Slot> slot);
+
+    // the arena size for a next use that needed used bytes of an arena of size bytes
+    std::size_t grown(std::size_t used, std::size_t size) const;
+
+    std::size_t initial_arena_;
+    std::size_t max_arena_;
+    std::size_t max_idle_;
+    std::size_t arenas_created_ = 0;
+    std::vector<std::unique_ptr<Slot>> idle_;
+    std::thread::id owner_ = std::this_thread::get_id();
+};
+
+// Deep copy of value into allocator, strings included.
+// Moving a member out of another document (AddMember of a Value that lives in another allocator, like "Inner" in
+// json.cpp's json2 test) leaves it pointing into memory that the other document frees or, when pooled, reuses.
+// rapidjson's own copy constructor shares const strings (ParseInsitu, literals) instead of copying them.
+rapidjson::Value deep_copy(const rapidjson::Value &value, DocumentPool::Allocator &allocator);
+
+// object[name] = deep_copy(value), the name is copied as well
+void add_member_copy(rapidjson::Value &object, const char *name, const rapidjson::Value &value,
+                     DocumentPool::Allocator &allocator);
+
+}// namespace json
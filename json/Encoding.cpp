@@ -0,0 +1,74 @@
+#include "Encoding.h"
+
+#include <stdexcept>
+
+namespace json {
+
+const char *content_type(Encoding encoding) {
+    switch (encoding) {
+        case Encoding::text:
+            return "application/json";
+        case Encoding::cbor:
+            return "application/cbor";
+        case Encoding::msgpack:
+            return "application/msgpack";
+        case Encoding::ubjson:
+            return "application/ubjson";
+    }
+    return "application/json";
+}
+
+Encoding encoding_for(boost::string_view content_type) {
+    auto media_type = content_type.substr(0, content_type.find(';'));
+    while (!media_type.empty() && media_type.back() == ' ') {
+        media_type.remove_suffix(1);
+    }
+    for (auto encoding : {Encoding::text, Encoding::cbor, Encoding::msgpack, Encoding::ubjson}) {
+        if (media_type == json::content_type(encoding)) {
+            return encoding;
+        }
+    }
+    if (media_type == "application/x-msgpack") {
+        return Encoding::msgpack;
+    }
+    throw std::invalid_argument("unsupported content type " + content_type.to_string());
+}
+
+std::string encode(const tao::json::value &value, Encoding encoding) {
+    return detail::write(encoding, [&](auto &writer) { tao::json::events::from_value(writer, value); });
+}
+
+tao::json::value decode(const std::string &data, Encoding encoding) {
+    tao::json::events::to_value consumer;
+    detail::parse(encoding, consumer, data);
+    return std::move(consumer.value);
+}
+
+std::string transcode(const std::string &data, Encoding from, Encoding to) {
+    if (from == to) {
+        return data;
+    }
+    std::ostringstream os;
+    switch (to) {
+        case Encoding::text: {
+            tao::json::events::to_stream writer(os);
+            detail::parse(from, writer, data);
+            break;
+        }
+        case Encoding::cbor: {
+            tao::json::cbor::events::to_stream writer(os);
+            detail::parse(from, writer, data);
+            break;
+        }
+        case Encoding::ubjson: {
+            tao::json::ubjson::events::to_stream writer(os);
+            detail::parse(from, writer, data);
+            break;
+        }
+        case Encoding::msgpack:
+            return encode(decode(data, from), to);
+    }
+    return os.str();
+}
+
+}// namespace json
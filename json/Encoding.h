@@ -0,0 +1,138 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <boost/utility/string_view.hpp>
+#include <tao/json.hpp>
+#include <tao/json/cbor.hpp>
+#include <tao/json/msgpack.hpp>
+#include <tao/json/ubjson.hpp>
+
+#include "Binding.h"
+
+namespace json {
+
+// Binary encodings
+// Text JSON costs a decimal formatting of every double on the way out and a decimal parse on the way in. taocpp
+// writes and reads CBOR, MessagePack and UBJSON through the same events interface as text, so a value, a bound
+// struct or another encoding's byte stream can be sent to any of them without building a tao::json::value.
+// Needs a taocpp-json with that interface: tao::json::{cbor,msgpack,ubjson}::events::{from_string,to_stream} and
+// tao::json::events::{from_value,to_value}.
+enum class Encoding {
+    text,
+    cbor,
+    msgpack,
+    ubjson
+};
+
+const char *content_type(Encoding encoding);
+
+// "application/cbor; charset=..." -> Encoding::cbor, throws std::invalid_argument for unsupported types
+Encoding encoding_for(boost::string_view content_type);
+
+namespace detail {
+
+template<typename Consumer>
+void parse(Encoding encoding, Consumer &consumer, const std::string &data) {
+    switch (encoding) {
+        case Encoding::text:
+            tao::json::events::from_string(consumer, data);
+            return;
+        case Encoding::cbor:
+            tao::json::cbor::events::from_string(consumer, data);
+            return;
+        case Encoding::msgpack:
+            tao::json::msgpack::events::from_string(consumer, data);
+            return;
+        case Encoding::ubjson:
+            tao::json::ubjson::events::from_string(consumer, data);
+            return;
+    }
+}
+
+// send(writer) with the writer for encoding
+template<typename F>
+std::string write(Encoding encoding, F &&send) {
+    std::ostringstream os;
+    switch (encoding) {
+        case Encoding::text: {
+            tao::json::events::to_stream writer(os);
+            send(writer);
+            break;
+        }
+        case Encoding::cbor: {
+            tao::json::cbor::events::to_stream writer(os);
+            send(writer);
+            break;
+        }
+        case Encoding::msgpack: {
+            tao::json::msgpack::events::to_stream writer(os);
+            send(writer);
+            break;
+        }
+        case Encoding::ubjson: {
+            tao::json::ubjson::events::to_stream writer(os);
+            send(writer);
+            break;
+        }
+    }
+    return os.str();
+}
+
+}// namespace detail
+
+std::string encode(const tao::json::value &value, Encoding encoding);
+
+tao::json::value decode(const std::string &data, Encoding encoding);
+
+// a struct with a json::Binding
+template<typename T>
+std::string encode(const T &value, Encoding encoding) {
+    return detail::write(encoding, [&](auto &writer) { produce(writer, value); });
+}
+
+template<typename T>
+void decode(const std::string &data, Encoding encoding, T &result) {
+    detail::Consumer consumer(detail::target(result));
+    detail::parse(encoding, consumer, data);
+}
+
+template<typename T>
+T decode(const std::string &data, Encoding encoding) {
+    T result{};
+    decode(data, encoding, result);
+    return result;
+}
+
+// Converts between encodings event by event. MessagePack needs every container's size before its elements, which
+// text and indefinite length CBOR / UBJSON don't give, so that one direction goes through a tao::json::value.
+std::string transcode(const std::string &data, Encoding from, Encoding to);
+
+// The encoding of one endpoint: internal RPCs are configured with a binary encoding, public ones with text.
+class Serializer {
+public:
+    explicit Serializer(Encoding encoding = Encoding::text) : encoding_(encoding) {}
+
+    // from the Content-Type of a request
+    explicit Serializer(boost::string_view content_type) : encoding_(encoding_for(content_type)) {}
+
+    Encoding encoding() const { return encoding_; }
+
+    const char *content_type() const { return json::content_type(encoding_); }
+
+    template<typename T>
+    std::string encode(const T &value) const { return json::encode(value, encoding_); }
+
+    tao::json::value decode(const std::string &data) const { return json::decode(data, encoding_); }
+
+    template<typename T>
+    T decode(const std::string &data) const { return json::decode<T>(data, encoding_); }
+
+    template<typename T>
+    void decode(const std::string &data, T &result) const { json::decode(data, encoding_, result); }
+
+private:
+    Encoding encoding_;
+};
+
+}// namespace json
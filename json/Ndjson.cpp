@@ -0,0 +1,43 @@
+#include "Ndjson.h"
+
+#include <cerrno>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include "rapidjson/error/en.h"
+
+namespace json {
+
+std::size_t FdSource::operator()(char *buffer, std::size_t size) const {
+    for (;;) {
+        auto n = ::read(fd, buffer, size);
+        if (n >= 0) {
+            return std::size_t(n);
+        }
+        if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+    }
+}
+
+namespace detail {
+
+std::string describe_parse_error(rapidjson::ParseErrorCode code, std::size_t offset) {
+    return std::string(rapidjson::GetParseError_En(code)) + " (offset " + std::to_string(offset) + ")";
+}
+
+int open_for_reading(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return fd;
+}
+
+void close(int fd) {
+    ::close(fd);
+}
+
+}// namespace detail
+}// namespace json
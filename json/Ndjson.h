@@ -0,0 +1,388 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "rapidjson/reader.h"
+
+namespace json {
+
+class ParseError : public std::runtime_error {
+public:
+    ParseError(std::size_t line, const std::string &message)
+            : std::runtime_error("line " + std::to_string(line) + ": " + message), line_(line) {}
+
+    std::size_t line() const { return line_; }
+
+private:
+    std::size_t line_;
+};
+
+// Registration table: JSON keys of a record object -> members of T.
+//   Fields<Event> fields;
+//   fields.add("id", &Event::id).add("name", &Event::name);
+// Keys that are not registered are skipped, nested objects and arrays included.
+// Missing keys and null values leave the member at its default: records written by loggers often use null for
+// "absent". json::Binding (Binding.h) is strict instead and rejects null unless the member is a nullable_field.
+template<typename T>
+class Fields {
+public:
+    enum class Kind {
+        boolean,
+        integer,
+        integer64,
+        real,
+        string
+    };
+
+    union Member {
+        bool T::*boolean;
+        int T::*integer;
+        int64_t T::*integer64;
+        double T::*real;
+        std::string T::*string;
+    };
+
+    struct Field {
+        std::string name;
+        Kind kind;
+        Member member;
+    };
+
+    Fields &add(std::string name, bool T::*member) {
+        add_field(std::move(name), Kind::boolean).boolean = member;
+        return *this;
+    }
+
+    Fields &add(std::string name, int T::*member) {
+        add_field(std::move(name), Kind::integer).integer = member;
+        return *this;
+    }
+
+    Fields &add(std::string name, int64_t T::*member) {
+        add_field(std::move(name), Kind::integer64).integer64 = member;
+        return *this;
+    }
+
+    Fields &add(std::string name, double T::*member) {
+        add_field(std::move(name), Kind::real).real = member;
+        return *this;
+    }
+
+    Fields &add(std::string name, std::string T::*member) {
+        add_field(std::move(name), Kind::string).string = member;
+        return *this;
+    }
+
+    // a handful of fields: a linear scan on length and bytes beats hashing the key
+    const Field *find(const char *key, std::size_t length) const {
+        for (auto &field : fields_) {
+            if (field.name.size() == length && std::memcmp(field.name.data(), key, length) == 0) {
+                return &field;
+            }
+        }
+        return nullptr;
+    }
+
+    // registered members back to their defaults, strings keep their capacity
+    void clear(T &record) const {
+        for (auto &field : fields_) {
+            switch (field.kind) {
+                case Kind::boolean:
+                    record.*field.member.boolean = false;
+                    break;
+                case Kind::integer:
+                    record.*field.member.integer = 0;
+                    break;
+                case Kind::integer64:
+                    record.*field.member.integer64 = 0;
+                    break;
+                case Kind::real:
+                    record.*field.member.real = 0;
+                    break;
+                case Kind::string:
+                    (record.*field.member.string).clear();
+                    break;
+            }
+        }
+    }
+
+private:
+    Member &add_field(std::string name, Kind kind) {
+        fields_.push_back(Field{std::move(name), kind, {}});
+        return fields_.back().member;
+    }
+
+    std::vector<Field> fields_;
+};
+
+// rapidjson SAX handler that writes the members of one record object straight into a T, no DOM is built.
+template<typename T>
+class RecordHandler {
+public:
+    using Kind = typename Fields<T>::Kind;
+
+    RecordHandler(const Fields<T> &fields, T &record) : fields_(fields), record_(record) {}
+
+    void start() {
+        depth_ = 0;
+        current_ = nullptr;
+        error_.clear();
+        fields_.clear(record_);
+    }
+
+    // why the handler stopped the parse, empty when it was rapidjson itself
+    const std::string &error() const { return error_; }
+
+    bool Null() {
+        if (!scalar()) return error_.empty();
+        return done(); // the member keeps its default
+    }
+
+    bool Bool(bool value) {
+        if (!scalar()) return error_.empty();
+        if (current_->kind != Kind::boolean) return mismatch("a boolean");
+        record_.*current_->member.boolean = value;
+        return done();
+    }
+
+    bool Int(int value) { return signed_integer(value); }
+
+    bool Int64(int64_t value) { return signed_integer(value); }
+
+    bool Uint(unsigned value) { return unsigned_integer(value); }
+
+    bool Uint64(uint64_t value) { return unsigned_integer(value); }
+
+    bool Double(double value) {
+        if (!scalar()) return error_.empty();
+        if (current_->kind != Kind::real) return mismatch("a number with a fraction or exponent");
+        record_.*current_->member.real = value;
+        return done();
+    }
+
+    // only called with kParseNumbersAsStringsFlag, which the reader does not use
+    bool RawNumber(const char *, rapidjson::SizeType, bool) { return false; }
+
+    bool String(const char *value, rapidjson::SizeType length, bool) {
+        if (!scalar()) return error_.empty();
+        if (current_->kind != Kind::string) return mismatch("a string");
+        (record_.*current_->member.string).assign(value, length);
+        return done();
+    }
+
+    bool Key(const char *key, rapidjson::SizeType length, bool) {
+        if (depth_ == 1) {
+            current_ = fields_.find(key, length);
+        }
+        return true;
+    }
+
+    bool StartObject() {
+        if (depth_ == 1 && current_) return mismatch("an object");
+        depth_++;
+        return true;
+    }
+
+    bool EndObject(rapidjson::SizeType) {
+        depth_--;
+        return true;
+    }
+
+    bool StartArray() {
+        if (depth_ == 0) return fail("the record is not an object");
+        if (depth_ == 1 && current_) return mismatch("an array");
+        depth_++;
+        return true;
+    }
+
+    bool EndArray(rapidjson::SizeType) {
+        depth_--;
+        return true;
+    }
+
+private:
+    // true when the value goes into a registered member, a value at the root is an error
+    bool scalar() {
+        if (depth_ == 0) {
+            fail("the record is not an object");
+            return false;
+        }
+        return depth_ == 1 && current_;
+    }
+
+    bool done() {
+        current_ = nullptr;
+        return true;
+    }
+
+    bool signed_integer(int64_t value) {
+        if (!scalar()) return error_.empty();
+        switch (current_->kind) {
+            case Kind::integer:
+                if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+                    return mismatch("an int");
+                }
+                record_.*current_->member.integer = static_cast<int>(value);
+                return done();
+            case Kind::integer64:
+                record_.*current_->member.integer64 = value;
+                return done();
+            case Kind::real:
+                record_.*current_->member.real = static_cast<double>(value);
+                return done();
+            default:
+                return mismatch("an integer");
+        }
+    }
+
+    bool unsigned_integer(uint64_t value) {
+        if (value > uint64_t(std::numeric_limits<int64_t>::max())) {
+            if (!scalar()) return error_.empty();
+            if (current_->kind != Kind::real) return mismatch("an integer above int64");
+            record_.*current_->member.real = static_cast<double>(value);
+            return done();
+        }
+        return signed_integer(static_cast<int64_t>(value));
+    }
+
+    bool mismatch(const char *what) {
+        return fail("field \"" + current_->name + "\" does not take " + what);
+    }
+
+    bool fail(std::string message) {
+        error_ = std::move(message);
+        return false;
+    }
+
+    const Fields<T> &fields_;
+    T &record_;
+    int depth_ = 0;
+    const typename Fields<T>::Field *current_ = nullptr;
+    std::string error_;
+};
+
+// read(2) on a file or socket descriptor, returns 0 at the end of the stream
+struct FdSource {
+    int fd;
+
+    std::size_t operator()(char *buffer, std::size_t size) const;
+};
+
+// Newline delimited JSON (one object per line) read in chunks and parsed with rapidjson's SAX Reader:
+// -> every line is parsed in situ: the '\n' becomes the terminator and strings are decoded in the read buffer
+// -> members go straight from the parser into one reused T through a Fields table, there is no Document
+// -> memory is the read buffer: chunk size plus the longest line, whatever the size of the input
+template<typename T>
+class NdjsonReader {
+public:
+    explicit NdjsonReader(Fields<T> fields, std::size_t chunk_size = 1 << 16)
+            : fields_(std::move(fields)), chunk_size_(chunk_size), handler_(fields_, record_),
+              buffer_(chunk_size + 1) {}
+
+    NdjsonReader(const NdjsonReader &) = delete;
+    NdjsonReader &operator=(const NdjsonReader &) = delete;
+
+    // source(char *buffer, size_t size) -> bytes read, 0 at the end; callback(const T &) for every record.
+    // Returns the number of records, throws ParseError with the line number on invalid input.
+    template<typename Source, typename Callback>
+    std::size_t read(Source &&source, Callback &&callback) {
+        std::size_t records = 0;
+        std::size_t line = 0;
+        std::size_t begin = 0; // unparsed bytes are [begin, end)
+        std::size_t end = 0;
+        std::size_t scanned = 0; // [begin, scanned) has no newline: a long line is searched once, not per chunk
+        bool eof = false;
+        for (;;) {
+            char *data = buffer_.data();
+            while (auto newline = static_cast<char *>(std::memchr(data + scanned, '\n', end - scanned))) {
+                *newline = '\0';
+                records += parse_line(data + begin, ++line, callback);
+                begin = std::size_t(newline + 1 - data);
+                scanned = begin;
+            }
+            if (eof) {
+                if (begin < end) { // the last line has no newline
+                    data[end] = '\0';
+                    records += parse_line(data + begin, ++line, callback);
+                }
+                return records;
+            }
+            // keep the partial line, grow only when a single line does not fit
+            std::memmove(data, data + begin, end - begin);
+            end -= begin;
+            begin = 0;
+            scanned = end;
+            if (buffer_.size() < end + chunk_size_ + 1) {
+                buffer_.resize(end + chunk_size_ + 1); // + 1 for the terminator of an unterminated last line
+            }
+            auto n = source(buffer_.data() + end, chunk_size_);
+            eof = n == 0;
+            end += n;
+        }
+    }
+
+    template<typename Callback>
+    std::size_t read_file(const std::string &path, Callback &&callback);
+
+    // stays at chunk size + longest line
+    std::size_t buffer_capacity() const { return buffer_.capacity(); }
+
+private:
+    template<typename Callback>
+    std::size_t parse_line(char *text, std::size_t line, Callback &callback) {
+        auto p = text;
+        while (*p == ' ' || *p == '\t' || *p == '\r') {
+            p++;
+        }
+        if (*p == '\0') {
+            return 0; // blank line
+        }
+        handler_.start();
+        rapidjson::InsituStringStream stream(p);
+        rapidjson::ParseResult result = reader_.Parse<rapidjson::kParseInsituFlag>(stream, handler_);
+        if (!result) {
+            throw ParseError(line, handler_.error().empty() ? describe(result) : handler_.error());
+        }
+        callback(static_cast<const T &>(record_));
+        return 1;
+    }
+
+    static std::string describe(const rapidjson::ParseResult &result);
+
+    Fields<T> fields_;
+    std::size_t chunk_size_;
+    T record_{};
+    RecordHandler<T> handler_;
+    rapidjson::Reader reader_;
+    std::vector<char> buffer_;
+};
+
+namespace detail {
+std::string describe_parse_error(rapidjson::ParseErrorCode code, std::size_t offset);
+
+int open_for_reading(const std::string &path);
+
+void close(int fd);
+}
+
+template<typename T>
+std::string NdjsonReader<T>::describe(const rapidjson::ParseResult &result) {
+    return detail::describe_parse_error(result.Code(), result.Offset());
+}
+
+template<typename T>
+template<typename Callback>
+std::size_t NdjsonReader<T>::read_file(const std::string &path, Callback &&callback) {
+    struct Closer {
+        int fd;
+
+        ~Closer() { detail::close(fd); }
+    } file{detail::open_for_reading(path)};
+    return read(FdSource{file.fd}, callback);
+}
+
+}// namespace json
@@ -0,0 +1,507 @@
+#include "Path.h"
+
+#include <cstring>
+#include <utility>
+
+namespace json {
+
+struct PathQuery::Node {
+    struct Child {
+        std::string token;
+        int64_t index; // token as an array index, -1 when it isn't one
+        std::unique_ptr<Node> node;
+    };
+
+    std::vector<Child> children;
+    std::vector<std::size_t> slots; // the pointers that end here
+
+    Node *find(boost::string_view key) const {
+        for (auto &child : children) {
+            if (child.token == key) {
+                return child.node.get();
+            }
+        }
+        return nullptr;
+    }
+
+    Node *find(int64_t index) const {
+        for (auto &child : children) {
+            if (child.index == index) {
+                return child.node.get();
+            }
+        }
+        return nullptr;
+    }
+};
+
+namespace {
+
+using Node = PathQuery::Node;
+
+// the bytes that matter when skipping over an object or array
+struct BracketOrQuote {
+    bool table[256] = {};
+
+    BracketOrQuote() {
+        for (unsigned char c : {'"', '{', '}', '[', ']'}) {
+            table[c] = true;
+        }
+    }
+
+    bool operator[](char c) const { return table[static_cast<unsigned char>(c)]; }
+} const bracket_or_quote;
+
+bool is_whitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// 4 hex digits after \u, -1 when invalid
+long code_unit(boost::string_view text, std::size_t at) {
+    if (at + 4 > text.size()) {
+        return -1;
+    }
+    long unit = 0;
+    for (std::size_t i = at; i < at + 4; i++) {
+        auto digit = hex_digit(text[i]);
+        if (digit < 0) {
+            return -1;
+        }
+        unit = unit * 16 + digit;
+    }
+    return unit;
+}
+
+void append_utf8(std::string &out, unsigned long code_point) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        out += static_cast<char>(0xc0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3f));
+    } else if (code_point < 0x10000) {
+        out += static_cast<char>(0xe0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code_point & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code_point & 0x3f));
+    }
+}
+
+// string contents (between the quotes) with the escapes decoded
+std::string unescape(boost::string_view contents) {
+    std::string out;
+    out.reserve(contents.size());
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        if (contents[i] != '\\') {
+            out += contents[i];
+            continue;
+        }
+        if (++i == contents.size()) {
+            throw PathError("unterminated escape");
+        }
+        switch (contents[i]) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                auto unit = code_unit(contents, i + 1);
+                if (unit < 0 || (unit >= 0xdc00 && unit <= 0xdfff)) {
+                    throw PathError("invalid \\u escape");
+                }
+                i += 4;
+                unsigned long code_point = unit;
+                if (unit >= 0xd800 && unit <= 0xdbff) { // a surrogate pair
+                    auto low = i + 2 < contents.size() && contents[i + 1] == '\\' && contents[i + 2] == 'u'
+                               ? code_unit(contents, i + 3) : -1;
+                    if (low < 0xdc00 || low > 0xdfff) {
+                        throw PathError("unpaired surrogate in \\u escape");
+                    }
+                    code_point = 0x10000 + ((unit - 0xd800) << 10) + (low - 0xdc00);
+                    i += 6;
+                }
+                append_utf8(out, code_point);
+                break;
+            }
+            default:
+                throw PathError(std::string("invalid escape \\") + contents[i]);
+        }
+    }
+    return out;
+}
+
+bool key_equals(boost::string_view raw_key, const Node::Child &child) {
+    if (raw_key.find('\\') == boost::string_view::npos) {
+        return raw_key == child.token;
+    }
+    return unescape(raw_key) == child.token;
+}
+
+Node *find_key(const Node &node, boost::string_view raw_key) {
+    for (auto &child : node.children) {
+        if (key_equals(raw_key, child)) {
+            return child.node.get();
+        }
+    }
+    return nullptr;
+}
+
+// One pass over the text along the query tree. A value is only scanned for its structure when it is off the tree.
+class TextScan {
+public:
+    TextScan(boost::string_view text, std::vector<Match> &matches, std::size_t remaining)
+            : begin_(text.data()), end_(text.data() + text.size()), matches_(matches), remaining_(remaining) {}
+
+    void run(const Node &root) {
+        auto p = whitespace(begin_);
+        if (p == end_) {
+            fail(p, "empty document");
+        }
+        value(p, root);
+    }
+
+private:
+    [[noreturn]] void fail(const char *p, const char *message) const {
+        throw IndexError(p - begin_, message);
+    }
+
+    const char *whitespace(const char *p) const {
+        while (p < end_ && is_whitespace(*p)) {
+            ++p;
+        }
+        return p;
+    }
+
+    const char *expect(const char *p, char c) const {
+        if (p == end_ || *p != c) {
+            fail(p, c == ':' ? "expected ':'" : c == '"' ? "expected a key" : "unexpected character");
+        }
+        return p + 1;
+    }
+
+    // p at the opening quote, returns the position after the closing one
+    const char *string_end(const char *p) const {
+        auto start = p + 1;
+        for (auto from = start;;) {
+            auto quote = static_cast<const char *>(std::memchr(from, '"', end_ - from));
+            if (!quote) {
+                fail(p, "unterminated string");
+            }
+            // escaped when preceded by an odd number of backslashes
+            auto backslash = quote;
+            while (backslash > start && backslash[-1] == '\\') {
+                --backslash;
+            }
+            if ((quote - backslash) % 2 == 0) {
+                return quote + 1;
+            }
+            from = quote + 1;
+        }
+    }
+
+    // past the value at p, without looking at what is in it beyond brackets and string boundaries
+    const char *skip(const char *p) const {
+        if (p == end_) {
+            fail(p, "expected a value");
+        }
+        if (*p == '"') {
+            return string_end(p);
+        }
+        if (*p == '{' || *p == '[') {
+            std::size_t depth = 0;
+            for (auto q = p; q < end_;) {
+                while (!bracket_or_quote[*q] && ++q < end_) {
+                }
+                if (q == end_) {
+                    break;
+                }
+                switch (*q) {
+                    case '"':
+                        q = string_end(q);
+                        continue;
+                    case '{':
+                    case '[':
+                        depth++;
+                        break;
+                    case '}':
+                    case ']':
+                        if (--depth == 0) {
+                            return q + 1;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+                ++q;
+            }
+            fail(p, "unbalanced brackets");
+        }
+        auto q = p;
+        while (q < end_ && *q != ',' && *q != '}' && *q != ']' && !is_whitespace(*q)) {
+            ++q;
+        }
+        if (q == p) {
+            fail(p, "expected a value");
+        }
+        return q;
+    }
+
+    const char *value(const char *p, const Node &node) {
+        auto end = node.children.empty() ? skip(p) : descend(p, node);
+        if (done_) {
+            return end;
+        }
+        for (auto slot : node.slots) {
+            if (!matches_[slot].found()) { // the first of duplicate keys
+                matches_[slot] = Match(boost::string_view(p, end - p));
+                remaining_--;
+            }
+        }
+        done_ = remaining_ == 0;
+        return end;
+    }
+
+    const char *descend(const char *p, const Node &node) {
+        if (p == end_ || (*p != '{' && *p != '[')) {
+            return skip(p); // nothing below a scalar
+        }
+        auto close = *p == '{' ? '}' : ']';
+        p = whitespace(p + 1);
+        if (p < end_ && *p == close) {
+            return p + 1;
+        }
+        for (int64_t index = 0;; index++) {
+            const Node *child;
+            if (close == '}') {
+                expect(p, '"');
+                auto key_end = string_end(p);
+                child = find_key(node, boost::string_view(p + 1, key_end - p - 2));
+                p = whitespace(expect(whitespace(key_end), ':'));
+            } else {
+                child = node.find(index);
+            }
+            p = child ? value(p, *child) : skip(p);
+            if (done_) {
+                return p;
+            }
+            p = whitespace(p);
+            if (p < end_ && *p == ',') {
+                p = whitespace(p + 1);
+            } else if (p < end_ && *p == close) {
+                return p + 1;
+            } else {
+                fail(p, close == '}' ? "expected ',' or '}'" : "expected ',' or ']'");
+            }
+        }
+    }
+
+    const char *begin_;
+    const char *end_;
+    std::vector<Match> &matches_;
+    std::size_t remaining_;
+    bool done_ = false;
+};
+
+// The same walk over a StructuralIndex: every step is one structural position.
+class IndexScan {
+public:
+    IndexScan(const StructuralIndex &index, std::vector<Match> &matches, std::size_t remaining)
+            : index_(index), matches_(matches), remaining_(remaining) {}
+
+    void run(const Node &root) {
+        if (index_.size() == 0) {
+            throw IndexError(0, "empty document");
+        }
+        value(0, root);
+    }
+
+private:
+    [[noreturn]] void fail(std::size_t i, const char *message) const {
+        throw IndexError(i < index_.size() ? index_[i] : index_.text().size(), message);
+    }
+
+    char at(std::size_t i) const {
+        if (i >= index_.size()) {
+            fail(i, "unexpected end");
+        }
+        return index_.at(i);
+    }
+
+    boost::string_view raw(std::size_t i, std::size_t next) const {
+        auto c = at(i);
+        if (c != '{' && c != '[') {
+            return index_.scalar(i);
+        }
+        return index_.text().substr(index_[i], index_[next - 1] + 1 - index_[i]);
+    }
+
+    std::size_t value(std::size_t i, const Node &node) {
+        auto next = node.children.empty() ? index_.skip(i) : descend(i, node);
+        if (done_) {
+            return next;
+        }
+        for (auto slot : node.slots) {
+            if (!matches_[slot].found()) {
+                matches_[slot] = Match(raw(i, next));
+                remaining_--;
+            }
+        }
+        done_ = remaining_ == 0;
+        return next;
+    }
+
+    std::size_t descend(std::size_t i, const Node &node) {
+        auto c = at(i);
+        if (c != '{' && c != '[') {
+            return i + 1;
+        }
+        auto close = c == '{' ? '}' : ']';
+        if (at(++i) == close) {
+            return i + 1;
+        }
+        for (int64_t index = 0;; index++) {
+            const Node *child;
+            if (close == '}') {
+                if (at(i) != '"') {
+                    fail(i, "expected a key");
+                }
+                auto key = index_.scalar(i);
+                child = find_key(node, key.substr(1, key.size() - 2));
+                if (at(++i) != ':') {
+                    fail(i, "expected ':'");
+                }
+                ++i;
+            } else {
+                child = node.find(index);
+            }
+            i = child ? value(i, *child) : index_.skip(i);
+            if (done_) {
+                return i;
+            }
+            if (at(i) == close) {
+                return i + 1;
+            }
+            if (at(i) != ',') {
+                fail(i, close == '}' ? "expected ',' or '}'" : "expected ',' or ']'");
+            }
+            ++i;
+        }
+    }
+
+    const StructuralIndex &index_;
+    std::vector<Match> &matches_;
+    std::size_t remaining_;
+    bool done_ = false;
+};
+
+// "0", "17": the array index of a reference token; "-", "01", "x": -1
+int64_t array_index(const std::string &token) {
+    if (token.empty() || token.size() > 18 || (token.size() > 1 && token[0] == '0')) {
+        return -1;
+    }
+    int64_t index = 0;
+    for (char c : token) {
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        index = index * 10 + (c - '0');
+    }
+    return index;
+}
+
+}// namespace
+
+boost::string_view Match::unquoted() const {
+    if (!is_string()) {
+        throw PathError(found() ? "expected a string, got " + raw_.to_string() : "no value at this path");
+    }
+    return raw_.substr(1, raw_.size() - 2);
+}
+
+boost::string_view Match::found_raw() const {
+    if (!found()) {
+        throw PathError("no value at this path");
+    }
+    return raw_;
+}
+
+std::string Match::string() const {
+    return unescape(unquoted());
+}
+
+PathQuery::PathQuery() : root_(new Node) {}
+
+PathQuery::PathQuery(std::initializer_list<std::string> pointers) : PathQuery() {
+    for (auto &pointer : pointers) {
+        add(pointer);
+    }
+}
+
+PathQuery::PathQuery(PathQuery &&) noexcept = default;
+
+PathQuery &PathQuery::operator=(PathQuery &&) noexcept = default;
+
+PathQuery::~PathQuery() = default;
+
+std::size_t PathQuery::add(const std::string &pointer) {
+    if (!pointer.empty() && pointer[0] != '/') {
+        throw PathError("JSON pointer must be empty or start with '/': " + pointer);
+    }
+    auto node = root_.get();
+    std::size_t at = 0;
+    while (at < pointer.size()) {
+        auto next = pointer.find('/', at + 1);
+        if (next == std::string::npos) {
+            next = pointer.size();
+        }
+        std::string token;
+        for (auto i = at + 1; i < next; i++) {
+            if (pointer[i] != '~') {
+                token += pointer[i];
+            } else if (i + 1 < next && (pointer[i + 1] == '0' || pointer[i + 1] == '1')) {
+                token += pointer[++i] == '0' ? '~' : '/';
+            } else {
+                throw PathError("invalid '~' escape in JSON pointer: " + pointer);
+            }
+        }
+        auto child = node->find(boost::string_view(token));
+        if (!child) {
+            auto index = array_index(token);
+            node->children.push_back({std::move(token), index, std::unique_ptr<Node>(new Node)});
+            child = node->children.back().node.get();
+        }
+        node = child;
+        at = next;
+    }
+    node->slots.push_back(pointers_);
+    return pointers_++;
+}
+
+void PathQuery::run(boost::string_view text, std::vector<Match> &matches) const {
+    matches.assign(pointers_, Match());
+    if (pointers_) {
+        TextScan(text, matches, pointers_).run(*root_);
+    }
+}
+
+void PathQuery::run(const StructuralIndex &index, std::vector<Match> &matches) const {
+    matches.assign(pointers_, Match());
+    if (pointers_) {
+        IndexScan(index, matches, pointers_).run(*root_);
+    }
+}
+
+}// namespace json
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+
+#include "Structural.h"
+#include "strings/FastCast.h"
+
+namespace json {
+
+class PathError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// The text of one value in the document, empty when the path was not found.
+class Match {
+public:
+    Match() = default;
+
+    explicit Match(boost::string_view raw) : raw_(raw) {}
+
+    bool found() const { return !raw_.empty(); }
+
+    // the value as it is in the document: strings with quotes and escapes, objects and arrays with everything in them
+    boost::string_view raw() const { return raw_; }
+
+    bool is_null() const { return raw_ == "null"; }
+
+    bool is_string() const { return !raw_.empty() && raw_[0] == '"'; }
+
+    // string contents without the quotes, escapes are left as they are
+    boost::string_view unquoted() const;
+
+    // numbers through strings::fast_cast (BadCast when the value is not one), "true" / "false", or a string with its
+    // escapes decoded; PathError when not found or not of that kind
+    template<typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, T>::type as() const {
+        return strings::fast_cast<T>(found_raw());
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_same<T, bool>::value, T>::type as() const {
+        auto raw = found_raw();
+        if (raw != "true" && raw != "false") {
+            throw PathError("expected a boolean, got " + raw.to_string());
+        }
+        return raw == "true";
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_same<T, std::string>::value, T>::type as() const { return string(); }
+
+private:
+    boost::string_view found_raw() const;
+
+    std::string string() const;
+
+    boost::string_view raw_;
+};
+
+// Lazy extraction by JSON pointer (RFC 6901: "/a/0", "/b/x", "/a~1b" for the key "a/b")
+// A lookup like v1.at("a").at(0) on a tao::json::value first parses the whole document into a tree. Here all
+// pointers are looked up together in one pass over the text, without building anything:
+// -> the pointers are merged into a tree of path steps, members and elements off that tree are skipped by
+//    matching brackets (their strings and numbers are never decoded)
+// -> the scan stops as soon as every pointer has its value, the rest of the document is not read
+// -> values come back as views into the text, converted only when asked
+//
+//   json::PathQuery query{"/user", "/items/0/sku"};
+//   std::vector<json::Match> matches;
+//   query.run(text, matches);
+//   auto user = matches[0].as<std::string>();
+//
+// The scan checks the structure along the path it takes, not in the skipped parts. A StructuralIndex can be used
+// instead of the text, then skipping is a walk over structural positions.
+class PathQuery {
+public:
+    PathQuery();
+
+    PathQuery(std::initializer_list<std::string> pointers);
+
+    PathQuery(PathQuery &&) noexcept;
+
+    PathQuery &operator=(PathQuery &&) noexcept;
+
+    ~PathQuery();
+
+    // returns the index of the pointer's match, throws PathError for an invalid pointer
+    std::size_t add(const std::string &pointer);
+
+    std::size_t size() const { return pointers_; }
+
+    // matches gets one Match per pointer, in the order they were added; throws IndexError for malformed JSON
+    void run(boost::string_view text, std::vector<Match> &matches) const;
+
+    void run(const StructuralIndex &index, std::vector<Match> &matches) const;
+
+    std::vector<Match> run(boost::string_view text) const {
+        std::vector<Match> matches;
+        run(text, matches);
+        return matches;
+    }
+
+    struct Node;
+
+private:
+    std::unique_ptr<Node> root_;
+    std::size_t pointers_ = 0;
+};
+
+}// namespace json
@@ -0,0 +1,364 @@
+#include "Structural.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define JSON_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace json {
+
+namespace {
+
+using Masks = StructuralIndex::Masks;
+
+bool is_op(unsigned char c) {
+    return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+}
+
+bool is_whitespace(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+void classify_scalar(const char *block, Masks &masks) {
+    masks = Masks{};
+    for (int i = 0; i < 64; i++) {
+        auto c = static_cast<unsigned char>(block[i]);
+        auto bit = uint64_t(1) << i;
+        masks.quote |= c == '"' ? bit : 0;
+        masks.backslash |= c == '\\' ? bit : 0;
+        masks.op |= is_op(c) ? bit : 0;
+        masks.whitespace |= is_whitespace(c) ? bit : 0;
+        masks.control |= c < 0x20 ? bit : 0;
+        masks.non_ascii |= c >= 0x80 ? bit : 0;
+    }
+}
+
+// x ^ (x << 1) ^ (x << 2) ... : bit i is the parity of the bits at or below i
+uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+#ifdef JSON_X86_SIMD
+void classify_sse2(const char *block, Masks &masks) {
+    masks = Masks{};
+    const auto quote = _mm_set1_epi8('"');
+    const auto backslash = _mm_set1_epi8('\\');
+    const auto control = _mm_set1_epi8(0x1f);
+    for (int i = 0; i < 4; i++) {
+        auto data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i * 16));
+        auto op = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8('{')), _mm_cmpeq_epi8(data, _mm_set1_epi8('}'))),
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8('[')),
+                                          _mm_cmpeq_epi8(data, _mm_set1_epi8(']'))),
+                             _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8(':')),
+                                          _mm_cmpeq_epi8(data, _mm_set1_epi8(',')))));
+        auto whitespace = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(data, _mm_set1_epi8('\t'))),
+                _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(data, _mm_set1_epi8('\r'))));
+        auto shift = i * 16;
+        masks.quote |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(data, quote)))) << shift;
+        masks.backslash |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(data, backslash)))) << shift;
+        masks.op |= uint64_t(uint32_t(_mm_movemask_epi8(op))) << shift;
+        masks.whitespace |= uint64_t(uint32_t(_mm_movemask_epi8(whitespace))) << shift;
+        // unsigned c <= 0x1f
+        masks.control |= uint64_t(uint32_t(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(_mm_min_epu8(data, control), data)))) << shift;
+        masks.non_ascii |= uint64_t(uint32_t(_mm_movemask_epi8(data))) << shift;
+    }
+}
+
+__attribute__((target("avx2")))
+inline __m256i equal(__m256i data, char c) {
+    return _mm256_cmpeq_epi8(data, _mm256_set1_epi8(c));
+}
+
+__attribute__((target("avx2")))
+void classify_avx2(const char *block, Masks &masks) {
+    masks = Masks{};
+    const auto quote = _mm256_set1_epi8('"');
+    const auto backslash = _mm256_set1_epi8('\\');
+    const auto control = _mm256_set1_epi8(0x1f);
+    for (int i = 0; i < 2; i++) {
+        auto data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i * 32));
+        auto op = _mm256_or_si256(_mm256_or_si256(equal(data, '{'), equal(data, '}')),
+                                  _mm256_or_si256(_mm256_or_si256(equal(data, '['), equal(data, ']')),
+                                                  _mm256_or_si256(equal(data, ':'), equal(data, ','))));
+        auto whitespace = _mm256_or_si256(_mm256_or_si256(equal(data, ' '), equal(data, '\t')),
+                                          _mm256_or_si256(equal(data, '\n'), equal(data, '\r')));
+        auto shift = i * 32;
+        masks.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, quote)))) << shift;
+        masks.backslash |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, backslash)))) << shift;
+        masks.op |= uint64_t(uint32_t(_mm256_movemask_epi8(op))) << shift;
+        masks.whitespace |= uint64_t(uint32_t(_mm256_movemask_epi8(whitespace))) << shift;
+        masks.control |= uint64_t(uint32_t(_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(_mm256_min_epu8(data, control), data)))) << shift;
+        masks.non_ascii |= uint64_t(uint32_t(_mm256_movemask_epi8(data))) << shift;
+    }
+}
+
+// first byte >= 0x80 in [p, end), or end
+const char *skip_ascii_sse2(const char *p, const char *end) {
+    for (; end - p >= 16; p += 16) {
+        auto high = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        if (high) {
+            return p + __builtin_ctz(high);
+        }
+    }
+    while (p < end && static_cast<unsigned char>(*p) < 0x80) {
+        ++p;
+    }
+    return p;
+}
+
+__attribute__((target("avx2")))
+const char *skip_ascii_avx2(const char *p, const char *end) {
+    for (; end - p >= 32; p += 32) {
+        auto high = _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+        if (high) {
+            return p + __builtin_ctz(high);
+        }
+    }
+    return skip_ascii_sse2(p, end);
+}
+#endif
+
+const char *skip_ascii_scalar(const char *p, const char *end) {
+    while (p < end && static_cast<unsigned char>(*p) < 0x80) {
+        ++p;
+    }
+    return p;
+}
+
+Kernel resolve(Kernel kernel) {
+    if (kernel == Kernel::automatic) {
+        kernel = kernel_supported(Kernel::avx2) ? Kernel::avx2
+                                                : kernel_supported(Kernel::sse2) ? Kernel::sse2 : Kernel::scalar;
+    }
+    if (!kernel_supported(kernel)) {
+        throw std::invalid_argument("json: kernel not supported for this cpu");
+    }
+    return kernel;
+}
+
+bool continuation(const char *p, const char *end) {
+    return p < end && (static_cast<unsigned char>(*p) & 0xc0) == 0x80;
+}
+
+// length of the UTF-8 sequence at p (p < end, *p >= 0x80), 0 when invalid
+int sequence_length(const char *p, const char *end) {
+    auto c = static_cast<unsigned char>(p[0]);
+    if (c >= 0xc2 && c <= 0xdf) {
+        return continuation(p + 1, end) ? 2 : 0;
+    }
+    if (c >= 0xe0 && c <= 0xef) {
+        if (!continuation(p + 1, end) || !continuation(p + 2, end)) {
+            return 0;
+        }
+        auto second = static_cast<unsigned char>(p[1]);
+        if ((c == 0xe0 && second < 0xa0) || (c == 0xed && second > 0x9f)) { // overlong, surrogate
+            return 0;
+        }
+        return 3;
+    }
+    if (c >= 0xf0 && c <= 0xf4) {
+        if (!continuation(p + 1, end) || !continuation(p + 2, end) || !continuation(p + 3, end)) {
+            return 0;
+        }
+        auto second = static_cast<unsigned char>(p[1]);
+        if ((c == 0xf0 && second < 0x90) || (c == 0xf4 && second > 0x8f)) { // overlong, above U+10FFFF
+            return 0;
+        }
+        return 4;
+    }
+    return 0;
+}
+
+// validates code points starting in [p, until), returns where the last one ends or nullptr when invalid
+const char *validate_utf8(const char *p, const char *until, const char *end) {
+    while (p < until) {
+        if (static_cast<unsigned char>(*p) < 0x80) {
+            ++p;
+            continue;
+        }
+        auto length = sequence_length(p, end);
+        if (!length) {
+            return nullptr;
+        }
+        p += length;
+    }
+    return p;
+}
+
+}// namespace
+
+bool kernel_supported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::automatic:
+        case Kernel::scalar:
+            return true;
+#ifdef JSON_X86_SIMD
+        case Kernel::sse2:
+            return true;
+        case Kernel::avx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+bool is_valid_utf8(boost::string_view text, Kernel kernel) {
+    kernel = resolve(kernel);
+    auto skip_ascii = skip_ascii_scalar;
+#ifdef JSON_X86_SIMD
+    if (kernel == Kernel::avx2) {
+        skip_ascii = skip_ascii_avx2;
+    } else if (kernel == Kernel::sse2) {
+        skip_ascii = skip_ascii_sse2;
+    }
+#endif
+    auto p = text.data();
+    auto end = p + text.size();
+    while ((p = skip_ascii(p, end)) < end) {
+        auto length = sequence_length(p, end);
+        if (!length) {
+            return false;
+        }
+        p += length;
+    }
+    return true;
+}
+
+StructuralIndex::StructuralIndex(Kernel kernel) : kernel_(resolve(kernel)) {
+    classify_ = classify_scalar;
+#ifdef JSON_X86_SIMD
+    if (kernel_ == Kernel::avx2) {
+        classify_ = classify_avx2;
+    } else if (kernel_ == Kernel::sse2) {
+        classify_ = classify_sse2;
+    }
+#endif
+}
+
+void StructuralIndex::build(boost::string_view text) {
+    if (text.size() > UINT32_MAX) {
+        throw IndexError(0, "input larger than 4GB");
+    }
+    text_ = text;
+    size_ = 0;
+    // room for every byte plus one block, so positions are written without checks
+    if (capacity_ < text.size() + 64) {
+        capacity_ = text.size() + 64;
+        positions_.reset(new uint32_t[capacity_]);
+    }
+    auto out = positions_.get();
+
+    const auto begin = text.data();
+    const auto end = begin + text.size();
+    const uint64_t even_bits = 0x5555555555555555ULL;
+    uint64_t escaped_carry = 0;  // 1 when the next block starts with an escaped character
+    uint64_t in_string_carry = 0; // all ones when the next block starts inside a string
+    uint64_t scalar_carry = 0;    // 1 when the last byte of the block was part of an unquoted scalar
+    const char *utf8_checked = begin;
+
+    for (auto block = begin; block < end; block += 64) {
+        Masks masks;
+        auto available = end - block;
+        if (available >= 64) {
+            classify_(block, masks);
+        } else {
+            char tail[64];
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, block, available);
+            classify_(tail, masks);
+        }
+
+        // escaped characters: the odd positions of backslash runs that start on an even bit and vice versa
+        auto backslash = masks.backslash & ~escaped_carry;
+        auto follows_escape = backslash << 1 | escaped_carry;
+        auto odd_starts = backslash & ~even_bits & ~follows_escape;
+        uint64_t even_sequences;
+        escaped_carry = __builtin_add_overflow(odd_starts, backslash, &even_sequences);
+        auto escaped = (even_bits ^ (even_sequences << 1)) & follows_escape;
+
+        // in_string: from an opening quote up to, not including, its closing quote
+        auto quote = masks.quote & ~escaped;
+        auto in_string = prefix_xor(quote) ^ in_string_carry;
+        in_string_carry = uint64_t(int64_t(in_string) >> 63);
+        auto string_tail = in_string ^ quote; // string contents and closing quotes
+
+        if (masks.control & in_string & ~quote) {
+            auto at = block - begin + __builtin_ctzll(masks.control & in_string & ~quote);
+            throw IndexError(at, "control character in string");
+        }
+        if (masks.non_ascii && block + 64 > utf8_checked) {
+            auto first = std::max(block + __builtin_ctzll(masks.non_ascii), utf8_checked);
+            utf8_checked = validate_utf8(first, std::min(block + 64, end), end);
+            if (!utf8_checked) {
+                throw IndexError(first - begin, "invalid UTF-8");
+            }
+        }
+
+        // a scalar starts at a quote or at a non-whitespace, non-op byte that doesn't follow one of its kind
+        auto scalar = ~(masks.op | masks.whitespace);
+        auto unquoted = scalar & ~quote;
+        auto follows_unquoted = unquoted << 1 | scalar_carry;
+        scalar_carry = unquoted >> 63;
+        auto structurals = (masks.op | (scalar & ~follows_unquoted)) & ~string_tail;
+
+        auto base = static_cast<uint32_t>(block - begin);
+        while (structurals) {
+            *out++ = base + __builtin_ctzll(structurals);
+            structurals &= structurals - 1;
+        }
+    }
+    if (in_string_carry) {
+        throw IndexError(text.size(), "unterminated string");
+    }
+    size_ = out - positions_.get();
+}
+
+std::size_t StructuralIndex::skip(std::size_t i) const {
+    auto c = at(i);
+    if (c != '{' && c != '[') {
+        return i + 1;
+    }
+    std::size_t depth = 0;
+    for (; i < size_; i++) {
+        switch (at(i)) {
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0) {
+                    return i + 1;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    throw IndexError(text_.size(), "unbalanced brackets");
+}
+
+boost::string_view StructuralIndex::scalar(std::size_t i) const {
+    auto begin = positions_[i];
+    std::size_t end = i + 1 < size_ ? positions_[i + 1] : text_.size();
+    while (end > begin && is_whitespace(static_cast<unsigned char>(text_[end - 1]))) {
+        end--;
+    }
+    return text_.substr(begin, end - begin);
+}
+
+}// namespace json
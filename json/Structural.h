@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <boost/utility/string_view.hpp>
+
+namespace json {
+
+class IndexError : public std::runtime_error {
+public:
+    IndexError(std::size_t offset, const std::string &message)
+            : std::runtime_error("offset " + std::to_string(offset) + ": " + message), offset_(offset) {}
+
+    std::size_t offset() const { return offset_; }
+
+private:
+    std::size_t offset_;
+};
+
+// instruction set used to classify the input, automatic picks the best one the cpu supports
+enum class Kernel {
+    automatic,
+    scalar,
+    sse2,
+    avx2
+};
+
+bool kernel_supported(Kernel kernel);
+
+// ASCII runs are checked 16 / 32 bytes at a time, multi-byte sequences one code point at a time (overlong forms,
+// surrogates and code points above U+10FFFF are invalid)
+bool is_valid_utf8(boost::string_view text, Kernel kernel = Kernel::automatic);
+
+// Structural index (stage 1 of simdjson)
+// Both parsers in json.cpp look at the input one byte at a time. Here 64 bytes at a time are classified into bit
+// masks, and string boundaries come out of mask arithmetic instead of a state machine:
+// -> escaped characters: odd length runs of backslashes, with a carry into the next block
+// -> inside strings: prefix xor of the unescaped quotes
+// -> structurals: { } [ ] : , outside strings, plus where every string and every other scalar starts
+// The positions of these are all a consumer needs to walk the document: what follows a key, where a value ends,
+// how to step over an object without looking at its bytes. Grammar is not checked, unterminated strings, control
+// characters in strings and invalid UTF-8 are.
+class StructuralIndex {
+public:
+    explicit StructuralIndex(Kernel kernel = Kernel::automatic);
+
+    // indexes text, which must outlive the index; throws IndexError. The position buffer is reused between builds.
+    void build(boost::string_view text);
+
+    boost::string_view text() const { return text_; }
+
+    Kernel kernel() const { return kernel_; }
+
+    std::size_t size() const { return size_; }
+
+    uint32_t operator[](std::size_t i) const { return positions_[i]; }
+
+    // character at the i-th structural position
+    char at(std::size_t i) const { return text_[positions_[i]]; }
+
+    // index of the first structural after the value that starts at the i-th one
+    std::size_t skip(std::size_t i) const;
+
+    // text of the scalar (string with its quotes, number, literal) that starts at the i-th structural
+    boost::string_view scalar(std::size_t i) const;
+
+    struct Masks {
+        uint64_t quote;
+        uint64_t backslash;
+        uint64_t op;
+        uint64_t whitespace;
+        uint64_t control;
+        uint64_t non_ascii;
+    };
+
+private:
+    boost::string_view text_;
+    // one slot per input byte, left uninitialized: only the written ones are touched
+    std::unique_ptr<uint32_t[]> positions_;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+    Kernel kernel_;
+    void (*classify_)(const char *, Masks &);
+};
+
+}// namespace json
@@ -0,0 +1,966 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "rapidjson/document.h"
+
+#include "Binding.h"
+#include "DocumentPool.h"
+#include "Encoding.h"
+#include "Path.h"
+#include "Structural.h"
+#include "Ndjson.h"
+#include "benchmark/Allocations.h"
+#include "benchmark/Timer.h"
+
+// Streaming NDJSON ingestion
+// json.cpp parses with Document::Parse: the whole text becomes a DOM of rapidjson::Value's (and copies of every
+// string) before a single field is read. For a stream of records the SAX Reader can deliver every member straight
+// into the struct it belongs to, one line at a time in a fixed buffer.
+
+namespace {
+struct Event {
+    int id = 0;
+    int64_t timestamp = 0;
+    std::string user;
+    double amount = 0;
+    bool flagged = false;
+};
+
+json::Fields<Event> event_fields() {
+    json::Fields<Event> fields;
+    fields.add("id", &Event::id)
+            .add("timestamp", &Event::timestamp)
+            .add("user", &Event::user)
+            .add("amount", &Event::amount)
+            .add("flagged", &Event::flagged);
+    return fields;
+}
+
+// reads a string in pieces of at most `piece` bytes, like a socket would
+struct StringSource {
+    const std::string &text;
+    std::size_t piece;
+    std::size_t offset = 0;
+
+    std::size_t operator()(char *buffer, std::size_t size) {
+        auto n = std::min(std::min(size, piece), text.size() - offset);
+        std::memcpy(buffer, text.data() + offset, n);
+        offset += n;
+        return n;
+    }
+};
+
+std::string event_line(std::mt19937 &random, int id) {
+    return "{\"id\":" + std::to_string(id) + ",\"timestamp\":" + std::to_string(1600000000000LL + id) +
+           ",\"user\":\"user" + std::to_string(random() % 1000) + "\",\"amount\":" +
+           std::to_string(random() % 100000) + ".25,\"flagged\":" + (random() % 2 ? "true" : "false") +
+           ",\"tags\":[\"a\",{\"nested\":1}],\"meta\":{\"source\":\"web\",\"id\":\"not this one\"}}\n";
+}
+}
+
+TEST(ndjson, records_into_structs) {
+    std::string input = "{\"id\": 1, \"user\": \"alice\", \"amount\": 12.5, \"flagged\": true, \"timestamp\": 1600000000000}\n"
+                        "\n"
+                        "{\"user\": \"bob\", \"extra\": {\"id\": 99, \"list\": [1, 2, [3]]}, \"amount\": 3}\r\n"
+                        "{\"id\": 3, \"user\": \"esc\\\"aped\", \"amount\": null}";
+    json::NdjsonReader<Event> reader(event_fields());
+    std::vector<Event> events;
+    auto records = reader.read(StringSource{input, input.size()}, [&](const Event &e) { events.push_back(e); });
+
+    ASSERT_EQ(3u, records);
+    EXPECT_EQ(1, events[0].id);
+    EXPECT_EQ(1600000000000LL, events[0].timestamp);
+    EXPECT_EQ("alice", events[0].user);
+    EXPECT_EQ(12.5, events[0].amount);
+    EXPECT_TRUE(events[0].flagged);
+
+    // members that are missing or null get their defaults, nested objects are skipped
+    EXPECT_EQ(0, events[1].id);
+    EXPECT_EQ("bob", events[1].user);
+    EXPECT_EQ(3.0, events[1].amount); // an integer for a double member
+    EXPECT_FALSE(events[1].flagged);
+
+    EXPECT_EQ(3, events[2].id);
+    EXPECT_EQ("esc\"aped", events[2].user);
+    EXPECT_EQ(0.0, events[2].amount);
+}
+
+TEST(ndjson, lines_across_chunks_and_constant_buffer) {
+    std::mt19937 random(1);
+    std::string input;
+    for (int id = 0; id < 1000; id++) {
+        input += event_line(random, id);
+    }
+    // 16 byte chunks from a source that returns 7 bytes at a time: every line spans many reads
+    json::NdjsonReader<Event> reader(event_fields(), 16);
+    int expected_id = 0;
+    auto records = reader.read(StringSource{input, 7}, [&](const Event &e) {
+        EXPECT_EQ(expected_id++, e.id);
+    });
+    EXPECT_EQ(1000u, records);
+    EXPECT_LT(reader.buffer_capacity(), 2 * 16 + input.size() / 1000 * 2); // the longest line, not the input
+}
+
+TEST(ndjson, long_line_in_small_chunks) {
+    std::mt19937 random(3);
+    std::string user(100000, 'u');
+    std::string input = event_line(random, 0) + "{\"id\": 1, \"user\": \"" + user + "\"}\n" + event_line(random, 2) +
+                        event_line(random, 3);
+    json::NdjsonReader<Event> reader(event_fields(), 16);
+    std::vector<int> ids;
+    std::string long_user;
+    auto records = reader.read(StringSource{input, 7}, [&](const Event &e) {
+        ids.push_back(e.id);
+        if (e.id == 1) {
+            long_user = e.user;
+        }
+    });
+    EXPECT_EQ(4u, records);
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), ids);
+    EXPECT_EQ(user, long_user);
+}
+
+TEST(ndjson, errors_name_the_line) {
+    json::NdjsonReader<Event> reader(event_fields());
+    auto ignore = [](const Event &) {};
+
+    std::string input = "{\"id\": 1}\n{\"id\": \"one\"}\n";
+    try {
+        reader.read(StringSource{input, input.size()}, ignore);
+        FAIL();
+    } catch (const json::ParseError &e) {
+        EXPECT_EQ(2u, e.line());
+        EXPECT_NE(std::string::npos, std::string(e.what()).find("\"id\""));
+    }
+
+    input = "{\"id\": 1}\n{\"id\": 2,\n";
+    EXPECT_THROW(reader.read(StringSource{input, input.size()}, ignore), json::ParseError);
+    input = "[1, 2]\n";
+    EXPECT_THROW(reader.read(StringSource{input, input.size()}, ignore), json::ParseError);
+    input = "{\"id\": 3000000000}\n"; // does not fit the int member
+    EXPECT_THROW(reader.read(StringSource{input, input.size()}, ignore), json::ParseError);
+}
+
+TEST(ndjson, read_file) {
+    auto path = testing::TempDir() + "ndjson_read_file.ndjson";
+    {
+        std::ofstream file(path);
+        file << "{\"id\": 7, \"user\": \"carol\"}\n{\"id\": 8, \"user\": \"dave\"}\n";
+    }
+    json::NdjsonReader<Event> reader(event_fields());
+    std::vector<std::string> users;
+    EXPECT_EQ(2u, reader.read_file(path, [&](const Event &e) { users.push_back(e.user); }));
+    EXPECT_EQ(std::vector<std::string>({"carol", "dave"}), users);
+    EXPECT_THROW(reader.read_file("/no/such/file.ndjson", [](const Event &) {}), std::system_error);
+}
+
+// ~256MB of NDJSON: one Document per line (Parse, then read the members) vs the SAX reader
+TEST(json_benchmark, DISABLED_ndjson_dom_vs_sax) {
+    auto path = testing::TempDir() + "json_benchmark.ndjson";
+    std::size_t lines = 0;
+    {
+        std::ofstream file(path);
+        std::mt19937 random(2);
+        std::size_t written = 0;
+        while (written < 256 * 1024 * 1024) {
+            auto line = event_line(random, int(lines++));
+            file << line;
+            written += line.size();
+        }
+    }
+
+    double dom_sum = 0;
+    {
+        benchmark::Timer t("rapidjson::Document per line, std::getline");
+        std::ifstream file(path);
+        std::string line;
+        rapidjson::Document document;
+        while (std::getline(file, line)) {
+            document.Parse(line.c_str());
+            Event e;
+            e.id = document["id"].GetInt();
+            e.timestamp = document["timestamp"].GetInt64();
+            e.user = document["user"].GetString();
+            e.amount = document["amount"].GetDouble();
+            e.flagged = document["flagged"].GetBool();
+            dom_sum += e.amount;
+        }
+    }
+
+    double sax_sum = 0;
+    json::NdjsonReader<Event> reader(event_fields());
+    std::size_t records;
+    {
+        benchmark::Timer t("NdjsonReader, SAX in situ into Event");
+        records = reader.read_file(path, [&](const Event &e) { sax_sum += e.amount; });
+    }
+    std::cout << "[benchmark] NdjsonReader buffer: " << reader.buffer_capacity() << " bytes" << std::endl;
+    EXPECT_EQ(lines, records);
+    EXPECT_EQ(dom_sum, sax_sum);
+    std::remove(path.c_str());
+}
+
+// Document pool
+// Every rapidjson::Document in json.cpp brings its own MemoryPoolAllocator, which mallocs chunks while parsing and
+// frees them with the document. A pooled document keeps its memory for the next request.
+
+namespace {
+std::string request_json(int items) {
+    std::string json = "{\"user\": \"alice\", \"items\": [";
+    for (int i = 0; i < items; i++) {
+        json += (i ? "," : "") + std::string("{\"sku\": \"sku-") + std::to_string(i) + "\", \"quantity\": " +
+                std::to_string(i % 7) + ", \"price\": 9.95}";
+    }
+    return json + "]}";
+}
+}
+
+TEST(document_pool, documents_are_recycled) {
+    json::DocumentPool pool;
+    json::DocumentPool::Document *first;
+    {
+        auto document = pool.acquire();
+        document->Parse(request_json(3).c_str());
+        ASSERT_FALSE(document->HasParseError());
+        EXPECT_EQ(3u, (*document)["items"].Size());
+        first = &*document;
+    }
+    EXPECT_EQ(1u, pool.idle());
+    auto document = pool.acquire();
+    EXPECT_EQ(first, &*document);
+    EXPECT_TRUE(document->IsNull());
+    EXPECT_EQ(0u, pool.idle());
+}
+
+TEST(document_pool, arena_grows_to_the_high_water_mark) {
+    json::DocumentPool pool(4 * 1024);
+    auto big = request_json(2000); // far more than 4KB of values
+    for (int i = 0; i < 3; i++) {
+        auto document = pool.acquire();
+        document->Parse(big.c_str());
+        ASSERT_FALSE(document->HasParseError());
+    }
+    auto arenas = pool.arenas_created();
+    for (int i = 0; i < 100; i++) {
+        auto document = pool.acquire();
+        document->Parse(big.c_str());
+        EXPECT_EQ(2000u, (*document)["items"].Size());
+    }
+    EXPECT_EQ(arenas, pool.arenas_created());
+}
+
+TEST(document_pool, steady_state_does_not_allocate) {
+    json::DocumentPool pool;
+    auto body = request_json(50);
+    for (int i = 0; i < 3; i++) {
+        auto document = pool.acquire();
+        document->Parse(body.c_str());
+    }
+    auto arenas = pool.arenas_created();
+    // rapidjson mallocs its chunks and stacks, which the counter doesn't see: a chunk needed by either allocator shows
+    // up as new arenas on release, a stack outside the pool as a parse that used none of the stack arena
+    std::size_t stack_used = body.size();
+    auto before = benchmark::thread_allocations();
+    for (int i = 0; i < 100; i++) {
+        auto document = pool.acquire();
+        document->Parse(body.c_str());
+        stack_used = std::min(stack_used, document.stack_allocator().Size());
+    }
+    EXPECT_EQ(before, benchmark::thread_allocations());
+    EXPECT_EQ(arenas, pool.arenas_created());
+    EXPECT_LT(0u, stack_used);
+}
+
+TEST(document_pool, deep_copy_across_documents) {
+    auto &pool = json::DocumentPool::local();
+    auto d = pool.acquire();
+    d->SetObject();
+    {
+        auto e = pool.acquire();
+        std::string inner = "{\"number1\": 6, \"number2\": 7, \"name\": \"inner\", \"list\": [1, \"two\"]}";
+        e->ParseInsitu(&inner[0]); // strings point into `inner`
+        json::add_member_copy(*d, "Inner", *e, d.allocator());
+        std::fill(inner.begin(), inner.end(), 'x');
+    } // e's arena is cleared and reused
+    {
+        auto reuse = pool.acquire();
+        reuse->Parse(request_json(100).c_str());
+    }
+    const rapidjson::Value &inner = (*d)["Inner"];
+    EXPECT_EQ(6, inner["number1"].GetInt());
+    EXPECT_EQ(7, inner["number2"].GetInt());
+    EXPECT_EQ(std::string("inner"), inner["name"].GetString());
+    EXPECT_EQ(std::string("two"), inner["list"][1].GetString());
+}
+
+// 50k requests: parse, read every item
+TEST(json_benchmark, DISABLED_document_per_request_vs_pool) {
+    const int requests = 50000;
+    auto body = request_json(50);
+
+    int64_t quantity = 0;
+    {
+        benchmark::Timer t("50k requests, new rapidjson::Document each");
+        for (int i = 0; i < requests; i++) {
+            rapidjson::Document document;
+            document.Parse(body.c_str());
+            const rapidjson::Value &items = document["items"];
+            for (auto item = items.Begin(); item != items.End(); ++item) {
+                quantity += (*item)["quantity"].GetInt();
+            }
+        }
+    }
+    int64_t pooled_quantity = 0;
+    json::DocumentPool pool;
+    {
+        benchmark::Timer t("50k requests, DocumentPool");
+        for (int i = 0; i < requests; i++) {
+            auto document = pool.acquire();
+            document->Parse(body.c_str());
+            const rapidjson::Value &items = (*document)["items"];
+            for (auto item = items.Begin(); item != items.End(); ++item) {
+                pooled_quantity += (*item)["quantity"].GetInt();
+            }
+        }
+    }
+    std::cout << "[benchmark] DocumentPool arenas: " << pool.arenas_created() << std::endl;
+    EXPECT_EQ(quantity, pooled_quantity);
+}
+
+// Typed bindings
+// The toa tests in json.cpp read a tao::json::value by key: every lookup is a std::map search in a tree of heap
+// allocated values. With a compile-time field table the parser's events land in the struct members directly.
+
+namespace {
+struct Endpoint {
+    std::string host;
+    int port = 0;
+    bool tls = false;
+};
+
+struct Window {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+struct Config {
+    std::string name;
+    int version = 0;
+    Window window;
+    double scale = 1;
+    uint32_t retries = 3;
+    std::vector<Endpoint> endpoints;
+    std::vector<std::string> features;
+};
+
+struct Sensor {
+    std::vector<bool> alarms;
+    int threshold = 5;
+};
+
+bool operator==(const Endpoint &a, const Endpoint &b) {
+    return a.host == b.host && a.port == b.port && a.tls == b.tls;
+}
+}
+
+namespace json {
+template<>
+struct Binding<Endpoint> {
+    static constexpr auto fields() {
+        return std::make_tuple(field("host", &Endpoint::host), field("port", &Endpoint::port),
+                               field("tls", &Endpoint::tls));
+    }
+};
+
+template<>
+struct Binding<Window> {
+    static constexpr auto fields() {
+        return std::make_tuple(field("x", &Window::x), field("y", &Window::y), field("width", &Window::width),
+                               field("height", &Window::height));
+    }
+};
+
+template<>
+struct Binding<Sensor> {
+    static constexpr auto fields() {
+        return std::make_tuple(field("alarms", &Sensor::alarms), nullable_field("threshold", &Sensor::threshold));
+    }
+};
+
+template<>
+struct Binding<Config> {
+    static constexpr auto fields() {
+        return std::make_tuple(field("name", &Config::name), field("version", &Config::version),
+                               field("window", &Config::window), field("scale", &Config::scale),
+                               field("retries", &Config::retries), field("endpoints", &Config::endpoints),
+                               field("features", &Config::features));
+    }
+};
+}// namespace json
+
+namespace {
+std::string config_json(int endpoints) {
+    std::string json = "{\"name\": \"dashboard\", \"version\": 7, \"scale\": 1.25, "
+                       "\"window\": {\"x\": 10, \"y\": -20, \"width\": 1280, \"height\": 720}, "
+                       "\"features\": [\"tracing\", \"metrics\"], \"endpoints\": [";
+    for (int i = 0; i < endpoints; i++) {
+        json += (i ? "," : "") + std::string("{\"host\": \"node-") + std::to_string(i) + ".local\", \"port\": " +
+                std::to_string(8000 + i) + ", \"tls\": " + (i % 2 ? "true" : "false") + "}";
+    }
+    return json + "]}";
+}
+}
+
+TEST(binding, parse_into_struct) {
+    auto config = json::parse<Config>(config_json(3));
+    EXPECT_EQ("dashboard", config.name);
+    EXPECT_EQ(7, config.version);
+    EXPECT_EQ(1.25, config.scale);
+    EXPECT_EQ(10, config.window.x);
+    EXPECT_EQ(-20, config.window.y);
+    EXPECT_EQ(1280, config.window.width);
+    EXPECT_EQ(720, config.window.height);
+    EXPECT_EQ(3u, config.retries); // missing: keeps the default
+    EXPECT_EQ((std::vector<std::string>{"tracing", "metrics"}), config.features);
+    ASSERT_EQ(3u, config.endpoints.size());
+    EXPECT_EQ((Endpoint{"node-2.local", 8002, false}), config.endpoints[2]);
+    EXPECT_TRUE(config.endpoints[1].tls);
+}
+
+TEST(binding, unknown_keys_are_skipped) {
+    auto endpoint = json::parse<Endpoint>(
+            "{\"comment\": {\"a\": [1, {\"b\": null}], \"host\": \"nested\"}, \"host\": \"db\", "
+            "\"extra\": [[true], 2.5, \"x\"]}");
+    EXPECT_EQ("db", endpoint.host);
+    EXPECT_EQ(0, endpoint.port);
+}
+
+TEST(binding, round_trip) {
+    auto config = json::parse<Config>(config_json(2));
+    config.retries = 5;
+    config.scale = 0.1;
+    auto text = json::serialize(config);
+    auto again = json::parse<Config>(text);
+    EXPECT_EQ(text, json::serialize(again));
+    EXPECT_EQ(5u, again.retries);
+    EXPECT_EQ(0.1, again.scale);
+    EXPECT_EQ(config.endpoints, again.endpoints);
+    EXPECT_EQ("{\"host\":\"a\\\"b\",\"port\":1,\"tls\":true}", json::serialize(Endpoint{"a\"b", 1, true}));
+}
+
+TEST(binding, type_errors) {
+    EXPECT_THROW(json::parse<Endpoint>("{\"port\": \"8080\"}"), json::BindError);
+    EXPECT_THROW(json::parse<Endpoint>("{\"host\": 1}"), json::BindError);
+    EXPECT_THROW(json::parse<Endpoint>("[]"), json::BindError);
+    EXPECT_THROW(json::parse<Endpoint>("{\"port\": 3000000000}"), json::BindError);
+    EXPECT_THROW(json::parse<Config>("{\"retries\": -1}"), json::BindError);
+    EXPECT_THROW(json::parse<Config>("{\"features\": [1]}"), json::BindError);
+    try {
+        json::parse<Endpoint>("{\"tls\": 1}");
+        FAIL();
+    } catch (const json::BindError &e) {
+        EXPECT_STREQ("expected a boolean, got an integer", e.what());
+    }
+}
+
+TEST(binding, null_and_vector_of_bool) {
+    try {
+        json::parse<Endpoint>("{\"port\": null}");
+        FAIL();
+    } catch (const json::BindError &e) {
+        EXPECT_STREQ("expected an integer, got null", e.what());
+    }
+
+    auto sensor = json::parse<Sensor>("{\"threshold\": null, \"alarms\": [true, false, true]}");
+    EXPECT_EQ(5, sensor.threshold); // nullable: keeps the default
+    EXPECT_EQ((std::vector<bool>{true, false, true}), sensor.alarms);
+    EXPECT_EQ("{\"alarms\":[true,false,true],\"threshold\":5}", json::serialize(sensor));
+    EXPECT_THROW(json::parse<Sensor>("{\"alarms\": [1]}"), json::BindError);
+    EXPECT_THROW(json::parse<Sensor>("{\"alarms\": null}"), json::BindError);
+}
+
+// 100k configs: parse and read every field, then build and serialize
+TEST(json_benchmark, DISABLED_binding_vs_value) {
+    const int configs = 100000;
+    auto text = config_json(8);
+
+    int64_t dom_sum = 0;
+    {
+        benchmark::Timer t("100k configs, tao::json::value lookups");
+        for (int i = 0; i < configs; i++) {
+            const tao::json::value v = tao::json::from_string(text);
+            dom_sum += v.at("version").as<int>() + v.at("window").at("width").as<int>() +
+                       int64_t(v.at("scale").as<double>()) + v.at("name").as<std::string>().size();
+            for (auto &endpoint : v.at("endpoints").get_array()) {
+                dom_sum += endpoint.at("port").as<int>() + endpoint.at("tls").as<bool>() +
+                           endpoint.at("host").as<std::string>().size();
+            }
+        }
+    }
+    int64_t bound_sum = 0;
+    {
+        benchmark::Timer t("100k configs, json::parse<Config>");
+        for (int i = 0; i < configs; i++) {
+            auto config = json::parse<Config>(text);
+            bound_sum += config.version + config.window.width + int64_t(config.scale) + config.name.size();
+            for (auto &endpoint : config.endpoints) {
+                bound_sum += endpoint.port + endpoint.tls + endpoint.host.size();
+            }
+        }
+    }
+    EXPECT_EQ(dom_sum, bound_sum);
+
+    auto config = json::parse<Config>(text);
+    std::size_t dom_size = 0;
+    {
+        benchmark::Timer t("100k configs, build tao::json::value and to_string");
+        for (int i = 0; i < configs; i++) {
+            tao::json::value endpoints = tao::json::empty_array;
+            for (auto &endpoint : config.endpoints) {
+                endpoints.emplace_back(tao::json::value{
+                        {"host", endpoint.host}, {"port", endpoint.port}, {"tls", endpoint.tls}});
+            }
+            tao::json::value features = tao::json::empty_array;
+            for (auto &feature : config.features) {
+                features.emplace_back(feature);
+            }
+            const tao::json::value v = {
+                    {"name", config.name},
+                    {"version", config.version},
+                    {"window", {{"x", config.window.x}, {"y", config.window.y},
+                                {"width", config.window.width}, {"height", config.window.height}}},
+                    {"scale", config.scale},
+                    {"retries", config.retries},
+                    {"endpoints", endpoints},
+                    {"features", features}};
+            dom_size += tao::json::to_string(v).size();
+        }
+    }
+    std::size_t bound_size = 0;
+    {
+        benchmark::Timer t("100k configs, json::serialize");
+        for (int i = 0; i < configs; i++) {
+            bound_size += json::serialize(config).size();
+        }
+    }
+    // same members, the value's object is a std::map so only the key order differs
+    EXPECT_EQ(dom_size, bound_size);
+}
+
+// Binary encodings
+// Same documents as text, CBOR, MessagePack and UBJSON: doubles are copied as 8 bytes instead of formatted and
+// re-parsed as decimals.
+
+namespace {
+// the v5 document of json.cpp, with measurements
+tao::json::value v5_document(std::mt19937 &random) {
+    std::uniform_real_distribution<double> distribution(-1000, 1000);
+    tao::json::value samples = tao::json::empty_array;
+    for (int i = 0; i < 16; i++) {
+        samples.emplace_back(distribution(random));
+    }
+    return {{"hello", "world"},
+            {"t", true},
+            {"f", false},
+            {"n", tao::json::null},
+            {"i", 123},
+            {"pi", 3.1426},
+            {"a", tao::json::value::array({1, 2, 3, 4})},
+            {"b", {{"x", distribution(random)}, {"y", "test"}}},
+            {"samples", samples}};
+}
+
+const json::Encoding encodings[] = {json::Encoding::text, json::Encoding::cbor, json::Encoding::msgpack,
+                              json::Encoding::ubjson};
+}
+
+TEST(encoding, content_types) {
+    EXPECT_EQ(json::Encoding::cbor, json::encoding_for("application/cbor"));
+    EXPECT_EQ(json::Encoding::text, json::encoding_for("application/json; charset=utf-8"));
+    EXPECT_EQ(json::Encoding::msgpack, json::encoding_for("application/x-msgpack"));
+    EXPECT_THROW(json::encoding_for("text/html"), std::invalid_argument);
+    for (auto encoding : encodings) {
+        EXPECT_EQ(encoding, json::encoding_for(json::content_type(encoding)));
+    }
+}
+
+TEST(encoding, value_round_trip) {
+    std::mt19937 random(7);
+    auto document = v5_document(random);
+    for (auto encoding : encodings) {
+        auto data = json::encode(document, encoding);
+        EXPECT_EQ(document, json::decode(data, encoding)) << json::content_type(encoding);
+    }
+    EXPECT_EQ(tao::json::to_string(document), json::encode(document, json::Encoding::text));
+}
+
+TEST(encoding, structs_without_a_value) {
+    auto config = json::parse<Config>(config_json(4));
+    auto expected = json::serialize(config);
+    for (auto encoding : encodings) {
+        json::Serializer endpoint(encoding);
+        auto decoded = endpoint.decode<Config>(endpoint.encode(config));
+        EXPECT_EQ(expected, json::serialize(decoded)) << endpoint.content_type();
+    }
+    // {"host": "a", "port": 1, "tls": true} in CBOR: a map of 3, text strings, unsigned 1, true
+    EXPECT_EQ(std::string("\xa3\x64host\x61\x61\x64port\x01\x63tls\xf5", 19),
+              json::encode(Endpoint{"a", 1, true}, json::Encoding::cbor));
+}
+
+TEST(encoding, transcode) {
+    auto text = json::serialize(json::parse<Config>(config_json(4)));
+    auto cbor = json::transcode(text, json::Encoding::text, json::Encoding::cbor);
+    auto msgpack = json::transcode(cbor, json::Encoding::cbor, json::Encoding::msgpack);
+    auto ubjson = json::transcode(msgpack, json::Encoding::msgpack, json::Encoding::ubjson);
+    // MessagePack went through a value, whose members are ordered by key
+    EXPECT_EQ(text, json::serialize(json::decode<Config>(ubjson, json::Encoding::ubjson)));
+    EXPECT_EQ(json::decode(text, json::Encoding::text), json::decode(msgpack, json::Encoding::msgpack));
+    EXPECT_EQ(text, json::transcode(cbor, json::Encoding::cbor, json::Encoding::text));
+}
+
+// 100k v5 documents with 17 doubles each: bytes, encode from a value, decode to a value
+TEST(json_benchmark, DISABLED_text_vs_binary_encodings) {
+    const int documents = 100000;
+    std::mt19937 random(42);
+    std::vector<tao::json::value> values;
+    for (int i = 0; i < 1000; i++) {
+        values.push_back(v5_document(random));
+    }
+    for (auto encoding : encodings) {
+        std::vector<std::string> encoded(values.size());
+        std::size_t bytes = 0;
+        {
+            benchmark::Timer t(std::string("100k documents, encode ") + json::content_type(encoding));
+            for (int i = 0; i < documents; i++) {
+                auto &data = encoded[i % values.size()];
+                data = json::encode(values[i % values.size()], encoding);
+                bytes += data.size();
+            }
+        }
+        std::size_t members = 0;
+        {
+            benchmark::Timer t(std::string("100k documents, decode ") + json::content_type(encoding));
+            for (int i = 0; i < documents; i++) {
+                members += json::decode(encoded[i % encoded.size()], encoding).get_object().size();
+            }
+        }
+        std::cout << "[benchmark] " << json::content_type(encoding) << ": " << bytes / documents
+                  << " bytes per document" << std::endl;
+        EXPECT_EQ(documents * 9u, members);
+    }
+}
+
+// Structural index
+// simdjson's stage 1: 64 bytes at a time into bit masks, string boundaries by a prefix xor of the quotes.
+
+namespace {
+std::vector<json::Kernel> supported_kernels() {
+    std::vector<json::Kernel> kernels;
+    for (auto kernel : {json::Kernel::scalar, json::Kernel::sse2, json::Kernel::avx2}) {
+        if (json::kernel_supported(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+// byte at a time: ops outside strings, opening quotes, first byte of every other scalar
+std::vector<uint32_t> reference_positions(const std::string &text) {
+    std::vector<uint32_t> positions;
+    bool in_string = false;
+    bool escaped = false;
+    bool previous_unquoted = false;
+    for (uint32_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        bool op = std::strchr("{}[]:,", c) && c;
+        bool whitespace = c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        if (in_string) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                in_string = false;
+            }
+        } else if (c == '"') {
+            in_string = true;
+            positions.push_back(i);
+        } else if (op || (!whitespace && !previous_unquoted)) {
+            positions.push_back(i);
+        }
+        previous_unquoted = !op && !whitespace && c != '"';
+    }
+    return positions;
+}
+
+// random documents with escapes, multi-byte characters and backslash runs to cross the 64 byte blocks
+void random_json(std::mt19937 &random, std::string &out, int depth) {
+    auto pick = [&](int n) { return static_cast<int>(random() % n); };
+    auto space = [&]() { out.append(pick(3), " \n\t"[pick(3)]); };
+    auto string = [&]() {
+        out += '"';
+        for (int i = pick(40); i > 0; i--) {
+            switch (pick(8)) {
+                case 0: out.append(pick(2) ? "\\\"" : "\\\\"); break;
+                case 1: out.append(std::string(2 * pick(4), '\\')); break;
+                case 2: out.append(pick(2) ? "\xc3\xa9" : "\xe2\x82\xac"); break;
+                case 3: out.append("{[:,]} "); break;
+                default: out += static_cast<char>('a' + pick(26));
+            }
+        }
+        out += '"';
+    };
+    space();
+    switch (depth > 4 ? 2 + pick(3) : pick(5)) {
+        case 0:
+            out += '{';
+            for (int i = pick(6); i >= 0; i--) {
+                space(), string(), space(), out += ':', random_json(random, out, depth + 1);
+                out += i ? "," : "";
+            }
+            out += '}';
+            break;
+        case 1:
+            out += '[';
+            for (int i = pick(6); i >= 0; i--) {
+                random_json(random, out, depth + 1);
+                out += i ? "," : "";
+            }
+            out += ']';
+            break;
+        case 2:
+            string();
+            break;
+        case 3:
+            out += std::to_string(static_cast<int>(random())) + (pick(2) ? ".5e-3" : "");
+            break;
+        default:
+            out += pick(2) ? "true" : "null";
+    }
+    space();
+}
+
+std::string structural_chars(const json::StructuralIndex &index) {
+    std::string chars;
+    for (std::size_t i = 0; i < index.size(); i++) {
+        chars += index.at(i);
+    }
+    return chars;
+}
+}
+
+TEST(structural_index, positions) {
+    std::string text = R"({"a": [1, "x\"y", true], "b\\": {}, "c": -2.5e3 })";
+    for (auto kernel : supported_kernels()) {
+        json::StructuralIndex index(kernel);
+        index.build(text);
+        EXPECT_EQ("{\":[1,\",t],\":{},\":-}", structural_chars(index));
+        EXPECT_EQ("\"x\\\"y\"", index.scalar(6).to_string());
+        EXPECT_EQ("-2.5e3", index.scalar(index.size() - 2).to_string());
+        EXPECT_EQ(10u, index.skip(3)); // over [1, "x\"y", true]
+        EXPECT_EQ(15u, index.skip(13)); // over {}
+    }
+}
+
+TEST(structural_index, same_as_byte_at_a_time) {
+    std::mt19937 random(3);
+    auto kernels = supported_kernels();
+    std::vector<json::StructuralIndex> indexes(kernels.begin(), kernels.end());
+    for (int i = 0; i < 500; i++) {
+        std::string text;
+        random_json(random, text, 0);
+        auto expected = reference_positions(text);
+        for (auto &index : indexes) {
+            index.build(text);
+            ASSERT_EQ(expected.size(), index.size()) << text;
+            for (std::size_t j = 0; j < expected.size(); j++) {
+                ASSERT_EQ(expected[j], index[j]) << text;
+            }
+            ASSERT_EQ(index.size(), index.skip(0)) << text;
+        }
+    }
+}
+
+TEST(structural_index, errors) {
+    for (auto kernel : supported_kernels()) {
+        json::StructuralIndex index(kernel);
+        EXPECT_THROW(index.build(std::string(100, ' ') + "{\"open: 1}"), json::IndexError);
+        EXPECT_THROW(index.build("[\"tab\tin string\"]"), json::IndexError);
+        EXPECT_THROW(index.build("[\"\xc0\x80\"]"), json::IndexError);         // overlong
+        EXPECT_THROW(index.build("[\"\xed\xa0\x80\"]"), json::IndexError);     // surrogate
+        EXPECT_THROW(index.build("[\"\xf4\x90\x80\x80\"]"), json::IndexError); // above U+10FFFF
+        // a 3 byte character across the first block boundary
+        auto across = "[\"" + std::string(61, 'x') + "\xe2\x82\xac\"]";
+        index.build(across);
+        EXPECT_EQ("[\"]", structural_chars(index));
+        try {
+            index.build("[\"" + std::string(80, 'x') + "\xe2\x82\"]");
+            FAIL();
+        } catch (const json::IndexError &e) {
+            EXPECT_EQ(82u, e.offset());
+        }
+    }
+}
+
+TEST(structural_index, utf8) {
+    for (auto kernel : supported_kernels()) {
+        EXPECT_TRUE(json::is_valid_utf8(std::string(100, 'a') + "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80", kernel));
+        EXPECT_FALSE(json::is_valid_utf8(std::string(100, 'a') + "\xc3", kernel));
+        EXPECT_FALSE(json::is_valid_utf8("\x80", kernel));
+        EXPECT_FALSE(json::is_valid_utf8("\xe0\x9f\xbf", kernel)); // overlong
+        EXPECT_FALSE(json::is_valid_utf8("\xff", kernel));
+    }
+}
+
+// 64MB of records: structural index and UTF-8 check against a rapidjson DOM parse that validates the encoding
+TEST(json_benchmark, DISABLED_structural_index_vs_rapidjson) {
+    std::string text = "[";
+    std::mt19937 random(11);
+    while (text.size() < 64 * 1024 * 1024) {
+        text += request_json(20) + ",";
+        text += "{\"note\": \"caf\xc3\xa9 \\\"\xe2\x82\xac\\\" \", \"value\": " + std::to_string(random()) + "},";
+    }
+    text.back() = ']';
+
+    std::size_t structurals = 0;
+    json::StructuralIndex index;
+    {
+        benchmark::Timer t("64MB, json::StructuralIndex::build");
+        index.build(text);
+        structurals = index.size();
+    }
+    bool valid;
+    {
+        benchmark::Timer t("64MB, json::is_valid_utf8");
+        valid = json::is_valid_utf8(text);
+    }
+    {
+        benchmark::Timer t("64MB, rapidjson::Document::Parse<kParseValidateEncodingFlag>");
+        rapidjson::Document document;
+        document.Parse<rapidjson::kParseValidateEncodingFlag>(text.c_str(), text.size());
+        EXPECT_FALSE(document.HasParseError());
+    }
+    EXPECT_TRUE(valid);
+    EXPECT_GT(structurals, text.size() / 16);
+}
+
+// Lazy path extraction
+// Only the values on the way to the requested pointers are looked at, everything else is skipped by brackets.
+
+namespace {
+const char v1_json[] = " { \"hello\" : \"world\", \"t\" : true , \"f\" : false, \"n\": null, \"i\":123, \"pi\": 3.1416, "
+                       "\"a\":[1, 2, 3, 4], \"b\": {\"x\": [{\"y\": \"caf\\u00e9 \\ud83d\\ude00\"}], \"a/b\": 5} } ";
+
+// the same matches from the text and from a structural index
+std::vector<json::Match> both_ways(const json::PathQuery &query, boost::string_view text) {
+    auto matches = query.run(text);
+    json::StructuralIndex index;
+    index.build(text);
+    std::vector<json::Match> indexed;
+    query.run(index, indexed);
+    EXPECT_EQ(matches.size(), indexed.size());
+    for (std::size_t i = 0; i < matches.size(); i++) {
+        EXPECT_EQ(matches[i].raw(), indexed[i].raw()) << i;
+    }
+    return matches;
+}
+}
+
+TEST(json_path, pointers_in_one_pass) {
+    json::PathQuery query{"/a/0", "/hello", "/pi", "/n", "/missing", "/a/9", "/t", "/b/x/0/y", "/b/a~1b", "/b/x"};
+    auto m = both_ways(query, v1_json);
+    ASSERT_EQ(10u, m.size());
+    EXPECT_EQ(1, m[0].as<int>());
+    EXPECT_EQ("world", m[1].as<std::string>());
+    EXPECT_EQ("\"world\"", m[1].raw());
+    EXPECT_EQ(3.1416, m[2].as<double>());
+    EXPECT_TRUE(m[3].is_null());
+    EXPECT_FALSE(m[4].found());
+    EXPECT_FALSE(m[5].found());
+    EXPECT_TRUE(m[6].as<bool>());
+    EXPECT_EQ("caf\xc3\xa9 \xf0\x9f\x98\x80", m[7].as<std::string>());
+    EXPECT_EQ(5, m[8].as<int64_t>());
+    EXPECT_EQ("[{\"y\": \"caf\\u00e9 \\ud83d\\ude00\"}]", m[9].raw());
+    EXPECT_THROW(m[4].as<int>(), json::PathError);
+    EXPECT_THROW(m[1].as<int>(), strings::BadCast);
+    EXPECT_THROW(m[0].as<std::string>(), json::PathError);
+}
+
+TEST(json_path, whole_document_and_escaped_keys) {
+    json::PathQuery query{"", "/a\"b", "/~0"};
+    auto m = both_ways(query, "[1] ");
+    EXPECT_EQ("[1]", m[0].raw());
+    EXPECT_FALSE(m[1].found());
+    m = both_ways(query, R"({"a\"b": "q\\", "~": [true]})");
+    EXPECT_EQ("\"q\\\\\"", m[1].raw());
+    EXPECT_EQ("q\\", m[1].as<std::string>());
+    EXPECT_EQ("[true]", m[2].raw());
+    EXPECT_THROW(query.add("no/slash"), json::PathError);
+    EXPECT_THROW(query.add("/~2"), json::PathError);
+}
+
+TEST(json_path, stops_when_everything_is_found) {
+    json::PathQuery query{"/route", "/id"};
+    auto m = query.run(R"({"route": "eu-west", "id": 7, "payload": [1, 2, {"not json)");
+    EXPECT_EQ("eu-west", m[0].as<std::string>());
+    EXPECT_EQ(7, m[1].as<int>());
+    EXPECT_THROW(query.run(R"({"route": "eu-west", "payload": [1, 2, {"not json)"), json::IndexError);
+    EXPECT_THROW(query.run(R"({"route" "eu-west"})"), json::IndexError);
+    EXPECT_THROW(query.run(""), json::IndexError);
+}
+
+// 100k requests of 200 items, route on two fields
+TEST(json_benchmark, DISABLED_path_query_vs_dom) {
+    const int requests = 100000;
+    auto body = request_json(200);
+
+    std::size_t dom = 0;
+    {
+        benchmark::Timer t("100k requests, tao::json::value at()");
+        for (int i = 0; i < requests; i++) {
+            const tao::json::value v = tao::json::from_string(body);
+            dom += v.at("user").get_string().size() + v.at("items").at(3).at("quantity").as<int>();
+        }
+    }
+    std::size_t rapid = 0;
+    {
+        benchmark::Timer t("100k requests, rapidjson::Document");
+        rapidjson::Document document;
+        for (int i = 0; i < requests; i++) {
+            document.Parse(body.c_str(), body.size());
+            rapid += document["user"].GetStringLength() + document["items"][3]["quantity"].GetInt();
+        }
+    }
+    std::size_t lazy = 0;
+    json::PathQuery query{"/user", "/items/3/quantity"};
+    std::vector<json::Match> matches;
+    {
+        benchmark::Timer t("100k requests, json::PathQuery");
+        for (int i = 0; i < requests; i++) {
+            query.run(body, matches);
+            lazy += matches[0].unquoted().size() + matches[1].as<int>();
+        }
+    }
+    // routing field at the end: the whole text is walked, but nothing in it is decoded
+    std::size_t last = 0;
+    json::PathQuery last_item{"/items/199/sku"};
+    {
+        benchmark::Timer t("100k requests, json::PathQuery on the last item");
+        for (int i = 0; i < requests; i++) {
+            last_item.run(body, matches);
+            last += matches[0].unquoted().size();
+        }
+    }
+    EXPECT_EQ(dom, lazy);
+    EXPECT_EQ(rapid, lazy);
+    EXPECT_EQ(requests * 7u, last);
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Connection.h"
+#include "Rcu.h"
+
+namespace signals {
+
+template<typename Signature>
+class ConcurrentSignal;
+
+// Thread safe signal for signals that are emitted from many threads at the same time.
+// boost::signals2 takes the signal's mutex on every emission, so concurrent emitters serialize on it.
+// Here the slot list is an immutable snapshot behind an atomic pointer (read-copy-update):
+// -> emission: enter an rcu read section, load the snapshot, call the slots. No lock, no reference count, wait-free.
+// -> connect/disconnect: copy the snapshot, modify the copy, publish it with one atomic exchange. The old snapshot is
+//    retired and freed once no emission can still be using it.
+// A slot that is disconnected while another thread is emitting may still be called once by that emission, the same
+// guarantee signals2 gives.
+template<typename... Args>
+class ConcurrentSignal<void(Args...)> {
+public:
+    using slot_type = std::function<void(Args...)>;
+
+    ConcurrentSignal() : slots_(std::make_shared<Slots>()) {}
+
+    ConcurrentSignal(const ConcurrentSignal &) = delete;
+    ConcurrentSignal &operator=(const ConcurrentSignal &) = delete;
+
+    Connection connect(slot_type slot) {
+        return slots_->add(false, 0, std::move(slot));
+    }
+
+    Connection connect(int group, slot_type slot) {
+        return slots_->add(true, group, std::move(slot));
+    }
+
+    void disconnect_all_slots() { slots_->clear(); }
+
+    std::size_t num_slots() const { return slots_->size(); }
+
+    bool empty() const { return num_slots() == 0; }
+
+    void operator()(Args... args) const { slots_->emit(args...); }
+
+private:
+    struct Slot {
+        bool grouped;
+        int group;
+        uint64_t id;
+        std::atomic<bool> connected;
+        slot_type function;
+
+        Slot(bool grouped, int group, uint64_t id, slot_type function)
+                : grouped(grouped), group(group), id(id), connected(true), function(std::move(function)) {}
+    };
+
+    using Snapshot = std::vector<std::shared_ptr<Slot>>;
+
+    class Slots : public SlotList, public std::enable_shared_from_this<Slots> {
+    public:
+        Slots() : current_(new Snapshot()) {}
+
+        ~Slots() override {
+            // emissions on other threads that started just before the signal was destroyed might still be running.
+            // like any signal, it must not be destroyed from inside one of its own slots.
+            rcu::synchronize();
+            delete current_.load();
+            for (auto &&retired : retired_) {
+                delete retired.snapshot;
+            }
+        }
+
+        Connection add(bool grouped, int group, slot_type function) {
+            std::lock_guard<std::mutex> lock(writer_);
+            auto slot = std::make_shared<Slot>(grouped, group, ++last_id_, std::move(function));
+            auto next = new Snapshot(*current_.load());
+            auto position = next->end();
+            if (grouped) {
+                position = std::find_if(next->begin(), next->end(), [group](const std::shared_ptr<Slot> &s) {
+                    return !s->grouped || s->group > group;
+                });
+            }
+            next->insert(position, slot);
+            publish(next);
+            return Connection(this->shared_from_this(), slot->id);
+        }
+
+        void disconnect(uint64_t id) override {
+            std::lock_guard<std::mutex> lock(writer_);
+            auto next = new Snapshot(*current_.load());
+            auto it = std::find_if(next->begin(), next->end(), [id](const std::shared_ptr<Slot> &s) {
+                return s->id == id;
+            });
+            if (it == next->end()) {
+                delete next;
+                return;
+            }
+            (*it)->connected = false; // running emissions skip it from now on
+            next->erase(it);
+            publish(next);
+        }
+
+        bool connected(uint64_t id) const override {
+            rcu::ReadGuard guard;
+            auto snapshot = current_.load();
+            return std::any_of(snapshot->begin(), snapshot->end(), [id](const std::shared_ptr<Slot> &s) {
+                return s->id == id;
+            });
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(writer_);
+            for (auto &&slot : *current_.load()) {
+                slot->connected = false;
+            }
+            publish(new Snapshot());
+        }
+
+        std::size_t size() const {
+            rcu::ReadGuard guard;
+            return current_.load()->size();
+        }
+
+        void emit(Args &... args) const {
+            rcu::ReadGuard guard;
+            auto snapshot = current_.load();
+            for (auto &&slot : *snapshot) {
+                if (slot->connected.load(std::memory_order_relaxed)) {
+                    slot->function(args...);
+                }
+            }
+        }
+
+    private:
+        struct Retired {
+            Snapshot *snapshot;
+            uint64_t epoch;
+        };
+
+        // called with writer_ locked
+        void publish(Snapshot *next) {
+            auto previous = current_.exchange(next);
+            retired_.push_back({previous, rcu::advance()});
+            // free what no reader can see anymore, never blocks: a writer may be called from inside a slot
+            retired_.erase(std::remove_if(retired_.begin(), retired_.end(), [](const Retired &r) {
+                if (rcu::quiescent_since(r.epoch)) {
+                    delete r.snapshot;
+                    return true;
+                }
+                return false;
+            }), retired_.end());
+        }
+
+        std::atomic<Snapshot *> current_;
+        std::mutex writer_;
+        std::vector<Retired> retired_;
+        uint64_t last_id_ = 0;
+    };
+
+    std::shared_ptr<Slots> slots_;
+};
+
+}// namespace signals
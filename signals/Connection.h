@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+namespace signals {
+
+// the part of a signal a connection talks to, implemented by every signal type in this directory
+class SlotList {
+public:
+    virtual ~SlotList() = default;
+
+    virtual void disconnect(uint64_t id) = 0;
+
+    virtual bool connected(uint64_t id) const = 0;
+};
+
+// Handle to one connected slot, same role as boost::signals2::connection.
+// Holds a weak reference to the slot list, so it can outlive the signal.
+class Connection {
+public:
+    Connection() = default;
+
+    Connection(std::weak_ptr<SlotList> slots, uint64_t id) : slots_(std::move(slots)), id_(id) {}
+
+    void disconnect() const {
+        if (auto slots = slots_.lock()) {
+            slots->disconnect(id_);
+        }
+    }
+
+    bool connected() const {
+        auto slots = slots_.lock();
+        return slots && slots->connected(id_);
+    }
+
+private:
+    std::weak_ptr<SlotList> slots_;
+    uint64_t id_ = 0;
+};
+
+// disconnects when it goes out of scope, same role as boost::signals2::scoped_connection
+class ScopedConnection {
+public:
+    ScopedConnection() = default;
+
+    ScopedConnection(const Connection &connection) : connection_(connection) {}
+
+    ~ScopedConnection() { connection_.disconnect(); }
+
+    ScopedConnection(const ScopedConnection &) = delete;
+    ScopedConnection &operator=(const ScopedConnection &) = delete;
+
+    ScopedConnection(ScopedConnection &&other) noexcept : connection_(other.release()) {}
+
+    ScopedConnection &operator=(ScopedConnection &&other) noexcept {
+        if (this != &other) {
+            connection_.disconnect();
+            connection_ = other.release();
+        }
+        return *this;
+    }
+
+    ScopedConnection &operator=(const Connection &connection) {
+        connection_.disconnect();
+        connection_ = connection;
+        return *this;
+    }
+
+    // stops managing the connection without disconnecting it
+    Connection release() {
+        Connection connection = connection_;
+        connection_ = Connection();
+        return connection;
+    }
+
+    void disconnect() const { connection_.disconnect(); }
+
+    bool connected() const { return connection_.connected(); }
+
+private:
+    Connection connection_;
+};
+
+}// namespace signals
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Connection.h"
+
+namespace signals {
+
+template<typename Signature>
+class FastSignal;
+
+// Single threaded replacement for boost::signals2::signal<void(Args...)>.
+// signals2 locks a mutex, takes a copy of the slot list and allocates connection bodies on every emission, to be
+// safe against other threads. For a signal that is only used from one thread (one event loop) none of that is needed:
+// -> no locking
+// -> slots are stored by value in one contiguous vector, emission is a loop over it
+// -> slots that are connected or disconnected while the signal is emitting are applied after the emission
+// Same ordering as signals2: slots connected with a group are called first, lowest group first, then the ungrouped
+// slots in connection order.
+template<typename... Args>
+class FastSignal<void(Args...)> {
+public:
+    using slot_type = std::function<void(Args...)>;
+
+    FastSignal() : slots_(std::make_shared<Slots>()) {}
+
+    FastSignal(const FastSignal &) = delete;
+    FastSignal &operator=(const FastSignal &) = delete;
+
+    Connection connect(slot_type slot) {
+        return slots_->add(Slot{false, 0, 0, true, std::move(slot)});
+    }
+
+    Connection connect(int group, slot_type slot) {
+        return slots_->add(Slot{true, group, 0, true, std::move(slot)});
+    }
+
+    void disconnect_all_slots() { slots_->clear(); }
+
+    std::size_t num_slots() const { return slots_->size(); }
+
+    bool empty() const { return num_slots() == 0; }
+
+    // arguments are passed on as lvalues to every slot, like signals2 does
+    void operator()(Args... args) const { slots_->emit(args...); }
+
+private:
+    struct Slot {
+        bool grouped;
+        int group;
+        uint64_t id;
+        bool connected;
+        slot_type function;
+    };
+
+    class Slots : public SlotList, public std::enable_shared_from_this<Slots> {
+    public:
+        Connection add(Slot slot) {
+            slot.id = ++last_id_;
+            if (emitting_) {
+                pending_.push_back(std::move(slot));
+            } else {
+                insert(std::move(slot));
+            }
+            return Connection(this->shared_from_this(), last_id_);
+        }
+
+        void disconnect(uint64_t id) override {
+            for (auto &&slot : slots_) {
+                if (slot.id == id && slot.connected) {
+                    slot.connected = false;
+                    dirty_ = true;
+                    break;
+                }
+            }
+            pending_.erase(std::remove_if(pending_.begin(), pending_.end(), [id](const Slot &s) {
+                return s.id == id;
+            }), pending_.end());
+            if (!emitting_) {
+                compact();
+            }
+        }
+
+        bool connected(uint64_t id) const override {
+            auto is_connected = [id](const Slot &s) { return s.id == id && s.connected; };
+            return std::any_of(slots_.begin(), slots_.end(), is_connected) ||
+                   std::any_of(pending_.begin(), pending_.end(), is_connected);
+        }
+
+        void clear() {
+            for (auto &&slot : slots_) {
+                slot.connected = false;
+            }
+            pending_.clear();
+            dirty_ = true;
+            if (!emitting_) {
+                compact();
+            }
+        }
+
+        std::size_t size() const {
+            return std::count_if(slots_.begin(), slots_.end(), [](const Slot &s) { return s.connected; }) +
+                   pending_.size();
+        }
+
+        void emit(Args &... args) {
+            EmissionGuard guard(*this);
+            // index based: a slot may connect or disconnect slots (also itself) while we loop
+            const auto count = slots_.size();
+            for (std::size_t i = 0; i < count; i++) {
+                if (slots_[i].connected) {
+                    slots_[i].function(args...);
+                }
+            }
+        }
+
+    private:
+        // ends the emission also when a slot throws: otherwise the deferred changes would never be applied
+        class EmissionGuard {
+        public:
+            explicit EmissionGuard(Slots &slots) : slots_(slots) { slots_.emitting_++; }
+
+            ~EmissionGuard() {
+                if (--slots_.emitting_ == 0) {
+                    slots_.compact();
+                    for (auto &&slot : slots_.pending_) {
+                        slots_.insert(std::move(slot));
+                    }
+                    slots_.pending_.clear();
+                }
+            }
+
+            EmissionGuard(const EmissionGuard &) = delete;
+            EmissionGuard &operator=(const EmissionGuard &) = delete;
+
+        private:
+            Slots &slots_;
+        };
+
+        void insert(Slot slot) {
+            auto position = slots_.end();
+            if (slot.grouped) {
+                // behind the last slot with the same or a lower group, ungrouped slots stay at the back
+                position = std::find_if(slots_.begin(), slots_.end(), [&slot](const Slot &s) {
+                    return !s.grouped || s.group > slot.group;
+                });
+            }
+            slots_.insert(position, std::move(slot));
+        }
+
+        void compact() {
+            if (dirty_) {
+                slots_.erase(std::remove_if(slots_.begin(), slots_.end(), [](const Slot &s) {
+                    return !s.connected;
+                }), slots_.end());
+                dirty_ = false;
+            }
+        }
+
+        std::vector<Slot> slots_;
+        std::vector<Slot> pending_;
+        uint64_t last_id_ = 0;
+        int emitting_ = 0;
+        bool dirty_ = false;
+    };
+
+    std::shared_ptr<Slots> slots_;
+};
+
+}// namespace signals
@@ -0,0 +1,38 @@
+#include "MessagePool.h"
+
+#include <new>
+
+namespace signals {
+
+MessagePool::~MessagePool() {
+    for (auto &&block : free_) {
+        ::operator delete(block);
+    }
+}
+
+void *MessagePool::allocate(std::size_t size) {
+    if (size > block_size_) {
+        return ::operator new(size);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty()) {
+            auto block = free_.back();
+            free_.pop_back();
+            return block;
+        }
+    }
+    heap_blocks_++;
+    return ::operator new(block_size_);
+}
+
+void MessagePool::deallocate(void *block, std::size_t size) {
+    if (size > block_size_) {
+        ::operator delete(block);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(block);
+}
+
+}// namespace signals
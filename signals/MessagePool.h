@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace signals {
+
+// Free list of fixed size blocks for queued signal messages.
+// A message is allocated on the emitting thread and freed on the receiving thread, which defeats asio's own
+// (thread local) handler memory recycling, so every message would be a malloc/free pair across threads.
+// Requests larger than the block size fall back to operator new.
+class MessagePool {
+public:
+    explicit MessagePool(std::size_t block_size = 256) : block_size_(block_size) {}
+    ~MessagePool();
+
+    MessagePool(const MessagePool &) = delete;
+    MessagePool &operator=(const MessagePool &) = delete;
+
+    void *allocate(std::size_t size);
+
+    void deallocate(void *block, std::size_t size);
+
+    // number of blocks that came from the heap, stays at the high water mark of messages in flight
+    std::size_t heap_blocks() const { return heap_blocks_; }
+
+private:
+    std::size_t block_size_;
+    std::mutex mutex_;
+    std::vector<void *> free_;
+    std::atomic<std::size_t> heap_blocks_{0};
+};
+
+// standard allocator on top of a MessagePool, used as the associated allocator of queued messages
+template<typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    explicit PoolAllocator(std::shared_ptr<MessagePool> pool) : pool_(std::move(pool)) {}
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U> &other) : pool_(other.pool()) {}
+
+    T *allocate(std::size_t n) { return static_cast<T *>(pool_->allocate(n * sizeof(T))); }
+
+    void deallocate(T *p, std::size_t n) { pool_->deallocate(p, n * sizeof(T)); }
+
+    const std::shared_ptr<MessagePool> &pool() const { return pool_; }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U> &other) const { return pool_ == other.pool(); }
+
+    template<typename U>
+    bool operator!=(const PoolAllocator<U> &other) const { return pool_ != other.pool(); }
+
+private:
+    std::shared_ptr<MessagePool> pool_;
+};
+
+}// namespace signals
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+#include "ConcurrentSignal.h"
+#include "Connection.h"
+#include "MessagePool.h"
+
+namespace signals {
+
+// counters of one queued connection, readable from any thread
+struct QueueCounters {
+    std::atomic<uint64_t> posted{0};
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> dropped{0};       // emissions refused because max_pending was reached
+    std::atomic<int64_t> pending{0};        // posted, but not yet delivered
+};
+
+// Connection of a QueuedSignal: disconnecting also discards messages that are still queued, and it exposes the
+// back-pressure counters of the connection.
+class QueuedConnection {
+public:
+    QueuedConnection() = default;
+
+    QueuedConnection(Connection connection, std::shared_ptr<std::atomic<bool>> connected,
+                     std::shared_ptr<const QueueCounters> counters, std::shared_ptr<const MessagePool> pool)
+            : connection_(std::move(connection)),
+              connected_(std::move(connected)),
+              counters_(std::move(counters)),
+              pool_(std::move(pool)) {}
+
+    void disconnect() const {
+        if (connected_) {
+            *connected_ = false;
+        }
+        connection_.disconnect();
+    }
+
+    bool connected() const { return connection_.connected(); }
+
+    // the counters of a default constructed connection are 0
+
+    uint64_t posted() const { return counters_ ? counters_->posted.load() : 0; }
+
+    uint64_t delivered() const { return counters_ ? counters_->delivered.load() : 0; }
+
+    uint64_t dropped() const { return counters_ ? counters_->dropped.load() : 0; }
+
+    int64_t pending() const { return counters_ ? counters_->pending.load() : 0; }
+
+    // heap blocks behind the message pool of this connection
+    std::size_t pooled_blocks() const { return pool_ ? pool_->heap_blocks() : 0; }
+
+private:
+    Connection connection_;
+    std::shared_ptr<std::atomic<bool>> connected_;
+    std::shared_ptr<const QueueCounters> counters_;
+    std::shared_ptr<const MessagePool> pool_;
+};
+
+template<typename Signature>
+class QueuedSignal;
+
+// Signal with queued connections, like Qt's QueuedConnection.
+// A slot is connected together with the executor it must run on (io_context, strand, thread_pool...). Emitting the
+// signal does not call the slot: it copies the arguments into a message and posts it to that executor, so a slow
+// subscriber no longer stalls the emitting thread (e.g. the timer thread in boost_lib.cpp).
+// -> messages are allocated from a per connection MessagePool, installed as the associated allocator of the handler
+// -> max_pending bounds the queue of a connection, emissions beyond it are dropped and counted
+// -> emission itself is the lock-free ConcurrentSignal, so it may happen from any thread
+// The execution context behind an executor (io_context, thread_pool) must outlive the connections to it.
+template<typename... Args>
+class QueuedSignal<void(Args...)> {
+public:
+    using slot_type = std::function<void(Args...)>;
+
+    static const int64_t unbounded = -1;
+
+    QueuedSignal() = default;
+
+    QueuedSignal(const QueuedSignal &) = delete;
+    QueuedSignal &operator=(const QueuedSignal &) = delete;
+
+    template<typename Executor>
+    QueuedConnection connect(const Executor &executor, slot_type slot, int64_t max_pending = unbounded) {
+        auto body = std::make_shared<Body<Executor>>(executor, std::move(slot), max_pending);
+        auto connection = signal_.connect([body](Args &... args) { body->post(args...); });
+        auto connected = std::shared_ptr<std::atomic<bool>>(body, &body->connected);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connected_.erase(std::remove_if(connected_.begin(), connected_.end(),
+                                            [](const std::weak_ptr<std::atomic<bool>> &c) { return c.expired(); }),
+                             connected_.end());
+            connected_.push_back(connected);
+        }
+        return QueuedConnection(connection, connected, std::shared_ptr<const QueueCounters>(body, &body->counters),
+                                body->pool);
+    }
+
+    // like disconnect() on every connection: messages that are still queued are discarded too
+    void disconnect_all_slots() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &&c : connected_) {
+                if (auto connected = c.lock()) {
+                    *connected = false;
+                }
+            }
+            connected_.clear();
+        }
+        signal_.disconnect_all_slots();
+    }
+
+    std::size_t num_slots() const { return signal_.num_slots(); }
+
+    bool empty() const { return signal_.empty(); }
+
+    void operator()(Args... args) const { signal_(args...); }
+
+private:
+    using Message = std::tuple<typename std::decay<Args>::type...>;
+
+    template<typename Executor>
+    struct Body : std::enable_shared_from_this<Body<Executor>> {
+        Executor executor;
+        slot_type slot;
+        int64_t max_pending;
+        std::shared_ptr<MessagePool> pool = std::make_shared<MessagePool>();
+        std::atomic<bool> connected{true};
+        QueueCounters counters;
+
+        Body(const Executor &executor, slot_type slot, int64_t max_pending)
+                : executor(executor), slot(std::move(slot)), max_pending(max_pending) {}
+
+        void post(Args &... args) {
+            // emitters may race for the last free place: it is taken with a compare-exchange
+            auto pending = counters.pending.load();
+            do {
+                if (max_pending != unbounded && pending >= max_pending) {
+                    counters.dropped++;
+                    return;
+                }
+            } while (!counters.pending.compare_exchange_weak(pending, pending + 1));
+            counters.posted++;
+            boost::asio::post(executor, Delivery<Executor>{this->shared_from_this(), Message(args...)});
+        }
+    };
+
+    // the handler that is queued on the target executor
+    template<typename Executor>
+    struct Delivery {
+        std::shared_ptr<Body<Executor>> body;
+        Message message;
+
+        using allocator_type = PoolAllocator<void>;
+
+        allocator_type get_allocator() const { return allocator_type(body->pool); }
+
+        void operator()() {
+            body->counters.pending--;
+            if (body->connected) {
+                call(std::index_sequence_for<Args...>());
+                body->counters.delivered++;
+            }
+        }
+
+        template<std::size_t... I>
+        void call(std::index_sequence<I...>) {
+            body->slot(std::get<I>(message)...);
+        }
+    };
+
+    ConcurrentSignal<void(Args &...)> signal_;
+    std::mutex mutex_;
+    std::vector<std::weak_ptr<std::atomic<bool>>> connected_; // of the bodies, for disconnect_all_slots
+};
+
+}// namespace signals
@@ -0,0 +1,127 @@
+#include "Rcu.h"
+
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+namespace signals {
+namespace rcu {
+
+namespace {
+
+const std::size_t slots_per_chunk = 256;
+
+struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch{0}; // 0: not in a read section
+    std::atomic<bool> used{false};
+};
+
+// The slot table grows by chunks that are linked behind the first one and never freed: a slot that a writer is
+// scanning stays valid, and slots of exited threads are reused.
+struct Chunk {
+    ReaderSlot slots[slots_per_chunk];
+    std::atomic<Chunk *> next{nullptr};
+};
+
+std::atomic<uint64_t> global_epoch{1};
+Chunk first_chunk;
+
+Chunk *new_chunk() {
+    void *memory = ::aligned_alloc(alignof(Chunk), sizeof(Chunk)); // plain new doesn't align to 64 before C++17
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return new(memory) Chunk();
+}
+
+template<typename Function>
+void for_each_slot(Function f) {
+    for (auto chunk = &first_chunk; chunk; chunk = chunk->next.load()) {
+        for (auto &&slot : chunk->slots) {
+            f(slot);
+        }
+    }
+}
+
+// claims a reader slot on the first read section of a thread, gives it back when the thread exits
+struct ThreadState {
+    ReaderSlot *slot = nullptr;
+    int depth = 0;
+
+    ReaderSlot &claim() {
+        for (auto chunk = &first_chunk; !slot; chunk = chunk->next.load()) {
+            for (auto &&candidate : chunk->slots) {
+                bool expected = false;
+                if (candidate.used.compare_exchange_strong(expected, true)) {
+                    slot = &candidate;
+                    break;
+                }
+            }
+            if (!slot && !chunk->next.load()) {
+                // all taken: link a new chunk, unless another thread just did
+                auto added = new_chunk();
+                Chunk *none = nullptr;
+                if (!chunk->next.compare_exchange_strong(none, added)) {
+                    added->~Chunk();
+                    ::free(added);
+                }
+            }
+        }
+        return *slot;
+    }
+
+    ~ThreadState() {
+        if (slot) {
+            slot->epoch.store(0);
+            slot->used.store(false);
+        }
+    }
+};
+
+thread_local ThreadState thread_state;
+
+}// namespace
+
+ReadGuard::ReadGuard() {
+    if (thread_state.depth++ == 0) {
+        // seq_cst: the announcement must be visible before this thread reads the published version
+        thread_state.claim().epoch.store(global_epoch.load());
+    }
+}
+
+ReadGuard::~ReadGuard() {
+    if (--thread_state.depth == 0) {
+        thread_state.slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+uint64_t advance() {
+    return global_epoch.fetch_add(1) + 1;
+}
+
+namespace {
+bool quiescent_since(uint64_t epoch, const ReaderSlot *ignore) {
+    bool quiescent = true;
+    for_each_slot([&](const ReaderSlot &slot) {
+        if (quiescent && &slot != ignore && slot.used.load()) {
+            auto announced = slot.epoch.load();
+            quiescent = announced == 0 || announced >= epoch;
+        }
+    });
+    return quiescent;
+}
+}// namespace
+
+bool quiescent_since(uint64_t epoch) {
+    return quiescent_since(epoch, nullptr);
+}
+
+void synchronize() {
+    auto epoch = advance();
+    while (!quiescent_since(epoch, thread_state.slot)) {
+        std::this_thread::yield();
+    }
+}
+
+}// namespace rcu
+}// namespace signals
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace signals {
+namespace rcu {
+
+// Minimal epoch based read-copy-update, used by ConcurrentSignal.
+// Readers announce the global epoch in their own (cache line padded) slot when they enter a read section, and
+// clear it when they leave: two stores and one load, no loop, no lock -> wait-free.
+// A writer publishes a new version, advances the epoch and may free the old version once every reader is either
+// outside a read section or entered it at/after that epoch (and therefore sees the new version).
+// Read sections nest: only the outermost one announces.
+
+class ReadGuard {
+public:
+    ReadGuard();
+    ~ReadGuard();
+
+    ReadGuard(const ReadGuard &) = delete;
+    ReadGuard &operator=(const ReadGuard &) = delete;
+};
+
+// advances the global epoch, call it after the new version has been published. Returns the new epoch.
+uint64_t advance();
+
+// true when no reader that entered its read section before `epoch` is still inside it
+bool quiescent_since(uint64_t epoch);
+
+// blocks until the read sections of other threads that were active at the time of the call have finished.
+// a read section of the calling thread itself is not waited for.
+void synchronize();
+
+}// namespace rcu
+}// namespace signals
@@ -0,0 +1,62 @@
+#include "Value.h"
+
+#include <algorithm>
+
+namespace signals {
+
+void Value::assign_string(boost::string_view value) {
+    if (value.size() <= inline_capacity) {
+        std::copy(value.begin(), value.end(), short_);
+        short_size_ = static_cast<unsigned char>(value.size());
+    } else {
+        heap_.data = new char[value.size()];
+        heap_.size = value.size();
+        std::copy(value.begin(), value.end(), heap_.data);
+        short_size_ = inline_capacity + 1;
+    }
+}
+
+void Value::copy_from(const Value &other) {
+    if (other.type_ == Type::string) {
+        assign_string(other.string());
+    } else {
+        std::memcpy(&storage_, &other.storage_, sizeof(storage_));
+    }
+}
+
+bool operator==(const Value &lhs, const Value &rhs) {
+    if (lhs.type_ != rhs.type_) {
+        return false;
+    }
+    switch (lhs.type_) {
+        case Value::Type::boolean:
+            return lhs.boolean_ == rhs.boolean_;
+        case Value::Type::integer:
+            return lhs.integer_ == rhs.integer_;
+        case Value::Type::real:
+            return lhs.real_ == rhs.real_;
+        case Value::Type::string:
+            return lhs.string() == rhs.string();
+        case Value::Type::none:
+        default:
+            return true;
+    }
+}
+
+namespace {
+struct Printer {
+    std::ostream &os;
+
+    void operator()(std::nullptr_t) const { os << "<none>"; }
+
+    template<typename T>
+    void operator()(const T &value) const { os << value; }
+};
+}
+
+std::ostream &operator<<(std::ostream &os, const Value &value) {
+    value.visit(Printer{os});
+    return os;
+}
+
+}// namespace signals
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <boost/utility/string_view.hpp>
+
+namespace signals {
+
+class BadValueAccess : public std::bad_cast {
+public:
+    const char *what() const noexcept override { return "signals::Value does not hold the requested type"; }
+};
+
+// Value of a property-change event, replaces boost::any in listener interfaces.
+// boost::any stores every value on the heap behind a virtual holder and any_cast compares typeid's.
+// Value is a 32 byte tagged union:
+// -> bool, integers (as int64_t), double and strings up to 24 characters are stored inline, no allocation
+// -> longer strings own one heap block
+// -> the type is a one byte index: get / visit are a switch, no RTTI
+class Value {
+public:
+    enum class Type : unsigned char {
+        none,
+        boolean,
+        integer,
+        real,
+        string
+    };
+
+    static constexpr std::size_t inline_capacity = 24;
+
+    Value() noexcept : type_(Type::none) {}
+
+    Value(bool value) noexcept : type_(Type::boolean) { boolean_ = value; }
+
+    template<typename Int, typename = typename std::enable_if<
+            std::is_integral<Int>::value && !std::is_same<Int, bool>::value>::type>
+    Value(Int value) noexcept : type_(Type::integer) {
+        integer_ = static_cast<int64_t>(value);
+    }
+
+    Value(double value) noexcept : type_(Type::real) { real_ = value; }
+
+    Value(boost::string_view value) : type_(Type::string) { assign_string(value); }
+
+    Value(const char *value) : Value(boost::string_view(value)) {}
+
+    Value(const std::string &value) : Value(boost::string_view(value)) {}
+
+    Value(const Value &other) : type_(other.type_) { copy_from(other); }
+
+    Value(Value &&other) noexcept : type_(other.type_) {
+        std::memcpy(&storage_, &other.storage_, sizeof(storage_)); // a heap string changes owner
+        short_size_ = other.short_size_;
+        other.type_ = Type::none;
+    }
+
+    Value &operator=(const Value &other) {
+        if (this != &other) {
+            Value copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    Value &operator=(Value &&other) noexcept {
+        if (this != &other) {
+            release();
+            type_ = other.type_;
+            std::memcpy(&storage_, &other.storage_, sizeof(storage_));
+            short_size_ = other.short_size_;
+            other.type_ = Type::none;
+        }
+        return *this;
+    }
+
+    ~Value() { release(); }
+
+    Type type() const { return type_; }
+
+    bool empty() const { return type_ == Type::none; }
+
+    // the counterpart of any_cast<T>(&any): nullptr unless the value is stored as T (bool, int64_t or double)
+    template<typename T>
+    const T *get_if() const {
+        static_assert(stored_type<T>() != Type::none, "get_if is for bool, int64_t and double, use get<T>()");
+        return type_ != Type::none && type_ == stored_type<T>() ? reinterpret_cast<const T *>(&storage_) : nullptr;
+    }
+
+    // bool, any integer type (range checked), double, boost::string_view or std::string, throws BadValueAccess
+    template<typename T>
+    T get() const { return get(Tag<T>()); }
+
+    // calls visitor with nullptr, bool, int64_t, double or boost::string_view
+    template<typename Visitor>
+    auto visit(Visitor &&visitor) const -> decltype(visitor(nullptr)) {
+        switch (type_) {
+            case Type::boolean:
+                return visitor(boolean_);
+            case Type::integer:
+                return visitor(integer_);
+            case Type::real:
+                return visitor(real_);
+            case Type::string:
+                return visitor(string());
+            case Type::none:
+            default:
+                return visitor(nullptr);
+        }
+    }
+
+    friend bool operator==(const Value &lhs, const Value &rhs);
+
+    friend bool operator!=(const Value &lhs, const Value &rhs) { return !(lhs == rhs); }
+
+    friend std::ostream &operator<<(std::ostream &os, const Value &value);
+
+private:
+    template<typename T>
+    struct Tag {};
+
+    struct HeapString {
+        char *data;
+        std::size_t size;
+    };
+
+    template<typename T>
+    static constexpr Type stored_type() {
+        return std::is_same<T, bool>::value ? Type::boolean
+                                            : std::is_same<T, int64_t>::value ? Type::integer
+                                                                              : std::is_same<T, double>::value
+                                                                                ? Type::real : Type::none;
+    }
+
+    bool is_inline_string() const { return short_size_ <= inline_capacity; }
+
+    boost::string_view string() const {
+        return is_inline_string() ? boost::string_view(short_, short_size_)
+                                  : boost::string_view(heap_.data, heap_.size);
+    }
+
+    void assign_string(boost::string_view value);
+
+    void copy_from(const Value &other);
+
+    void release() noexcept {
+        if (type_ == Type::string && !is_inline_string()) {
+            delete[] heap_.data;
+        }
+    }
+
+    void expect(Type type) const {
+        if (type_ != type) {
+            throw BadValueAccess();
+        }
+    }
+
+    bool get(Tag<bool>) const {
+        expect(Type::boolean);
+        return boolean_;
+    }
+
+    double get(Tag<double>) const {
+        expect(Type::real);
+        return real_;
+    }
+
+    boost::string_view get(Tag<boost::string_view>) const {
+        expect(Type::string);
+        return string();
+    }
+
+    std::string get(Tag<std::string>) const {
+        return get(Tag<boost::string_view>()).to_string();
+    }
+
+    template<typename Int>
+    Int get(Tag<Int>) const {
+        static_assert(std::is_integral<Int>::value, "signals::Value holds bool, integers, double or strings");
+        expect(Type::integer);
+        if (integer_ < int64_t(std::numeric_limits<Int>::min()) ||
+            (integer_ > 0 && uint64_t(integer_) > uint64_t(std::numeric_limits<Int>::max()))) {
+            throw BadValueAccess();
+        }
+        return static_cast<Int>(integer_);
+    }
+
+    union {
+        bool boolean_;
+        int64_t integer_;
+        double real_;
+        char short_[inline_capacity];
+        HeapString heap_;
+        unsigned char storage_[inline_capacity];
+    };
+    unsigned char short_size_ = 0; // inline_capacity + 1 when the string is on the heap
+    Type type_;
+};
+
+}// namespace signals
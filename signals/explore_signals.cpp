@@ -0,0 +1,637 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <boost/any.hpp>
+#include <boost/signals2.hpp>
+
+#include "FastSignal.h"
+#include "ConcurrentSignal.h"
+#include "QueuedSignal.h"
+#include "Value.h"
+#include "benchmark/Allocations.h"
+#include "benchmark/Timer.h"
+
+// FastSignal
+// boost::signals2::signal is thread safe: every emission locks a mutex, copies (a reference counted snapshot of) the
+// slot list and locks every connection body. A signal that is only used from one thread pays for that on every call.
+// FastSignal keeps the same interface (connect, group, disconnect, scoped connection) without any of it.
+
+using namespace signals;
+
+TEST(fast_signal, connect_and_emit) {
+    int scored = 0;
+    FastSignal<void()> scores;
+    EXPECT_TRUE(scores.empty());
+
+    scores.connect([&scored]() { scored++; });
+    scores.connect([&scored]() { scored++; });
+    EXPECT_EQ(2, scores.num_slots());
+
+    scores();
+    EXPECT_EQ(2, scored);
+
+    FastSignal<void(std::string, int)> scores_with_name_and_goals;
+    scores_with_name_and_goals.connect([&scored](std::string name, int goals) {
+        EXPECT_EQ("Jan", name);
+        scored += goals;
+    });
+    scores_with_name_and_goals("Jan", 3);
+    EXPECT_EQ(5, scored);
+
+    scores.disconnect_all_slots();
+    scores();
+    EXPECT_EQ(5, scored);
+    EXPECT_TRUE(scores.empty());
+}
+
+TEST(fast_signal, groups_are_called_in_order) {
+    std::vector<std::string> calls;
+    FastSignal<void()> s;
+    s.connect([&calls]() { calls.push_back("ungrouped"); });
+    s.connect(1, [&calls]() { calls.push_back("first"); });
+    s.connect(0, [&calls]() { calls.push_back("second"); });
+    s.connect(1, [&calls]() { calls.push_back("first, connected later"); });
+
+    s();
+    EXPECT_EQ(std::vector<std::string>({"second", "first", "first, connected later", "ungrouped"}), calls);
+}
+
+TEST(fast_signal, disconnect_and_scoped_connection) {
+    int i = 0;
+    FastSignal<void()> s;
+    auto c = s.connect([&i]() { i++; });
+    EXPECT_TRUE(c.connected());
+    {
+        ScopedConnection sc = s.connect([&i]() { i += 10; });
+        s();
+        EXPECT_EQ(11, i);
+        EXPECT_EQ(2, s.num_slots());
+    }
+    EXPECT_EQ(1, s.num_slots());
+    s();
+    EXPECT_EQ(12, i);
+
+    c.disconnect();
+    EXPECT_FALSE(c.connected());
+    s();
+    EXPECT_EQ(12, i);
+}
+
+TEST(fast_signal, connection_outlives_signal) {
+    Connection c;
+    {
+        FastSignal<void()> s;
+        c = s.connect([]() {});
+        EXPECT_TRUE(c.connected());
+    }
+    EXPECT_FALSE(c.connected());
+    c.disconnect(); // no-op
+}
+
+TEST(fast_signal, disconnect_during_emission_is_deferred) {
+    // same as Signals2_advanced_passing_connection: a slot disconnects itself after three calls
+    FastSignal<void(int)> s;
+    int v = 0;
+    int count = 0;
+    Connection self;
+    self = s.connect([&](int value) {
+        if (count == 3) {
+            self.disconnect();
+        } else {
+            v = v + value;
+        }
+        count++;
+    });
+    for (int i = 0; i < 5; i++) {
+        s(1);
+    }
+    EXPECT_EQ(3, v);
+    EXPECT_EQ(0, s.num_slots());
+}
+
+TEST(fast_signal, slots_connected_during_emission_are_called_next_time) {
+    FastSignal<void()> s;
+    int late = 0;
+    s.connect([&]() {
+        if (s.num_slots() == 1) {
+            s.connect(0, [&late]() { late++; });
+        }
+    });
+    s();
+    EXPECT_EQ(0, late);
+    EXPECT_EQ(2, s.num_slots());
+    s();
+    EXPECT_EQ(1, late);
+}
+
+TEST(fast_signal, slot_disconnects_a_later_slot) {
+    FastSignal<void()> s;
+    int second = 0;
+    Connection c2;
+    s.connect([&c2]() { c2.disconnect(); });
+    c2 = s.connect([&second]() { second++; });
+    s();
+    EXPECT_EQ(0, second); // disconnected before its turn
+}
+
+TEST(fast_signal, throwing_slot_ends_the_emission) {
+    FastSignal<void()> s;
+    int calls = 0;
+    Connection thrower;
+    thrower = s.connect([&]() {
+        s.connect([&calls]() { calls++; }); // deferred
+        thrower.disconnect();               // deferred
+        throw std::runtime_error("slot failed");
+    });
+    EXPECT_THROW(s(), std::runtime_error);
+    EXPECT_EQ(1, s.num_slots());
+    s();
+    EXPECT_EQ(1, calls);
+    s.connect([&calls]() { calls += 10; }); // not emitting anymore: connected at once
+    s();
+    EXPECT_EQ(12, calls);
+}
+
+// emission cost with 1, 10 and 100 slots, 10M slot calls per run
+TEST(signals_benchmark, DISABLED_emission_fast_signal_vs_signals2) {
+    const long calls = 10000000;
+    for (int slots : {1, 10, 100}) {
+        long emissions = calls / slots;
+        long total_fast = 0;
+        long total_boost = 0;
+
+        FastSignal<void(int)> fast;
+        boost::signals2::signal<void(int)> boost_signal;
+        for (int i = 0; i < slots; i++) {
+            fast.connect([&total_fast](int v) { total_fast += v; });
+            boost_signal.connect([&total_boost](int v) { total_boost += v; });
+        }
+        {
+            benchmark::Timer t("signals2, " + std::to_string(slots) + " slots");
+            for (long e = 0; e < emissions; e++) {
+                boost_signal(1);
+            }
+        }
+        {
+            benchmark::Timer t("FastSignal, " + std::to_string(slots) + " slots");
+            for (long e = 0; e < emissions; e++) {
+                fast(1);
+            }
+        }
+        EXPECT_EQ(total_boost, total_fast);
+    }
+}
+
+// ConcurrentSignal
+// Emitting e.g. Player::Scores_with_name_and_goals from many threads: signals2 serializes all emitters on one mutex.
+// Read-copy-update: emitters read an immutable snapshot of the slot list, writers (connect/disconnect) copy it.
+
+TEST(concurrent_signal, connect_emit_disconnect) {
+    ConcurrentSignal<void(const std::string &, int)> scores_with_name_and_goals;
+    int goals = 0;
+    std::vector<std::string> calls;
+    scores_with_name_and_goals.connect([&calls](const std::string &, int) { calls.push_back("ungrouped"); });
+    auto c = scores_with_name_and_goals.connect(1, [&goals](const std::string &name, int count) {
+        EXPECT_EQ("Jan", name);
+        goals += count;
+    });
+    scores_with_name_and_goals.connect(0, [&calls](const std::string &, int) { calls.push_back("group 0"); });
+    EXPECT_EQ(3, scores_with_name_and_goals.num_slots());
+
+    scores_with_name_and_goals("Jan", 2);
+    EXPECT_EQ(2, goals);
+    EXPECT_EQ(std::vector<std::string>({"group 0", "ungrouped"}), calls);
+
+    EXPECT_TRUE(c.connected());
+    c.disconnect();
+    EXPECT_FALSE(c.connected());
+    scores_with_name_and_goals("Jan", 2);
+    EXPECT_EQ(2, goals);
+
+    {
+        ScopedConnection sc = scores_with_name_and_goals.connect([&goals](const std::string &, int) { goals = 100; });
+        scores_with_name_and_goals("Jan", 0);
+        EXPECT_EQ(100, goals);
+    }
+    EXPECT_EQ(2, scores_with_name_and_goals.num_slots());
+    scores_with_name_and_goals.disconnect_all_slots();
+    EXPECT_TRUE(scores_with_name_and_goals.empty());
+}
+
+TEST(concurrent_signal, slot_may_connect_and_disconnect_during_emission) {
+    ConcurrentSignal<void()> s;
+    int calls = 0;
+    Connection self;
+    self = s.connect([&]() {
+        calls++;
+        self.disconnect();              // writers never wait for readers, so this does not deadlock
+        s.connect([&calls]() { calls += 10; });
+    });
+    s();
+    EXPECT_EQ(1, calls);               // the snapshot of this emission did not contain the new slot
+    s();
+    EXPECT_EQ(11, calls);
+}
+
+TEST(concurrent_signal, more_emitting_threads_than_one_slot_chunk) {
+    ConcurrentSignal<void()> s;
+    const int threads = 600;            // each one is inside an emission at the same time
+    std::atomic<int> inside{0};
+    s.connect([&inside]() {
+        inside++;
+        while (inside < threads) {
+            std::this_thread::yield();
+        }
+    });
+    std::vector<std::thread> emitters;
+    for (int i = 0; i < threads; i++) {
+        emitters.emplace_back([&s]() { s(); });
+    }
+    for (auto &&t : emitters) {
+        t.join();
+    }
+    EXPECT_EQ(threads, inside);
+    s.disconnect_all_slots();           // the writer scans every chunk
+    EXPECT_TRUE(s.empty());
+}
+
+TEST(concurrent_signal, emit_while_other_threads_connect_and_disconnect) {
+    ConcurrentSignal<void(int)> s;
+    std::atomic<long> total{0};
+    s.connect([&total](int v) { total += v; });  // stays connected the whole test
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> emitters;
+    for (int i = 0; i < 4; i++) {
+        emitters.emplace_back([&]() {
+            for (int j = 0; j < 20000; j++) {
+                s(1);
+            }
+        });
+    }
+    std::thread writer([&]() {
+        while (!done) {
+            auto c = s.connect([](int) {});
+            c.disconnect();
+        }
+    });
+    for (auto &t : emitters) {
+        t.join();
+    }
+    done = true;
+    writer.join();
+    EXPECT_EQ(4 * 20000, total);
+    EXPECT_EQ(1, s.num_slots());
+}
+
+// 1, 2, 4 and 8 threads emit concurrently on one signal with 10 slots
+TEST(signals_benchmark, DISABLED_concurrent_emission_rcu_vs_signals2) {
+    const long emissions_per_thread = 200000;
+    for (int threads : {1, 2, 4, 8}) {
+        ConcurrentSignal<void(const std::string &, int)> rcu_signal;
+        boost::signals2::signal<void(const std::string &, int)> boost_signal;
+        for (int i = 0; i < 10; i++) {
+            rcu_signal.connect([](const std::string &, int goals) { benchmark::DoNotOptimize(goals); });
+            boost_signal.connect([](const std::string &, int goals) { benchmark::DoNotOptimize(goals); });
+        }
+        const std::string name = "Jan";
+        auto run = [&](const std::string &label, std::function<void()> emit) {
+            benchmark::Timer t(label + ", " + std::to_string(threads) + " threads");
+            std::vector<std::thread> emitters;
+            for (int i = 0; i < threads; i++) {
+                emitters.emplace_back([&]() {
+                    for (long e = 0; e < emissions_per_thread; e++) {
+                        emit();
+                    }
+                });
+            }
+            for (auto &th : emitters) {
+                th.join();
+            }
+        };
+        run("signals2", [&]() { boost_signal(name, 1); });
+        run("ConcurrentSignal", [&]() { rcu_signal(name, 1); });
+    }
+}
+
+// QueuedSignal
+// The timer class in boost_lib.cpp calls publisher_() inside its asio handler: a slow subscriber (timerHandler) blocks
+// the timer thread. With a queued connection the emission only posts a message to the executor of the subscriber.
+
+TEST(queued_signal, slot_runs_on_its_executor) {
+    boost::asio::io_context subscriber_context;
+    QueuedSignal<void(std::string)> publisher;
+    std::vector<std::string> received;
+    std::thread::id subscriber_thread;
+
+    auto c = publisher.connect(subscriber_context.get_executor(), [&](std::string name) {
+        subscriber_thread = std::this_thread::get_id();
+        received.push_back(name);
+    });
+    publisher("jan");
+    publisher("piet");
+    EXPECT_TRUE(received.empty()); // nothing is called on the emitting thread
+    EXPECT_EQ(2, c.posted());
+    EXPECT_EQ(2, c.pending());
+
+    std::thread::id consumer_thread;
+    std::thread consumer([&]() {
+        consumer_thread = std::this_thread::get_id();
+        subscriber_context.run();
+    });
+    consumer.join();
+
+    EXPECT_EQ(consumer_thread, subscriber_thread);
+    EXPECT_EQ(std::vector<std::string>({"jan", "piet"}), received);
+    EXPECT_EQ(2, c.delivered());
+    EXPECT_EQ(0, c.pending());
+}
+
+TEST(queued_signal, back_pressure_drops_and_counts) {
+    boost::asio::io_context slow_subscriber;
+    QueuedSignal<void(int)> publisher;
+    int sum = 0;
+    auto c = publisher.connect(slow_subscriber.get_executor(), [&sum](int v) { sum += v; }, 10);
+
+    for (int i = 0; i < 100; i++) {
+        publisher(1);
+    }
+    EXPECT_EQ(10, c.posted());
+    EXPECT_EQ(90, c.dropped());
+    EXPECT_EQ(10, c.pending());
+
+    slow_subscriber.run();
+    EXPECT_EQ(10, sum);
+    EXPECT_EQ(0, c.pending());
+
+    publisher(1); // room again
+    EXPECT_EQ(11, c.posted());
+}
+
+TEST(queued_signal, concurrent_emitters_respect_max_pending) {
+    boost::asio::io_context slow_subscriber; // never runs
+    QueuedSignal<void(int)> publisher;
+    auto c = publisher.connect(slow_subscriber.get_executor(), [](int) {}, 10);
+    std::vector<std::thread> emitters;
+    for (int t = 0; t < 8; t++) {
+        emitters.emplace_back([&publisher]() {
+            for (int i = 0; i < 1000; i++) {
+                publisher(i);
+            }
+        });
+    }
+    for (auto &&emitter : emitters) {
+        emitter.join();
+    }
+    EXPECT_EQ(10, c.posted());
+    EXPECT_EQ(10, c.pending());
+    EXPECT_EQ(8000 - 10, c.dropped());
+}
+
+TEST(queued_signal, disconnect_discards_queued_messages) {
+    boost::asio::io_context subscriber_context;
+    QueuedSignal<void(int)> publisher;
+    int calls = 0;
+    auto c = publisher.connect(subscriber_context.get_executor(), [&calls](int) { calls++; });
+    publisher(1);
+    publisher(2);
+    c.disconnect();
+    publisher(3);
+    subscriber_context.run();
+    EXPECT_EQ(0, calls);
+    EXPECT_EQ(2, c.posted());
+    EXPECT_EQ(0, c.delivered());
+    EXPECT_EQ(0, c.pending());
+
+    QueuedConnection none;
+    EXPECT_FALSE(none.connected());
+    EXPECT_EQ(0, none.posted());
+    EXPECT_EQ(0, none.pending());
+    EXPECT_EQ(0, none.pooled_blocks());
+    none.disconnect();
+}
+
+TEST(queued_signal, disconnect_all_discards_queued_messages) {
+    boost::asio::io_context subscriber_context;
+    QueuedSignal<void(int)> publisher;
+    int calls = 0;
+    auto c1 = publisher.connect(subscriber_context.get_executor(), [&calls](int) { calls++; });
+    auto c2 = publisher.connect(subscriber_context.get_executor(), [&calls](int) { calls++; });
+    publisher(1);
+    publisher.disconnect_all_slots();
+    publisher(2);
+    subscriber_context.run();
+    EXPECT_EQ(0, calls);
+    EXPECT_TRUE(publisher.empty());
+    EXPECT_EQ(1, c1.posted());
+    EXPECT_EQ(0, c2.delivered());
+}
+
+TEST(queued_signal, strand_on_thread_pool_keeps_order) {
+    boost::asio::thread_pool pool(4);   // execution contexts must outlive the connections that post to them
+    QueuedSignal<void(int)> publisher;
+    auto strand = boost::asio::make_strand(pool.get_executor());
+    std::vector<int> received; // only touched from the strand
+
+    auto c = publisher.connect(strand, [&received](int v) { received.push_back(v); });
+    for (int i = 0; i < 1000; i++) {
+        publisher(i);
+    }
+    pool.join();
+
+    ASSERT_EQ(1000, received.size());
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(i, received[i]);
+    }
+}
+
+TEST(queued_signal, messages_reuse_pooled_memory) {
+    boost::asio::io_context subscriber_context;
+    QueuedSignal<void(std::string, int)> publisher;
+    auto c = publisher.connect(subscriber_context.get_executor(), [](std::string, int) {});
+    for (int i = 0; i < 1000; i++) {
+        publisher("Jan", i);
+        subscriber_context.poll();  // one message in flight at a time
+        subscriber_context.restart();
+    }
+    EXPECT_EQ(1000, c.delivered());
+    EXPECT_GT(c.pooled_blocks(), 0);    // asio allocated through the pool
+    EXPECT_LE(c.pooled_blocks(), 2);    // and kept reusing the same block
+}
+
+// producer side cost of 1000 emissions to a subscriber that needs 50us per message
+TEST(signals_benchmark, DISABLED_slow_subscriber_direct_vs_queued) {
+    auto slow_slot = [](int) {
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(50);
+        while (std::chrono::steady_clock::now() < until) {}
+    };
+    {
+        boost::signals2::signal<void(int)> direct;
+        direct.connect(slow_slot);
+        benchmark::Timer t("signals2, producer calls the slow slot");
+        for (int i = 0; i < 1000; i++) {
+            direct(i);
+        }
+    }
+    {
+        boost::asio::io_context subscriber_context;
+        QueuedSignal<void(int)> queued;
+        auto work = boost::asio::make_work_guard(subscriber_context);
+        std::thread consumer([&subscriber_context]() { subscriber_context.run(); });
+        auto c = queued.connect(subscriber_context.get_executor(), slow_slot);
+        {
+            benchmark::Timer t("QueuedSignal, producer only posts");
+            for (int i = 0; i < 1000; i++) {
+                queued(i);
+            }
+        }
+        work.reset();
+        consumer.join();
+        EXPECT_EQ(1000, c.delivered());
+    }
+}
+
+// Value
+// A property-change event carries the new value of the property. With boost::any (observer's PersonListener) every
+// notification allocates a holder for it, and the listener pays for a typeid comparison in any_cast.
+
+TEST(value, scalars_and_strings) {
+    Value none;
+    EXPECT_TRUE(none.empty());
+    EXPECT_EQ(nullptr, none.get_if<int64_t>());
+    EXPECT_EQ(nullptr, none.get_if<bool>());
+
+    Value age = 16;
+    EXPECT_EQ(Value::Type::integer, age.type());
+    EXPECT_EQ(16, age.get<int>());
+    EXPECT_EQ(16u, age.get<unsigned char>());
+    EXPECT_THROW(age.get<double>(), BadValueAccess);
+    EXPECT_THROW(Value(1000).get<char>(), BadValueAccess); // does not fit
+    EXPECT_EQ(16, *age.get_if<int64_t>());
+    EXPECT_EQ(nullptr, age.get_if<double>());
+
+    Value can_vote = true;
+    EXPECT_TRUE(can_vote.get<bool>());
+    EXPECT_EQ(Value::Type::real, Value(2.0).type());
+
+    Value name = "life";
+    EXPECT_EQ("life", name.get<boost::string_view>());
+    EXPECT_EQ(std::string("life"), name.get<std::string>());
+    EXPECT_THROW(name.get<int>(), BadValueAccess);
+
+    std::string long_name(100, 'x');
+    Value copy = Value(long_name);
+    Value moved = std::move(copy);
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(long_name, moved.get<std::string>());
+    copy = moved;
+    EXPECT_EQ(moved, copy);
+    EXPECT_NE(Value(42), Value(42.0));
+
+    std::vector<Value> values{42, "life"}; // the boost::any vector of boost_lib.cpp
+    std::ostringstream os;
+    for (auto &value : values) {
+        os << value << " ";
+    }
+    EXPECT_EQ("42 life ", os.str());
+    EXPECT_EQ(sizeof(void *) == 8 ? 32u : sizeof(Value), sizeof(Value));
+}
+
+TEST(value, visit_dispatches_on_the_index) {
+    struct Describe {
+        std::string operator()(std::nullptr_t) const { return "none"; }
+        std::string operator()(bool) const { return "bool"; }
+        std::string operator()(int64_t) const { return "integer"; }
+        std::string operator()(double) const { return "real"; }
+        std::string operator()(boost::string_view) const { return "string"; }
+    };
+    EXPECT_EQ("none", Value().visit(Describe()));
+    EXPECT_EQ("bool", Value(false).visit(Describe()));
+    EXPECT_EQ("integer", Value(7u).visit(Describe()));
+    EXPECT_EQ("real", Value(0.5).visit(Describe()));
+    EXPECT_EQ("string", Value(std::string("age")).visit(Describe()));
+}
+
+TEST(value, inline_values_do_not_allocate) {
+    auto before = benchmark::thread_allocations();
+    Value a = 42;
+    Value b = 3.14;
+    Value c = "short property value";
+    Value d = c;
+    Value e = std::move(d);
+    EXPECT_EQ(before, benchmark::thread_allocations());
+
+    std::string text(100, 'x');
+    before = benchmark::thread_allocations();
+    Value long_string = text;
+    EXPECT_EQ(before + 1, benchmark::thread_allocations());
+}
+
+namespace {
+template<typename T>
+struct PropertyListener {
+    virtual ~PropertyListener() = default;
+
+    virtual void changed(const std::string &property_name, const T &new_value) = 0;
+};
+
+struct AnyListener : PropertyListener<boost::any> {
+    int64_t sum = 0;
+
+    void changed(const std::string &, const boost::any &new_value) override {
+        benchmark::DoNotOptimize(new_value);
+        sum += boost::any_cast<int>(new_value);
+    }
+};
+
+struct ValueListener : PropertyListener<Value> {
+    int64_t sum = 0;
+
+    void changed(const std::string &, const Value &new_value) override {
+        benchmark::DoNotOptimize(new_value);
+        sum += new_value.get<int>();
+    }
+};
+}
+
+// 10M notifications of the age property, as Person::SetAge does
+TEST(signals_benchmark, DISABLED_property_notifications_any_vs_value) {
+    const int notifications = 10000000;
+    const std::string property = "age";
+
+    AnyListener any_listener;
+    PropertyListener<boost::any> &any_base = any_listener;
+    uint64_t any_allocations;
+    {
+        benchmark::Timer t("10M notifications, boost::any");
+        auto before = benchmark::thread_allocations();
+        for (int age = 0; age < notifications; age++) {
+            any_base.changed(property, boost::any(age));
+        }
+        any_allocations = benchmark::thread_allocations() - before;
+    }
+
+    ValueListener value_listener;
+    PropertyListener<Value> &value_base = value_listener;
+    uint64_t value_allocations;
+    {
+        benchmark::Timer t("10M notifications, signals::Value");
+        auto before = benchmark::thread_allocations();
+        for (int age = 0; age < notifications; age++) {
+            value_base.changed(property, Value(age));
+        }
+        value_allocations = benchmark::thread_allocations() - before;
+    }
+
+    std::cout << "[benchmark] heap allocations: boost::any " << any_allocations << ", signals::Value "
+              << value_allocations << std::endl;
+    EXPECT_EQ(uint64_t(notifications), any_allocations);
+    EXPECT_EQ(0u, value_allocations);
+    EXPECT_EQ(any_listener.sum, value_listener.sum);
+}
@@ -0,0 +1,149 @@
+#include "ArrayTable.h"
+
+namespace sql {
+
+namespace {
+
+const char *const pointer_type = "sql::ArraySource";
+
+struct ArrayModule {
+    std::string schema;
+    int columns;
+};
+
+struct ArrayVtab {
+    sqlite3_vtab base;
+    int columns;
+};
+
+struct ArrayCursor {
+    sqlite3_vtab_cursor base;
+    const ArraySource *source;
+    std::size_t row;
+};
+
+int array_connect(sqlite3 *db, void *aux, int, const char *const *, sqlite3_vtab **out, char **) {
+    auto module = static_cast<ArrayModule *>(aux);
+    int rc = sqlite3_declare_vtab(db, module->schema.c_str());
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    auto vtab = new ArrayVtab();
+    vtab->columns = module->columns;
+    *out = &vtab->base;
+    return SQLITE_OK;
+}
+
+int array_disconnect(sqlite3_vtab *vtab) {
+    delete reinterpret_cast<ArrayVtab *>(vtab);
+    return SQLITE_OK;
+}
+
+// the only usable plan is "source = ?": the hidden column is the argument of the table valued function
+int array_best_index(sqlite3_vtab *vtab, sqlite3_index_info *info) {
+    auto source_column = reinterpret_cast<ArrayVtab *>(vtab)->columns;
+    for (int i = 0; i < info->nConstraint; i++) {
+        auto &constraint = info->aConstraint[i];
+        if (constraint.usable && constraint.iColumn == source_column && constraint.op == SQLITE_INDEX_CONSTRAINT_EQ) {
+            info->aConstraintUsage[i].argvIndex = 1;
+            info->aConstraintUsage[i].omit = 1;
+            info->idxNum = 1;
+            info->estimatedCost = 1;
+            return SQLITE_OK;
+        }
+    }
+    info->idxNum = 0; // no array bound, the table is empty
+    info->estimatedCost = 1e12;
+    return SQLITE_OK;
+}
+
+int array_open(sqlite3_vtab *, sqlite3_vtab_cursor **out) {
+    auto cursor = new ArrayCursor();
+    *out = &cursor->base;
+    return SQLITE_OK;
+}
+
+int array_close(sqlite3_vtab_cursor *cursor) {
+    delete reinterpret_cast<ArrayCursor *>(cursor);
+    return SQLITE_OK;
+}
+
+int array_filter(sqlite3_vtab_cursor *base, int idxNum, const char *, int argc, sqlite3_value **argv) {
+    auto cursor = reinterpret_cast<ArrayCursor *>(base);
+    cursor->source = (idxNum == 1 && argc == 1)
+                     ? static_cast<const ArraySource *>(sqlite3_value_pointer(argv[0], pointer_type))
+                     : nullptr;
+    cursor->row = 0;
+    return SQLITE_OK;
+}
+
+int array_next(sqlite3_vtab_cursor *base) {
+    reinterpret_cast<ArrayCursor *>(base)->row++;
+    return SQLITE_OK;
+}
+
+int array_eof(sqlite3_vtab_cursor *base) {
+    auto cursor = reinterpret_cast<ArrayCursor *>(base);
+    return !cursor->source || cursor->row >= cursor->source->size();
+}
+
+int array_column(sqlite3_vtab_cursor *base, sqlite3_context *context, int column) {
+    auto cursor = reinterpret_cast<ArrayCursor *>(base);
+    auto vtab = reinterpret_cast<ArrayVtab *>(base->pVtab);
+    if (column == vtab->columns) {
+        sqlite3_result_null(context); // hidden source column
+    } else {
+        cursor->source->result(context, cursor->row, column);
+    }
+    return SQLITE_OK;
+}
+
+int array_rowid(sqlite3_vtab_cursor *base, sqlite3_int64 *rowid) {
+    *rowid = static_cast<sqlite3_int64>(reinterpret_cast<ArrayCursor *>(base)->row);
+    return SQLITE_OK;
+}
+
+sqlite3_module make_array_module() {
+    sqlite3_module module = {};
+    module.iVersion = 0;
+    module.xCreate = nullptr; // eponymous only: usable as name(?1) without CREATE VIRTUAL TABLE
+    module.xConnect = array_connect;
+    module.xBestIndex = array_best_index;
+    module.xDisconnect = array_disconnect;
+    module.xDestroy = nullptr;
+    module.xOpen = array_open;
+    module.xClose = array_close;
+    module.xFilter = array_filter;
+    module.xNext = array_next;
+    module.xEof = array_eof;
+    module.xColumn = array_column;
+    module.xRowid = array_rowid;
+    return module;
+}
+
+const sqlite3_module array_module = make_array_module();
+
+}// namespace
+
+void register_array_table(Db &db, const std::string &name, const std::vector<std::string> &columns) {
+    auto module = new ArrayModule();
+    module->schema = "CREATE TABLE x(";
+    for (auto &&column : columns) {
+        module->schema += column + ",";
+    }
+    module->schema += "source HIDDEN)";
+    module->columns = static_cast<int>(columns.size());
+
+    int rc = sqlite3_create_module_v2(db.handle(), name.c_str(), &array_module, module, [](void *aux) {
+        delete static_cast<ArrayModule *>(aux);
+    });
+    check(db.handle(), rc);
+}
+
+void bind_array(Statement &statement, int index, const ArraySource &source) {
+    int rc = sqlite3_bind_pointer(statement.handle(), index, const_cast<ArraySource *>(&source), pointer_type,
+                                  nullptr);
+    check(sqlite3_db_handle(statement.handle()), rc);
+}
+
+}// namespace sql
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sqlite3.h"
+#include "Db.h"
+#include "Statement.h"
+
+namespace sql {
+
+// Table valued functions over C++ arrays (the idea of sqlite's carray extension, which is not part of the system
+// library). The array is bound to the statement as a pointer, so there is no SQL text to generate and parse:
+// -> SELECT * FROM COMPANY WHERE ID IN int64_array(?1)
+// -> INSERT INTO COMPANY SELECT * FROM company_array(?1)
+// The array must stay alive and unchanged while the statement is running.
+
+// type erased view on a bound array, one record per row
+class ArraySource {
+public:
+    virtual ~ArraySource() = default;
+
+    virtual std::size_t size() const = 0;
+
+    virtual void result(sqlite3_context *context, std::size_t row, int column) const = 0;
+};
+
+// Specialize for every record type that is used with an array table:
+//   static std::vector<std::string> columns();                          column names of the table
+//   static void result(sqlite3_context*, const T& record, int column);  sqlite3_result_* for one column
+template<typename T>
+struct record_traits;
+
+template<>
+struct record_traits<int64_t> {
+    static std::vector<std::string> columns() { return {"value"}; }
+
+    static void result(sqlite3_context *context, const int64_t &value, int) {
+        sqlite3_result_int64(context, value);
+    }
+};
+
+template<typename T>
+class ArrayRef : public ArraySource {
+public:
+    explicit ArrayRef(const std::vector<T> &records) : data_(records.data()), size_(records.size()) {}
+
+    ArrayRef(const T *data, std::size_t size) : data_(data), size_(size) {}
+
+    std::size_t size() const override { return size_; }
+
+    void result(sqlite3_context *context, std::size_t row, int column) const override {
+        record_traits<T>::result(context, data_[row], column);
+    }
+
+private:
+    const T *data_;
+    std::size_t size_;
+};
+
+// registers the eponymous virtual table `name` with one column per column of the record type
+void register_array_table(Db &db, const std::string &name, const std::vector<std::string> &columns);
+
+template<typename T>
+void register_array(Db &db, const std::string &name) {
+    register_array_table(db, name, record_traits<T>::columns());
+}
+
+void bind_array(Statement &statement, int index, const ArraySource &source);
+
+}// namespace sql
@@ -0,0 +1,101 @@
+#include "AsyncExecutor.h"
+#include "ConnectionPool.h"
+
+namespace sql {
+
+AsyncExecutor::AsyncExecutor(const std::string &path, std::size_t max_batch)
+        : max_batch_(max_batch),
+          db_(new Db(path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX)) {
+    db_->exec("PRAGMA journal_mode=WAL");
+    ConnectionPool::tune(*db_, PoolOptions());
+    thread_ = std::thread(&AsyncExecutor::run, this);
+}
+
+AsyncExecutor::~AsyncExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queued_.notify_one();
+    thread_.join();
+}
+
+void AsyncExecutor::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    queued_.notify_one();
+}
+
+void AsyncExecutor::run() {
+    for (;;) {
+        std::vector<Job> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queued_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) {
+                return; // stopping and drained
+            }
+            // take one read, or a run of adjacent writes
+            bool write = jobs_.front().write;
+            do {
+                batch.push_back(std::move(jobs_.front()));
+                jobs_.pop_front();
+            } while (write && !jobs_.empty() && jobs_.front().write && batch.size() < max_batch_);
+        }
+
+        if (batch.front().write) {
+            run_writes(batch);
+        } else {
+            run_read(batch.front());
+        }
+    }
+}
+
+void AsyncExecutor::run_read(Job &job) {
+    std::exception_ptr error;
+    try {
+        job.work(*db_);
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+    finish(job, error);
+}
+
+void AsyncExecutor::run_writes(std::vector<Job> &jobs) {
+    std::vector<std::exception_ptr> errors(jobs.size());
+    std::exception_ptr commit_error;
+    try {
+        Db::Transaction transaction(*db_);
+        for (std::size_t i = 0; i < jobs.size(); i++) {
+            db_->prepare("SAVEPOINT job").execute();
+            try {
+                jobs[i].work(*db_);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+                db_->prepare("ROLLBACK TO job").execute();
+            }
+            db_->prepare("RELEASE job").execute();
+        }
+        transaction.commit();
+        transactions_++;
+    }
+    catch (...) {
+        commit_error = std::current_exception(); // nothing of the batch was written
+    }
+
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        finish(jobs[i], commit_error ? commit_error : errors[i]);
+    }
+}
+
+void AsyncExecutor::finish(Job &job, std::exception_ptr error) {
+    auto complete = std::move(job.complete);
+    boost::asio::post(job.guard.get_executor(), [complete, error]() { complete(error); });
+    job.guard.reset();
+}
+
+}// namespace sql
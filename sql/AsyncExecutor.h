@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <boost/asio.hpp>
+#include "Db.h"
+
+namespace sql {
+
+// Runs database work on a dedicated thread that owns the connection, so event loop threads never block on disk I/O.
+// -> jobs are queued and executed in submission order
+// -> the completion handler is posted back to the io_context of the caller, and keeps that io_context running
+//    until it has been called (work guard)
+// -> adjacent writes in the queue are coalesced into one transaction (up to max_batch). Every write runs in its own
+//    SAVEPOINT: a failing write is rolled back on its own and only its handler sees the error.
+// -> write handlers are called after COMMIT, so a successful completion means the write is durable
+class AsyncExecutor {
+public:
+    explicit AsyncExecutor(const std::string &path, std::size_t max_batch = 512);
+    ~AsyncExecutor(); // finishes all queued work before it returns
+
+    AsyncExecutor(const AsyncExecutor &) = delete;
+    AsyncExecutor &operator=(const AsyncExecutor &) = delete;
+
+    // query(Db&) -> Result runs on the db thread, handler(std::exception_ptr, Result) runs on ioc.
+    // Result must be default constructible, the handler gets a default Result together with an error.
+    template<typename Query, typename Handler>
+    void async_read(boost::asio::io_context &ioc, Query query, Handler handler);
+
+    // work(Db&) runs on the db thread inside a (shared) transaction, handler(std::exception_ptr) runs on ioc
+    template<typename Work, typename Handler>
+    void async_write(boost::asio::io_context &ioc, Work work, Handler handler);
+
+    // number of transactions committed for writes, less than the number of writes when they were coalesced
+    std::size_t transactions() const { return transactions_; }
+
+private:
+    struct Job {
+        bool write;
+        std::function<void(Db &)> work;
+        std::function<void(std::exception_ptr)> complete;
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> guard;
+    };
+
+    void submit(Job job);
+    void run();
+    void run_read(Job &job);
+    void run_writes(std::vector<Job> &jobs);
+    static void finish(Job &job, std::exception_ptr error);
+
+    std::size_t max_batch_;
+    std::unique_ptr<Db> db_;
+    std::atomic<std::size_t> transactions_{0};
+
+    std::mutex mutex_;
+    std::condition_variable queued_;
+    std::deque<Job> jobs_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+template<typename Query, typename Handler>
+void AsyncExecutor::async_read(boost::asio::io_context &ioc, Query query, Handler handler) {
+    using Result = decltype(query(std::declval<Db &>()));
+    auto result = std::make_shared<Result>();
+    submit(Job{false,
+               [query, result](Db &db) { *result = query(db); },
+               [handler, result](std::exception_ptr error) mutable { handler(error, std::move(*result)); },
+               boost::asio::make_work_guard(ioc)});
+}
+
+template<typename Work, typename Handler>
+void AsyncExecutor::async_write(boost::asio::io_context &ioc, Work work, Handler handler) {
+    submit(Job{true, work, handler, boost::asio::make_work_guard(ioc)});
+}
+
+}// namespace sql
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <boost/utility/string_view.hpp>
+#include "ArrayTable.h"
+#include "Rows.h"
+
+namespace sql {
+
+// one row of the COMPANY table used by the sql tests
+struct Company {
+    int id;
+    std::string name;
+    int age;
+    std::string address;
+    double salary;
+};
+
+// same row, but the text columns borrow from sqlite's buffer: valid until the next row is read
+struct CompanyView {
+    int id;
+    boost::string_view name;
+    int age;
+    boost::string_view address;
+    double salary;
+};
+
+// both mappers expect the columns in table order: SELECT ID, NAME, AGE, ADDRESS, SALARY
+template<>
+struct row_mapper<Company> {
+    static Company map(const Row &row) {
+        return {row.get<int>(0), row.get<std::string>(1), row.get<int>(2), row.get<std::string>(3),
+                row.get<double>(4)};
+    }
+};
+
+template<>
+struct row_mapper<CompanyView> {
+    static CompanyView map(const Row &row) {
+        return {row.get<int>(0), row.text(1), row.get<int>(2), row.text(3), row.get<double>(4)};
+    }
+};
+
+// columns of company_array(?1), the array table used for bulk inserts
+template<>
+struct record_traits<Company> {
+    static std::vector<std::string> columns() { return {"ID", "NAME", "AGE", "ADDRESS", "SALARY"}; }
+
+    static void result(sqlite3_context *context, const Company &c, int column) {
+        switch (column) {
+            case 0: sqlite3_result_int(context, c.id); break;
+            case 1: sqlite3_result_text(context, c.name.data(), (int) c.name.size(), SQLITE_STATIC); break;
+            case 2: sqlite3_result_int(context, c.age); break;
+            case 3: sqlite3_result_text(context, c.address.data(), (int) c.address.size(), SQLITE_STATIC); break;
+            case 4: sqlite3_result_double(context, c.salary); break;
+        }
+    }
+};
+
+static const char *const create_company_table =
+        "CREATE TABLE IF NOT EXISTS COMPANY("
+        "ID INT PRIMARY KEY     NOT NULL,"
+        "NAME           TEXT    NOT NULL,"
+        "AGE            INT     NOT NULL,"
+        "ADDRESS        CHAR(50),"
+        "SALARY         REAL );";
+
+static const char *const insert_company =
+        "INSERT INTO COMPANY (ID,NAME,AGE,ADDRESS,SALARY) VALUES (?1, ?2, ?3, ?4, ?5);";
+
+static const char *const select_company = "SELECT ID, NAME, AGE, ADDRESS, SALARY FROM COMPANY";
+
+}// namespace sql
@@ -0,0 +1,70 @@
+#include "ConnectionPool.h"
+
+namespace sql {
+
+ConnectionPool::Lease::Lease(ConnectionPool &pool, std::unique_ptr<Db> db, bool writer)
+        : pool_(&pool),
+          db_(std::move(db)),
+          writer_(writer) {}
+
+ConnectionPool::Lease::Lease(Lease &&other) noexcept
+        : pool_(other.pool_),
+          db_(std::move(other.db_)),
+          writer_(other.writer_) {}
+
+ConnectionPool::Lease::~Lease() {
+    if (db_) {
+        pool_->give_back(std::move(db_), writer_);
+    }
+}
+
+ConnectionPool::ConnectionPool(const std::string &path, PoolOptions options) : options_(options) {
+    // each connection is used by one thread at a time, so sqlite's own per-connection mutex is not needed
+    const int flags = SQLITE_OPEN_NOMUTEX;
+
+    writer_.reset(new Db(path, flags | SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE));
+    writer_->exec("PRAGMA journal_mode=WAL"); // persistent, stored in the database file
+    tune(*writer_, options_);
+
+    for (std::size_t i = 0; i < options_.readers; i++) {
+        std::unique_ptr<Db> reader(new Db(path, flags | SQLITE_OPEN_READONLY));
+        tune(*reader, options_);
+        readers_.push_back(std::move(reader));
+    }
+}
+
+void ConnectionPool::tune(Db &db, const PoolOptions &options) {
+    db.exec("PRAGMA synchronous=NORMAL");   // in WAL mode only checkpoints sync, commits are still durable to the wal
+    db.exec("PRAGMA temp_store=MEMORY");
+    db.exec("PRAGMA mmap_size=" + std::to_string(options.mmap_size));
+    db.exec("PRAGMA cache_size=-" + std::to_string(options.cache_size_kib)); // negative value means KiB
+    sqlite3_busy_timeout(db.handle(), options.busy_timeout_ms);
+}
+
+ConnectionPool::Lease ConnectionPool::writer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait(lock, [this]() { return writer_ != nullptr; });
+    return Lease(*this, std::move(writer_), true);
+}
+
+ConnectionPool::Lease ConnectionPool::reader() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait(lock, [this]() { return !readers_.empty(); });
+    auto db = std::move(readers_.back());
+    readers_.pop_back();
+    return Lease(*this, std::move(db), false);
+}
+
+void ConnectionPool::give_back(std::unique_ptr<Db> db, bool writer) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (writer) {
+            writer_ = std::move(db);
+        } else {
+            readers_.push_back(std::move(db));
+        }
+    }
+    available_.notify_all();
+}
+
+}// namespace sql
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Db.h"
+
+namespace sql {
+
+struct PoolOptions {
+    std::size_t readers = 4;
+    int64_t mmap_size = 256 * 1024 * 1024;  // bytes of the database file mapped into memory
+    int cache_size_kib = 64 * 1024;         // page cache per connection
+    int busy_timeout_ms = 5000;
+};
+
+// Connection pool for one database file in WAL mode.
+// In WAL mode readers read from a snapshot and do not block on the writer (and vice versa), in contrast to the
+// default rollback journal where a commit needs an exclusive lock on the whole file.
+// -> one writer connection, WAL allows only one writer at a time anyway
+// -> N read-only connections, each leased by one thread at a time
+// every connection is tuned with: synchronous=NORMAL, mmap_size, cache_size and temp_store=MEMORY
+class ConnectionPool {
+public:
+    // RAII lease, gives the connection back to the pool when it goes out of scope
+    class Lease {
+    public:
+        Lease(ConnectionPool &pool, std::unique_ptr<Db> db, bool writer);
+        ~Lease();
+
+        Lease(Lease &&other) noexcept;
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        Lease &operator=(Lease &&) = delete;
+
+        Db &operator*() const { return *db_; }
+
+        Db *operator->() const { return db_.get(); }
+
+    private:
+        ConnectionPool *pool_;
+        std::unique_ptr<Db> db_;
+        bool writer_;
+    };
+
+    explicit ConnectionPool(const std::string &path, PoolOptions options = PoolOptions());
+
+    ConnectionPool(const ConnectionPool &) = delete;
+    ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+    // blocks until the writer connection is free
+    Lease writer();
+
+    // blocks until one of the reader connections is free
+    Lease reader();
+
+    std::size_t readers() const { return options_.readers; }
+
+    // applies the pragmas of the pool to a connection, public so the tests can tune a stand-alone Db the same way
+    static void tune(Db &db, const PoolOptions &options);
+
+private:
+    void give_back(std::unique_ptr<Db> db, bool writer);
+
+    PoolOptions options_;
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::unique_ptr<Db> writer_;
+    std::vector<std::unique_ptr<Db>> readers_;
+};
+
+}// namespace sql
@@ -0,0 +1,58 @@
+#include "Db.h"
+
+namespace sql {
+
+Db::Db(const std::string &path, int flags) {
+    int rc = sqlite3_open_v2(path.c_str(), &connection_, flags, nullptr);
+    if (rc != SQLITE_OK) {
+        std::string message = connection_ ? sqlite3_errmsg(connection_) : sqlite3_errstr(rc);
+        sqlite3_close(connection_);
+        throw Error("Can't open database " + path + ": " + message, rc);
+    }
+}
+
+Db::~Db() {
+    statements_.clear(); // all statements must be finalized before the connection can be closed
+    sqlite3_close(connection_);
+}
+
+void Db::exec(const std::string &sql) {
+    char *zErrMsg = nullptr;
+    int rc = sqlite3_exec(connection_, sql.c_str(), nullptr, nullptr, &zErrMsg);
+    if (rc != SQLITE_OK) {
+        std::string message = zErrMsg ? zErrMsg : sqlite3_errstr(rc);
+        sqlite3_free(zErrMsg);
+        throw Error("SQL error: " + message, rc);
+    }
+}
+
+Statement &Db::prepare(const std::string &sql) {
+    auto it = statements_.find(sql);
+    if (it == statements_.end()) {
+        it = statements_.emplace(sql, std::unique_ptr<Statement>(new Statement(connection_, sql))).first;
+    } else {
+        it->second->reset(true);
+    }
+    return *it->second;
+}
+
+void Db::clear_statements() {
+    statements_.clear();
+}
+
+Db::Transaction::Transaction(Db &db) : db_(db) {
+    db_.prepare("BEGIN TRANSACTION").execute();
+}
+
+Db::Transaction::~Transaction() {
+    if (!done_) {
+        sqlite3_exec(db_.connection_, "ROLLBACK", nullptr, nullptr, nullptr); // no throw from a destructor
+    }
+}
+
+void Db::Transaction::commit() {
+    db_.prepare("COMMIT").execute();
+    done_ = true;
+}
+
+}// namespace sql
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "sqlite3.h"
+#include "Error.h"
+#include "Statement.h"
+
+namespace sql {
+
+// Thin owner of a sqlite3 connection.
+// - exec() runs plain SQL text, without the printf callback of the sqlite3_exec tests.
+// - prepare() hands out statements from a pool keyed by SQL text, so every distinct query is parsed only once.
+// - insert_batch() writes many rows with one reused statement, N rows per transaction.
+class Db {
+public:
+    explicit Db(const std::string &path, int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    ~Db();
+
+    Db(const Db &) = delete;
+    Db &operator=(const Db &) = delete;
+
+    void exec(const std::string &sql);
+
+    // returns the cached statement for this SQL text, reset and ready to bind.
+    // the reference stays valid until clear_statements() or the Db is destroyed.
+    Statement &prepare(const std::string &sql);
+
+    void clear_statements();
+
+    std::size_t cached_statements() const { return statements_.size(); }
+
+    // binder(Statement&, const Row&) binds one row; the statement is stepped and reset by insert_batch.
+    template<typename Rows, typename Binder>
+    void insert_batch(const std::string &sql, const Rows &rows, Binder binder, std::size_t batch_size = 10000);
+
+    int64_t last_insert_rowid() const { return sqlite3_last_insert_rowid(connection_); }
+
+    int changes() const { return sqlite3_changes(connection_); }
+
+    sqlite3 *handle() const { return connection_; }
+
+    // BEGIN on construction, ROLLBACK on destruction unless commit() was called.
+    class Transaction {
+    public:
+        explicit Transaction(Db &db);
+        ~Transaction();
+
+        Transaction(const Transaction &) = delete;
+        Transaction &operator=(const Transaction &) = delete;
+
+        void commit();
+
+    private:
+        Db &db_;
+        bool done_ = false;
+    };
+
+private:
+    sqlite3 *connection_ = nullptr;
+    std::unordered_map<std::string, std::unique_ptr<Statement>> statements_;
+};
+
+template<typename Rows, typename Binder>
+void Db::insert_batch(const std::string &sql, const Rows &rows, Binder binder, std::size_t batch_size) {
+    auto &statement = prepare(sql);
+    auto it = std::begin(rows);
+    auto last = std::end(rows);
+    while (it != last) {
+        Transaction transaction(*this);
+        for (std::size_t n = 0; n < batch_size && it != last; ++n, ++it) {
+            binder(statement, *it);
+            statement.step();
+            statement.reset();
+        }
+        transaction.commit();
+    }
+}
+
+}// namespace sql
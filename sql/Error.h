@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include "sqlite3.h"
+
+namespace sql {
+
+class Error : public std::runtime_error {
+public:
+    Error(const std::string &what, int code) : std::runtime_error(what), code_(code) {}
+
+    int code() const { return code_; }
+
+private:
+    int code_;
+};
+
+// throws sql::Error with the connection's last error message when rc is not one of the expected codes.
+inline void check(sqlite3 *connection, int rc, int expected = SQLITE_OK) {
+    if (rc != expected) {
+        throw Error(std::string("SQL error: ") + sqlite3_errmsg(connection), rc);
+    }
+}
+
+}// namespace sql
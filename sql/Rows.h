@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <boost/utility/string_view.hpp>
+#include "sqlite3.h"
+#include "Statement.h"
+
+namespace sql {
+
+// bytes of a BLOB column, borrowed from sqlite
+struct BlobView {
+    const unsigned char *data;
+    std::size_t size;
+};
+
+// View on the current row of a statement.
+// text() and blob() point into sqlite's own column buffer: nothing is copied, but the view is only valid until the
+// statement steps to the next row. Use get<std::string>() to take a copy.
+class Row {
+public:
+    explicit Row(sqlite3_stmt *stmt) : stmt_(stmt) {}
+
+    int size() const { return sqlite3_column_count(stmt_); }
+
+    bool is_null(int index) const { return sqlite3_column_type(stmt_, index) == SQLITE_NULL; }
+
+    int64_t integer(int index) const { return sqlite3_column_int64(stmt_, index); }
+
+    double real(int index) const { return sqlite3_column_double(stmt_, index); }
+
+    boost::string_view text(int index) const {
+        // sqlite3_column_text first, then sqlite3_column_bytes: the order sqlite documents for a stable pointer
+        auto data = reinterpret_cast<const char *>(sqlite3_column_text(stmt_, index));
+        return data ? boost::string_view(data, sqlite3_column_bytes(stmt_, index)) : boost::string_view();
+    }
+
+    BlobView blob(int index) const {
+        auto data = static_cast<const unsigned char *>(sqlite3_column_blob(stmt_, index));
+        return {data, static_cast<std::size_t>(sqlite3_column_bytes(stmt_, index))};
+    }
+
+    template<typename T>
+    T get(int index) const;
+
+private:
+    sqlite3_stmt *stmt_;
+};
+
+template<>
+inline int Row::get<int>(int index) const { return sqlite3_column_int(stmt_, index); }
+
+template<>
+inline int64_t Row::get<int64_t>(int index) const { return integer(index); }
+
+template<>
+inline double Row::get<double>(int index) const { return real(index); }
+
+template<>
+inline boost::string_view Row::get<boost::string_view>(int index) const { return text(index); }
+
+template<>
+inline std::string Row::get<std::string>(int index) const { return text(index).to_string(); }
+
+// Specialize for a record type to map a row into it, e.g. row_mapper<Company> in Company.h
+template<typename T>
+struct row_mapper;
+
+// Forward iterator over the rows of a statement, each increment is one sqlite3_step.
+// The statement is reset when the last row has been read, so it can be bound and run again.
+class RowIterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Row;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Row *;
+    using reference = const Row &;
+
+    RowIterator() : statement_(nullptr), row_(nullptr) {}
+
+    explicit RowIterator(Statement &statement) : statement_(&statement), row_(statement.handle()) {
+        advance();
+    }
+
+    const Row &operator*() const { return row_; }
+
+    const Row *operator->() const { return &row_; }
+
+    RowIterator &operator++() {
+        advance();
+        return *this;
+    }
+
+    bool operator==(const RowIterator &other) const { return statement_ == other.statement_; }
+
+    bool operator!=(const RowIterator &other) const { return !(*this == other); }
+
+private:
+    void advance() {
+        if (!statement_->step()) {
+            statement_->reset();
+            statement_ = nullptr; // becomes equal to end()
+        }
+    }
+
+    Statement *statement_;
+    Row row_;
+};
+
+template<typename T>
+class MappedIterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T *;
+    using reference = T;
+
+    explicit MappedIterator(RowIterator it) : it_(it) {}
+
+    T operator*() const { return row_mapper<T>::map(*it_); }
+
+    MappedIterator &operator++() {
+        ++it_;
+        return *this;
+    }
+
+    bool operator==(const MappedIterator &other) const { return it_ == other.it_; }
+
+    bool operator!=(const MappedIterator &other) const { return it_ != other.it_; }
+
+private:
+    RowIterator it_;
+};
+
+template<typename T>
+class MappedRows {
+public:
+    explicit MappedRows(Statement &statement) : statement_(statement) {}
+
+    MappedIterator<T> begin() const { return MappedIterator<T>(RowIterator(statement_)); }
+
+    MappedIterator<T> end() const { return MappedIterator<T>(RowIterator()); }
+
+private:
+    Statement &statement_;
+};
+
+// range over the result of a statement, for use in a range based for loop:
+// for (auto &&row : Rows(db.prepare("SELECT ..."))) { row.text(1) ... }
+class Rows {
+public:
+    explicit Rows(Statement &statement) : statement_(statement) {}
+
+    RowIterator begin() const { return RowIterator(statement_); }
+
+    RowIterator end() const { return RowIterator(); }
+
+    // same rows, mapped into records by row_mapper<T>
+    template<typename T>
+    MappedRows<T> as() const { return MappedRows<T>(statement_); }
+
+private:
+    Statement &statement_;
+};
+
+}// namespace sql
@@ -0,0 +1,119 @@
+#include "Statement.h"
+#include "Error.h"
+
+#include <utility>
+
+namespace sql {
+
+Statement::Statement(sqlite3 *connection, const std::string &sql) : connection_(connection) {
+    // passing the size including the terminator saves sqlite a copy of the SQL text
+    check(connection_, sqlite3_prepare_v2(connection_, sql.c_str(), (int) sql.size() + 1, &stmt_, nullptr));
+}
+
+Statement::~Statement() {
+    sqlite3_finalize(stmt_);
+}
+
+Statement::Statement(Statement &&other) noexcept
+        : connection_(other.connection_),
+          stmt_(other.stmt_) {
+    other.stmt_ = nullptr;
+}
+
+Statement &Statement::operator=(Statement &&other) noexcept {
+    if (this != &other) {
+        sqlite3_finalize(stmt_);
+        connection_ = other.connection_;
+        stmt_ = other.stmt_;
+        other.stmt_ = nullptr;
+    }
+    return *this;
+}
+
+Statement &Statement::bind(int index, int value) {
+    check(connection_, sqlite3_bind_int(stmt_, index, value));
+    return *this;
+}
+
+Statement &Statement::bind(int index, int64_t value) {
+    check(connection_, sqlite3_bind_int64(stmt_, index, value));
+    return *this;
+}
+
+Statement &Statement::bind(int index, double value) {
+    check(connection_, sqlite3_bind_double(stmt_, index, value));
+    return *this;
+}
+
+Statement &Statement::bind(int index, const std::string &value) {
+    // SQLITE_STATIC: the caller keeps the string alive until the statement has been stepped
+    check(connection_, sqlite3_bind_text(stmt_, index, value.data(), (int) value.size(), SQLITE_STATIC));
+    return *this;
+}
+
+Statement &Statement::bind(int index, const char *value) {
+    check(connection_, sqlite3_bind_text(stmt_, index, value, -1, SQLITE_STATIC));
+    return *this;
+}
+
+Statement &Statement::bind(int index, std::nullptr_t) {
+    check(connection_, sqlite3_bind_null(stmt_, index));
+    return *this;
+}
+
+Statement &Statement::bind_blob(int index, const void *data, int size) {
+    check(connection_, sqlite3_bind_blob(stmt_, index, data, size, SQLITE_STATIC));
+    return *this;
+}
+
+bool Statement::step() {
+    int rc = sqlite3_step(stmt_);
+    if (rc == SQLITE_ROW) {
+        return true;
+    }
+    check(connection_, rc, SQLITE_DONE);
+    return false;
+}
+
+void Statement::execute() {
+    step();
+    reset();
+}
+
+void Statement::reset(bool clear_bindings) {
+    sqlite3_reset(stmt_);
+    if (clear_bindings) {
+        sqlite3_clear_bindings(stmt_);
+    }
+}
+
+int Statement::column_count() const {
+    return sqlite3_column_count(stmt_);
+}
+
+bool Statement::is_null(int index) const {
+    return sqlite3_column_type(stmt_, index) == SQLITE_NULL;
+}
+
+template<>
+int Statement::column<int>(int index) const {
+    return sqlite3_column_int(stmt_, index);
+}
+
+template<>
+int64_t Statement::column<int64_t>(int index) const {
+    return sqlite3_column_int64(stmt_, index);
+}
+
+template<>
+double Statement::column<double>(int index) const {
+    return sqlite3_column_double(stmt_, index);
+}
+
+template<>
+std::string Statement::column<std::string>(int index) const {
+    auto text = reinterpret_cast<const char *>(sqlite3_column_text(stmt_, index));
+    return text ? std::string(text, sqlite3_column_bytes(stmt_, index)) : std::string();
+}
+
+}// namespace sql
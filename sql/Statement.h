@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "sqlite3.h"
+
+namespace sql {
+
+// RAII wrapper around a prepared sqlite3_stmt.
+// The statement is compiled once and can be re-executed by reset() + bind(), which skips the SQL parser.
+// Bind indices are 1-based and column indices are 0-based, just like the sqlite3 C api.
+class Statement {
+public:
+    Statement(sqlite3 *connection, const std::string &sql);
+    ~Statement();
+
+    Statement(const Statement &) = delete;
+    Statement &operator=(const Statement &) = delete;
+    Statement(Statement &&other) noexcept;
+    Statement &operator=(Statement &&other) noexcept;
+
+    Statement &bind(int index, int value);
+    Statement &bind(int index, int64_t value);
+    Statement &bind(int index, double value);
+    Statement &bind(int index, const std::string &value);
+    Statement &bind(int index, std::string &&value) = delete; // text is bound without a copy, it must outlive step()
+    Statement &bind(int index, const char *value);
+    Statement &bind(int index, std::nullptr_t);
+    Statement &bind_blob(int index, const void *data, int size);
+
+    // binds all arguments to consecutive parameters, starting at index 1
+    template<typename... Args>
+    Statement &bind_all(Args &&... args) {
+        bind_from(1, std::forward<Args>(args)...);
+        return *this;
+    }
+
+    // returns true when a row is available, false when the statement is done.
+    bool step();
+
+    // runs a statement that returns no rows (INSERT, UPDATE, DELETE, ...)
+    void execute();
+
+    // rewinds the statement so it can be executed again. clear_bindings also resets all parameters to NULL.
+    void reset(bool clear_bindings = false);
+
+    int column_count() const;
+    bool is_null(int index) const;
+
+    template<typename T>
+    T column(int index) const;
+
+    sqlite3_stmt *handle() const { return stmt_; }
+
+private:
+    void bind_from(int) {}
+
+    template<typename Arg, typename... Args>
+    void bind_from(int index, Arg &&arg, Args &&... args) {
+        bind(index, std::forward<Arg>(arg));
+        bind_from(index + 1, std::forward<Args>(args)...);
+    }
+
+    sqlite3 *connection_;
+    sqlite3_stmt *stmt_ = nullptr;
+};
+
+template<>
+int Statement::column<int>(int index) const;
+
+template<>
+int64_t Statement::column<int64_t>(int index) const;
+
+template<>
+double Statement::column<double>(int index) const;
+
+template<>
+std::string Statement::column<std::string>(int index) const;
+
+}// namespace sql
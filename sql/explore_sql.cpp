@@ -0,0 +1,747 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Db.h"
+#include "ConnectionPool.h"
+#include "Rows.h"
+#include "AsyncExecutor.h"
+#include "ArrayTable.h"
+#include "Company.h"
+#include "benchmark/Timer.h"
+
+// Prepared statements
+// The sql tests in explore_cpp.cpp push every statement through sqlite3_exec: the SQL text is parsed for every INSERT
+// and every result column is converted to text for the printf callback.
+// -> sqlite3_prepare_v2 compiles the SQL once into a sqlite3_stmt (a small byte code program)
+// -> parameters (?1, ?2...) are bound per execution with typed sqlite3_bind_* calls, no string formatting
+// -> sqlite3_step runs it, sqlite3_reset rewinds it for the next row
+// -> columns are read back typed with sqlite3_column_*
+// Transactions
+// -> without BEGIN/COMMIT every INSERT is its own transaction (and its own journal sync)
+// -> batching N rows in one transaction amortizes that cost
+
+using namespace sql;
+
+namespace {
+std::vector<Company> make_companies(int count) {
+    std::vector<Company> companies;
+    companies.reserve(count);
+    for (int i = 0; i < count; i++) {
+        companies.push_back({i, "Paul" + std::to_string(i % 100), 20 + i % 40, "California", 20000.0 + i % 1000});
+    }
+    return companies;
+}
+
+void bind_company(Statement &statement, const Company &c) {
+    statement.bind_all(c.id, c.name, c.age, c.address, c.salary);
+}
+}
+
+TEST(sql_db, prepare_bind_and_column) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+
+    std::string name = "Paul";
+    std::string address = "California";
+    db.prepare(insert_company).bind_all(1, name, 32, address, 20000.00).execute();
+    EXPECT_EQ(1, db.changes());
+
+    auto &select = db.prepare("SELECT ID, NAME, AGE, ADDRESS, SALARY FROM COMPANY WHERE ID = ?1");
+    select.bind(1, 1);
+    ASSERT_TRUE(select.step());
+    EXPECT_EQ(5, select.column_count());
+    EXPECT_EQ(1, select.column<int>(0));
+    EXPECT_EQ("Paul", select.column<std::string>(1));
+    EXPECT_EQ(32, select.column<int>(2));
+    EXPECT_EQ("California", select.column<std::string>(3));
+    EXPECT_EQ(20000.00, select.column<double>(4));
+    EXPECT_FALSE(select.step());
+}
+
+TEST(sql_db, statement_cache) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+
+    auto &first = db.prepare(insert_company);
+    auto &second = db.prepare(insert_company);
+    EXPECT_EQ(&first, &second); // same SQL text -> same compiled statement
+    EXPECT_EQ(1, db.cached_statements());
+
+    db.prepare("SELECT * FROM COMPANY");
+    EXPECT_EQ(2, db.cached_statements());
+
+    db.clear_statements();
+    EXPECT_EQ(0, db.cached_statements());
+}
+
+TEST(sql_db, null_values) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+
+    std::string name = "Allen";
+    db.prepare(insert_company).bind_all(2, name, 25, nullptr, nullptr).execute();
+
+    auto &select = db.prepare("SELECT ADDRESS, SALARY FROM COMPANY");
+    ASSERT_TRUE(select.step());
+    EXPECT_TRUE(select.is_null(0));
+    EXPECT_TRUE(select.is_null(1));
+    EXPECT_EQ("", select.column<std::string>(0));
+}
+
+TEST(sql_db, errors_throw) {
+    Db db(":memory:");
+    EXPECT_THROW(db.exec("SELECT * FROM COMPANY"), Error);     // no such table
+    EXPECT_THROW(db.prepare("SELEKT 1"), Error);                // syntax error
+
+    db.exec(create_company_table);
+    std::string name = "Paul";
+    db.prepare(insert_company).bind_all(1, name, 32, nullptr, nullptr).execute();
+    try {
+        db.prepare(insert_company).bind_all(1, name, 32, nullptr, nullptr).execute();
+        FAIL();
+    }
+    catch (const Error &e) {
+        std::cout << e.what() << std::endl;
+        EXPECT_EQ(SQLITE_CONSTRAINT, e.code()); // primary key violation
+    }
+}
+
+TEST(sql_db, transaction_rolls_back_when_not_committed) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+    std::string name = "Teddy";
+    {
+        Db::Transaction transaction(db);
+        db.prepare(insert_company).bind_all(3, name, 23, nullptr, nullptr).execute();
+    }
+    auto &count = db.prepare("SELECT COUNT(*) FROM COMPANY");
+    ASSERT_TRUE(count.step());
+    EXPECT_EQ(0, count.column<int>(0));
+
+    {
+        Db::Transaction transaction(db);
+        db.prepare(insert_company).bind_all(3, name, 23, nullptr, nullptr).execute();
+        transaction.commit();
+    }
+    auto &count2 = db.prepare("SELECT COUNT(*) FROM COMPANY");
+    ASSERT_TRUE(count2.step());
+    EXPECT_EQ(1, count2.column<int>(0));
+}
+
+TEST(sql_db, insert_batch) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+
+    auto companies = make_companies(2500);
+    db.insert_batch(insert_company, companies, bind_company, 1000); // 3 transactions
+
+    auto &select = db.prepare("SELECT COUNT(*), SUM(ID) FROM COMPANY");
+    ASSERT_TRUE(select.step());
+    EXPECT_EQ(2500, select.column<int>(0));
+    EXPECT_EQ(2500 * 2499 / 2, select.column<int64_t>(1));
+}
+
+// 1M COMPANY rows: one sqlite3_exec per generated INSERT string vs one prepared statement with bound values.
+// Both run on an in-memory database inside transactions, so the difference is parsing and text conversion,
+// not journal syncs.
+TEST(sql_benchmark, DISABLED_insert_1M_rows_exec_vs_prepared) {
+    const int rows = 1000000;
+    auto companies = make_companies(rows);
+
+    {
+        Db db(":memory:");
+        db.exec(create_company_table);
+        benchmark::Timer t("exec, generated SQL text");
+        db.exec("BEGIN TRANSACTION");
+        for (auto &&c : companies) {
+            db.exec("INSERT INTO COMPANY (ID,NAME,AGE,ADDRESS,SALARY) VALUES (" +
+                    std::to_string(c.id) + ", '" + c.name + "', " + std::to_string(c.age) + ", '" +
+                    c.address + "', " + std::to_string(c.salary) + ");");
+        }
+        db.exec("COMMIT");
+    }
+
+    {
+        Db db(":memory:");
+        db.exec(create_company_table);
+        benchmark::Timer t("prepared statement, batches of 10000");
+        db.insert_batch(insert_company, companies, bind_company, 10000);
+        t.Stop();
+
+        auto &count = db.prepare("SELECT COUNT(*) FROM COMPANY");
+        ASSERT_TRUE(count.step());
+        EXPECT_EQ(rows, count.column<int>(0));
+    }
+}
+
+// WAL (write ahead log)
+// -> default journal_mode is DELETE: a writer copies pages to a rollback journal and needs an EXCLUSIVE lock on the
+//    database file to commit, all readers are blocked (SQLITE_BUSY) during that time
+// -> in WAL mode a commit appends pages to the -wal file, readers keep reading their snapshot, so readers do not block
+//    the writer and the writer does not block readers. There is still only one writer at a time.
+// -> synchronous=NORMAL is safe in WAL mode: a power loss may roll back the last commits but never corrupts the file
+
+namespace {
+std::string copy_of_database(const std::string &name) {
+    auto path = testing::TempDir() + name;
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+    std::ifstream source(std::string(SOURCE_DIR) + "/database.db", std::ios::binary);
+    std::ofstream destination(path, std::ios::binary);
+    destination << source.rdbuf();
+    return path;
+}
+
+std::string journal_mode(Db &db) {
+    auto &statement = db.prepare("PRAGMA journal_mode");
+    statement.step();
+    return statement.column<std::string>(0);
+}
+}
+
+TEST(sql_pool, opens_database_in_wal_mode) {
+    auto path = copy_of_database("pool_wal.db");
+    ConnectionPool pool(path, PoolOptions());
+    EXPECT_EQ("wal", journal_mode(*pool.writer()));
+    EXPECT_EQ("wal", journal_mode(*pool.reader()));
+
+    auto reader = pool.reader(); // the statement belongs to the connection: keep the lease while it is used
+    auto &synchronous = reader->prepare("PRAGMA synchronous");
+    ASSERT_TRUE(synchronous.step());
+    EXPECT_EQ(1, synchronous.column<int>(0)); // NORMAL
+}
+
+TEST(sql_pool, readers_are_read_only) {
+    auto path = copy_of_database("pool_read_only.db");
+    ConnectionPool pool(path, PoolOptions());
+    auto reader = pool.reader();
+    EXPECT_THROW(reader->exec("DELETE FROM COMPANY"), Error);
+}
+
+TEST(sql_pool, reader_sees_committed_writes) {
+    auto path = copy_of_database("pool_visible.db");
+    ConnectionPool pool(path, PoolOptions());
+    {
+        auto writer = pool.writer();
+        std::string name = "Mark";
+        writer->prepare(insert_company).bind_all(100, name, 25, nullptr, nullptr).execute();
+    }
+    auto reader = pool.reader();
+    auto &select = reader->prepare("SELECT NAME FROM COMPANY WHERE ID = 100");
+    ASSERT_TRUE(select.step());
+    EXPECT_EQ("Mark", select.column<std::string>(0));
+}
+
+TEST(sql_pool, leases_return_to_pool) {
+    auto path = copy_of_database("pool_lease.db");
+    PoolOptions options;
+    options.readers = 2;
+    ConnectionPool pool(path, options);
+
+    std::atomic<int> concurrent{0};
+    std::atomic<int> max_concurrent{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < 50; j++) {
+                auto reader = pool.reader();
+                int now = ++concurrent;
+                int seen = max_concurrent;
+                while (now > seen && !max_concurrent.compare_exchange_weak(seen, now)) {}
+                reader->prepare("SELECT COUNT(*) FROM COMPANY").step();
+                --concurrent;
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_LE(max_concurrent, 2); // never more leases than connections
+}
+
+// 4 reader threads run point queries while one writer commits small transactions.
+// Rollback journal: every thread opens its own default connection, as the sql tests do.
+// WAL: the same work through the pool.
+namespace {
+const int reader_threads = 4;
+const int write_transactions = 300;
+
+void seed(Db &db) {
+    std::vector<Company> companies;
+    for (int i = 1000; i < 11000; i++) {
+        companies.push_back({i, "Paul", 20 + i % 40, "California", 20000.0 + i % 1000});
+    }
+    db.insert_batch(insert_company, companies, bind_company);
+}
+
+template<typename Writer, typename Reader>
+void concurrent_read_write(const std::string &label, Writer with_writer, Reader with_reader) {
+    std::atomic<bool> done{false};
+    std::atomic<long> reads{0};
+    benchmark::Timer t(label);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < reader_threads; i++) {
+        readers.emplace_back([&, i]() {
+            with_reader([&](Db &db) {
+                int id = 1000 + i;
+                while (!done) {
+                    auto &select = db.prepare("SELECT SALARY FROM COMPANY WHERE ID = ?1");
+                    select.bind(1, id);
+                    select.step();
+                    id = 1000 + (id + 7919) % 10000;
+                    reads++;
+                }
+            });
+        });
+    }
+    with_writer([&](Db &db) {
+        std::string name = "Allen";
+        for (int i = 0; i < write_transactions; i++) {
+            Db::Transaction transaction(db);
+            for (int j = 0; j < 10; j++) {
+                db.prepare(insert_company).bind_all(20000 + i * 10 + j, name, 25, nullptr, 15000.0).execute();
+            }
+            transaction.commit();
+        }
+    });
+    done = true;
+    for (auto &r : readers) {
+        r.join();
+    }
+    auto ms = t.ElapsedMs();
+    t.Stop();
+    std::cout << "[benchmark] " << label << ": " << reads << " reads, " << (long) (reads / ms * 1000) << " reads/s"
+              << std::endl;
+}
+}
+
+TEST(sql_benchmark, DISABLED_concurrent_read_write_rollback_journal_vs_wal) {
+    {
+        auto path = copy_of_database("rollback_journal.db");
+        {
+            Db db(path);
+            seed(db);
+        }
+        auto open = [&path](int flags) {
+            std::unique_ptr<Db> db(new Db(path, flags));
+            sqlite3_busy_timeout(db->handle(), 5000);
+            return db;
+        };
+        concurrent_read_write("rollback journal, connection per thread",
+                              [&](std::function<void(Db &)> work) {
+                                  auto db = open(SQLITE_OPEN_READWRITE);
+                                  work(*db);
+                              },
+                              [&](std::function<void(Db &)> work) {
+                                  auto db = open(SQLITE_OPEN_READONLY);
+                                  work(*db);
+                              });
+    }
+    {
+        auto path = copy_of_database("wal.db");
+        PoolOptions options;
+        options.readers = reader_threads;
+        ConnectionPool pool(path, options);
+        seed(*pool.writer());
+        concurrent_read_write("WAL, connection pool",
+                              [&](std::function<void(Db &)> work) { work(*pool.writer()); },
+                              [&](std::function<void(Db &)> work) { work(*pool.reader()); });
+    }
+}
+
+// Streaming rows
+// sqlite3_exec converts every column of every row to text and hands it over as char** to the callback.
+// -> sqlite3_step + sqlite3_column_* reads the row in place, in its stored type
+// -> sqlite3_column_text returns a pointer into sqlite's own buffer, a string_view over it costs nothing.
+//    The buffer is reused for the next row: copy (get<std::string>) what has to outlive the iteration.
+
+TEST(sql_rows, iterate_rows_as_views) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+    db.insert_batch(insert_company, make_companies(10), bind_company);
+
+    int count = 0;
+    for (auto &&row : Rows(db.prepare(select_company))) {
+        EXPECT_EQ(5, row.size());
+        EXPECT_EQ(count, row.integer(0));
+        EXPECT_EQ("Paul" + std::to_string(count), row.text(1));
+        EXPECT_EQ("California", row.text(3));
+        count++;
+    }
+    EXPECT_EQ(10, count);
+
+    // statement is reset at the end, so it can be run again
+    auto rows = Rows(db.prepare(select_company));
+    EXPECT_EQ(10, std::distance(rows.begin(), rows.end()));
+}
+
+TEST(sql_rows, empty_result) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+    auto rows = Rows(db.prepare(select_company));
+    EXPECT_EQ(rows.begin(), rows.end());
+}
+
+TEST(sql_rows, blob_and_null_columns) {
+    Db db(":memory:");
+    db.exec("CREATE TABLE DATA(ID INT, PAYLOAD BLOB)");
+    const unsigned char payload[] = {0x00, 0x01, 0xfe, 0xff};
+    db.prepare("INSERT INTO DATA VALUES (?1, ?2)").bind(1, 1).bind_blob(2, payload, sizeof(payload)).execute();
+    db.prepare("INSERT INTO DATA VALUES (?1, ?2)").bind(1, 2).bind(2, nullptr).execute();
+
+    auto &select = db.prepare("SELECT ID, PAYLOAD FROM DATA ORDER BY ID");
+    auto it = Rows(select).begin();
+    auto blob = it->blob(1);
+    ASSERT_EQ(sizeof(payload), blob.size);
+    EXPECT_EQ(0, std::memcmp(payload, blob.data, blob.size));
+
+    ++it;
+    EXPECT_TRUE(it->is_null(1));
+    EXPECT_EQ(0, it->blob(1).size);
+    EXPECT_TRUE(it->text(1).empty());
+}
+
+TEST(sql_rows, map_rows_into_records) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+    db.insert_batch(insert_company, make_companies(3), bind_company);
+
+    std::vector<Company> companies;
+    for (auto &&company : Rows(db.prepare(select_company)).as<Company>()) {
+        companies.push_back(company); // owns its strings
+    }
+    ASSERT_EQ(3, companies.size());
+    EXPECT_EQ("Paul2", companies[2].name);
+    EXPECT_EQ(22, companies[2].age);
+
+    double total = 0;
+    for (auto &&company : Rows(db.prepare(select_company)).as<CompanyView>()) {
+        EXPECT_EQ("California", company.address); // borrowed, only valid inside the loop body
+        total += company.salary;
+    }
+    EXPECT_EQ(20000.0 + 20001.0 + 20002.0, total);
+}
+
+// Scan of 1M rows: sqlite3_exec with a callback that parses the text columns back, vs the row iterator.
+namespace {
+struct ScanResult {
+    long rows = 0;
+    std::size_t name_bytes = 0;
+    double salary = 0;
+};
+
+int scan_callback(void *data, int, char **argv, char **) {
+    auto result = static_cast<ScanResult *>(data);
+    result->rows++;
+    result->name_bytes += std::string(argv[1]).size();
+    result->salary += std::atof(argv[4]);
+    return 0;
+}
+}
+
+TEST(sql_benchmark, DISABLED_scan_1M_rows_exec_vs_row_iterator) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+    db.insert_batch(insert_company, make_companies(1000000), bind_company);
+
+    ScanResult exec_result;
+    {
+        benchmark::Timer t("sqlite3_exec, text callback");
+        sqlite3_exec(db.handle(), select_company, scan_callback, &exec_result, nullptr);
+    }
+
+    ScanResult view_result;
+    {
+        benchmark::Timer t("row iterator, string_view");
+        for (auto &&row : Rows(db.prepare(select_company))) {
+            view_result.rows++;
+            view_result.name_bytes += row.text(1).size();
+            view_result.salary += row.real(4);
+        }
+    }
+
+    ScanResult copy_result;
+    {
+        benchmark::Timer t("row iterator, mapped into Company (copies strings)");
+        for (auto &&company : Rows(db.prepare(select_company)).as<Company>()) {
+            copy_result.rows++;
+            copy_result.name_bytes += company.name.size();
+            copy_result.salary += company.salary;
+        }
+    }
+
+    EXPECT_EQ(exec_result.rows, view_result.rows);
+    EXPECT_EQ(exec_result.name_bytes, view_result.name_bytes);
+    EXPECT_EQ(view_result.rows, copy_result.rows);
+    EXPECT_DOUBLE_EQ(view_result.salary, copy_result.salary);
+}
+
+// Async executor
+// The event loop thread (io_context) must not block on disk I/O: the database work is queued to a thread that owns the
+// connection, the result comes back as a completion handler on the io_context, just like an asio async operation.
+
+TEST(sql_async, read_after_write_completes_on_io_context) {
+    auto path = copy_of_database("async.db");
+    boost::asio::io_context ioc;
+    AsyncExecutor executor(path);
+
+    auto caller = std::this_thread::get_id();
+    bool written = false;
+    std::string name;
+
+    executor.async_write(ioc, [](Db &db) {
+        std::string name = "Paul";
+        db.prepare(insert_company).bind_all(100, name, 32, nullptr, nullptr).execute();
+    }, [&](std::exception_ptr error) {
+        EXPECT_FALSE(error);
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        written = true;
+    });
+
+    executor.async_read(ioc, [](Db &db) {
+        auto &select = db.prepare("SELECT NAME FROM COMPANY WHERE ID = 100");
+        select.step();
+        return select.column<std::string>(0);
+    }, [&](std::exception_ptr error, std::string result) {
+        EXPECT_FALSE(error);
+        EXPECT_TRUE(written); // jobs complete in submission order
+        name = result;
+    });
+
+    ioc.run(); // returns when both handlers have been called
+    EXPECT_EQ("Paul", name);
+}
+
+TEST(sql_async, adjacent_writes_share_one_transaction) {
+    auto path = copy_of_database("async_coalesce.db");
+    boost::asio::io_context ioc;
+    int failed = 0;
+    int succeeded = 0;
+    {
+        AsyncExecutor executor(path);
+        // park the db thread until all writes are queued, so they are adjacent in the queue
+        std::promise<void> queued;
+        auto wait_until_queued = queued.get_future().share();
+        executor.async_read(ioc, [wait_until_queued](Db &) {
+            wait_until_queued.wait();
+            return 0;
+        }, [](std::exception_ptr, int) {});
+
+        for (int i = 0; i < 100; i++) {
+            int id = 100 + (i == 50 ? 49 : i);      // write 50 violates the primary key
+            executor.async_write(ioc, [id](Db &db) {
+                std::string name = "Allen";
+                db.prepare(insert_company).bind_all(id, name, 25, nullptr, nullptr).execute();
+            }, [&](std::exception_ptr error) {
+                error ? failed++ : succeeded++;
+            });
+        }
+        queued.set_value();
+        ioc.run();
+        EXPECT_EQ(1, executor.transactions());
+    }
+    EXPECT_EQ(1, failed);
+    EXPECT_EQ(99, succeeded);
+
+    Db db(path);
+    auto &count = db.prepare("SELECT COUNT(*) FROM COMPANY WHERE ID >= 100");
+    ASSERT_TRUE(count.step());
+    EXPECT_EQ(99, count.column<int>(0)); // only the failing write was rolled back
+}
+
+TEST(sql_async, read_errors_are_passed_to_the_handler) {
+    auto path = copy_of_database("async_error.db");
+    boost::asio::io_context ioc;
+    AsyncExecutor executor(path);
+    bool called = false;
+    executor.async_read(ioc, [](Db &db) {
+        db.exec("SELECT * FROM NO_SUCH_TABLE");
+        return 0;
+    }, [&](std::exception_ptr error, int) {
+        EXPECT_TRUE(error);
+        EXPECT_THROW(std::rethrow_exception(error), Error);
+        called = true;
+    });
+    ioc.run();
+    EXPECT_TRUE(called);
+}
+
+// 2000 single row inserts on a file database: synchronous autocommit on the event loop thread vs the executor.
+TEST(sql_benchmark, DISABLED_inserts_sync_vs_async_executor) {
+    const int rows = 2000;
+    std::string name = "Teddy";
+    {
+        auto path = copy_of_database("sync_inserts.db");
+        Db db(path);
+        benchmark::Timer t("synchronous autocommit inserts on the caller thread");
+        for (int i = 0; i < rows; i++) {
+            db.prepare(insert_company).bind_all(100 + i, name, 23, nullptr, nullptr).execute();
+        }
+    }
+    {
+        auto path = copy_of_database("async_inserts.db");
+        boost::asio::io_context ioc;
+        AsyncExecutor executor(path);
+        int completed = 0;
+        benchmark::Timer t("async executor, coalesced writes");
+        for (int i = 0; i < rows; i++) {
+            executor.async_write(ioc, [i, &name](Db &db) {
+                db.prepare(insert_company).bind_all(100 + i, name, 23, nullptr, nullptr).execute();
+            }, [&completed](std::exception_ptr) {
+                completed++;
+            });
+        }
+        ioc.run();
+        t.Stop();
+        EXPECT_EQ(rows, completed);
+        std::cout << rows << " writes in " << executor.transactions() << " transactions" << std::endl;
+    }
+}
+
+// Array tables
+// WHERE ID IN (1, 2, 3, ...) with thousands of keys, or a multi row INSERT, means generating and parsing a huge SQL
+// string. A table valued function over a bound C++ array skips the SQL text completely:
+// -> the array is bound with sqlite3_bind_pointer, the virtual table reads the elements directly
+
+TEST(sql_array, in_list_from_bound_array) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+    db.insert_batch(insert_company, make_companies(100), bind_company);
+    register_array<int64_t>(db, "int64_array");
+
+    std::vector<int64_t> ids{3, 5, 7, 1000};
+    ArrayRef<int64_t> array(ids);
+    auto &select = db.prepare("SELECT ID FROM COMPANY WHERE ID IN int64_array(?1) ORDER BY ID");
+    bind_array(select, 1, array);
+
+    std::vector<int64_t> found;
+    for (auto &&row : Rows(select)) {
+        found.push_back(row.integer(0));
+    }
+    EXPECT_EQ(std::vector<int64_t>({3, 5, 7}), found);
+}
+
+TEST(sql_array, select_from_array) {
+    Db db(":memory:");
+    register_array<int64_t>(db, "int64_array");
+    std::vector<int64_t> values{1, 2, 3, 4};
+    ArrayRef<int64_t> array(values);
+    auto &select = db.prepare("SELECT SUM(value), COUNT(*) FROM int64_array(?1)");
+    bind_array(select, 1, array);
+    ASSERT_TRUE(select.step());
+    EXPECT_EQ(10, select.column<int>(0));
+    EXPECT_EQ(4, select.column<int>(1));
+}
+
+TEST(sql_array, unbound_array_is_empty) {
+    Db db(":memory:");
+    register_array<int64_t>(db, "int64_array");
+    auto &select = db.prepare("SELECT COUNT(*) FROM int64_array(?1)");
+    ASSERT_TRUE(select.step());
+    EXPECT_EQ(0, select.column<int>(0));
+}
+
+TEST(sql_array, bulk_insert_records) {
+    Db db(":memory:");
+    db.exec(create_company_table);
+    register_array<Company>(db, "company_array");
+
+    auto companies = make_companies(1000);
+    ArrayRef<Company> array(companies);
+    auto &insert = db.prepare("INSERT INTO COMPANY SELECT ID, NAME, AGE, ADDRESS, SALARY FROM company_array(?1)");
+    bind_array(insert, 1, array);
+    insert.execute();
+    EXPECT_EQ(1000, db.changes());
+
+    auto &select = db.prepare(std::string(select_company) + " WHERE ID = 999");
+    auto company = *Rows(select).as<Company>().begin();
+    EXPECT_EQ("Paul99", company.name);
+    EXPECT_EQ("California", company.address);
+}
+
+namespace {
+std::string generated_in_list(const std::vector<int64_t> &ids) {
+    std::string sql = "SELECT SALARY FROM COMPANY WHERE ID IN (";
+    for (std::size_t i = 0; i < ids.size(); i++) {
+        sql += (i ? "," : "") + std::to_string(ids[i]);
+    }
+    return sql + ")";
+}
+}
+
+TEST(sql_benchmark, DISABLED_in_list_and_bulk_insert_generated_sql_vs_array) {
+    const int rows = 1000000;
+    auto companies = make_companies(rows);
+
+    {
+        Db db(":memory:");
+        db.exec(create_company_table);
+        benchmark::Timer t("bulk insert 1M rows, generated multi row INSERT text (500 rows per statement)");
+        db.exec("BEGIN TRANSACTION");
+        for (int first = 0; first < rows; first += 500) {
+            std::string sql = "INSERT INTO COMPANY (ID,NAME,AGE,ADDRESS,SALARY) VALUES ";
+            for (int i = first; i < first + 500 && i < rows; i++) {
+                auto &c = companies[i];
+                sql += (i != first ? ",(" : "(") + std::to_string(c.id) + ",'" + c.name + "'," +
+                       std::to_string(c.age) + ",'" + c.address + "'," + std::to_string(c.salary) + ")";
+            }
+            db.exec(sql);
+        }
+        db.exec("COMMIT");
+    }
+
+    Db db(":memory:");
+    db.exec(create_company_table);
+    register_array<Company>(db, "company_array");
+    register_array<int64_t>(db, "int64_array");
+    {
+        benchmark::Timer t("bulk insert 1M rows, company_array(?1)");
+        ArrayRef<Company> array(companies);
+        Db::Transaction transaction(db);
+        auto &insert = db.prepare("INSERT INTO COMPANY SELECT ID, NAME, AGE, ADDRESS, SALARY FROM company_array(?1)");
+        bind_array(insert, 1, array);
+        insert.execute();
+        transaction.commit();
+    }
+
+    std::vector<int64_t> ids;
+    for (int64_t id = 0; id < rows; id += 200) {
+        ids.push_back(id); // 5000 keys
+    }
+    const int queries = 20;
+    double generated_total = 0;
+    {
+        benchmark::Timer t("20x IN list of 5000 keys, generated SQL text");
+        for (int q = 0; q < queries; q++) {
+            auto sql = generated_in_list(ids);
+            Statement select(db.handle(), sql); // every list is different in practice, so no statement cache
+            for (auto &&row : Rows(select)) {
+                generated_total += row.real(0);
+            }
+        }
+    }
+    double array_total = 0;
+    {
+        benchmark::Timer t("20x IN list of 5000 keys, int64_array(?1)");
+        for (int q = 0; q < queries; q++) {
+            ArrayRef<int64_t> array(ids);
+            auto &select = db.prepare("SELECT SALARY FROM COMPANY WHERE ID IN int64_array(?1)");
+            bind_array(select, 1, array);
+            for (auto &&row : Rows(select)) {
+                array_total += row.real(0);
+            }
+        }
+    }
+    EXPECT_DOUBLE_EQ(generated_total, array_total);
+}
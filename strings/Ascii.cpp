@@ -0,0 +1,191 @@
+#include "Ascii.h"
+
+#include <cstring>
+#include <locale>
+#include <boost/algorithm/string.hpp>
+#include <boost/algorithm/string/trim_all.hpp>
+
+#ifdef __SSE2__
+#define STRINGS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace strings {
+
+namespace {
+
+bool is_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// bytes >= 0x80 may still be whitespace in the global locale
+bool is_space_in_locale(unsigned char c) {
+    return c < 0x80 ? is_space(c) : std::isspace(static_cast<char>(c), std::locale());
+}
+
+#ifdef STRINGS_SSE2
+// 0xFF in every whitespace byte. Signed compares: bytes >= 0x80 are negative and never match.
+__m128i space_mask(__m128i block) {
+    auto space = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+    auto control = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('\t' - 1)),
+                                 _mm_cmplt_epi8(block, _mm_set1_epi8('\r' + 1)));
+    return _mm_or_si128(space, control);
+}
+
+__m128i load(const char *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+#endif
+
+// flips the case of the letters in [first, last], ASCII only
+template<char first, char last>
+void flip_case(char *p, std::size_t size) {
+    std::size_t i = 0;
+#ifdef STRINGS_SSE2
+    auto below = _mm_set1_epi8(first - 1);
+    auto above = _mm_set1_epi8(last + 1);
+    auto bit = _mm_set1_epi8(0x20);
+    for (; i + 16 <= size; i += 16) {
+        auto block = load(p + i);
+        auto letters = _mm_and_si128(_mm_cmpgt_epi8(block, below), _mm_cmplt_epi8(block, above));
+        block = _mm_xor_si128(block, _mm_and_si128(letters, bit));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p + i), block);
+    }
+#endif
+    for (; i < size; i++) {
+        p[i] ^= (p[i] >= first && p[i] <= last) ? 0x20 : 0;
+    }
+}
+
+}// namespace
+
+bool is_ascii(boost::string_view s) {
+    std::size_t i = 0;
+    auto p = s.data();
+#ifdef STRINGS_SSE2
+    auto high = _mm_setzero_si128();
+    for (; i + 16 <= s.size(); i += 16) {
+        high = _mm_or_si128(high, load(p + i));
+    }
+    if (_mm_movemask_epi8(high)) {
+        return false;
+    }
+#endif
+    unsigned char tail = 0;
+    for (; i < s.size(); i++) {
+        tail |= static_cast<unsigned char>(p[i]);
+    }
+    return tail < 0x80;
+}
+
+boost::string_view trim_left(boost::string_view s) {
+    auto p = s.data();
+    std::size_t i = 0;
+#ifdef STRINGS_SSE2
+    for (; i + 16 <= s.size(); i += 16) {
+        auto other = ~_mm_movemask_epi8(space_mask(load(p + i))) & 0xFFFF;
+        if (other) {
+            i += __builtin_ctz(other);
+            break;
+        }
+    }
+#endif
+    while (i < s.size() && is_space_in_locale(static_cast<unsigned char>(p[i]))) {
+        i++;
+    }
+    return s.substr(i);
+}
+
+boost::string_view trim_right(boost::string_view s) {
+    auto p = s.data();
+    auto size = s.size();
+#ifdef STRINGS_SSE2
+    while (size >= 16) {
+        auto other = ~_mm_movemask_epi8(space_mask(load(p + size - 16))) & 0xFFFF;
+        if (other) {
+            size -= 16 - (32 - __builtin_clz(other)); // keep up to the last non whitespace byte
+            break;
+        }
+        size -= 16;
+    }
+#endif
+    while (size > 0 && is_space_in_locale(static_cast<unsigned char>(p[size - 1]))) {
+        size--;
+    }
+    return s.substr(0, size);
+}
+
+boost::string_view trim(boost::string_view s) {
+    return trim_right(trim_left(s));
+}
+
+void trim_all(std::string &s) {
+    if (!is_ascii(s)) {
+        boost::algorithm::trim_all(s, std::locale());
+        return;
+    }
+    char *p = &s[0];
+    std::size_t size = s.size();
+    std::size_t write = 0;
+    std::size_t read = 0;
+    bool previous_space = true; // drops the leading whitespace
+#ifdef STRINGS_SSE2
+    // blocks without two whitespace bytes in a row (and not starting one) are moved as a whole
+    for (; read + 16 <= size; read += 16) {
+        auto block = load(p + read);
+        unsigned spaces = _mm_movemask_epi8(space_mask(block));
+        if (spaces & ((spaces << 1) | previous_space)) {
+            for (int i = 0; i < 16; i++) {
+                bool space = (spaces >> i) & 1;
+                p[write] = p[read + i];
+                write += !(space && previous_space);
+                previous_space = space;
+            }
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(p + write), block); // write <= read, block is loaded
+            write += 16;
+            previous_space = spaces >> 15;
+        }
+    }
+#endif
+    for (; read < size; read++) {
+        bool space = is_space(static_cast<unsigned char>(p[read]));
+        p[write] = p[read];
+        write += !(space && previous_space);
+        previous_space = space;
+    }
+    if (write > 0 && previous_space) {
+        write--; // the trailing run left its first character
+    }
+    s.resize(write);
+}
+
+void to_upper(std::string &s) {
+    if (!is_ascii(s)) {
+        boost::algorithm::to_upper(s, std::locale());
+        return;
+    }
+    flip_case<'a', 'z'>(&s[0], s.size());
+}
+
+void to_lower(std::string &s) {
+    if (!is_ascii(s)) {
+        boost::algorithm::to_lower(s, std::locale());
+        return;
+    }
+    flip_case<'A', 'Z'>(&s[0], s.size());
+}
+
+std::string to_upper_copy(boost::string_view s) {
+    std::string result(s.data(), s.size());
+    to_upper(result);
+    return result;
+}
+
+std::string to_lower_copy(boost::string_view s) {
+    std::string result(s.data(), s.size());
+    to_lower(result);
+    return result;
+}
+
+}// namespace strings
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <boost/utility/string_view.hpp>
+
+namespace strings {
+
+// ASCII fast paths for the boost::algorithm string functions (trim, trim_all, to_upper, to_lower).
+// boost::algorithm calls std::isspace / std::toupper with a std::locale for every character, and the _copy variants
+// allocate. Here 16 bytes are classified at once (SSE2) and nothing allocates except to_upper_copy / to_lower_copy.
+// -> whitespace is the "C" locale set: ' ', '\t', '\n', '\v', '\f', '\r'
+// -> input with bytes >= 0x80 takes the locale path of boost::algorithm with the global std::locale, so the results
+//    are the same as boost for non-ASCII text
+
+bool is_ascii(boost::string_view s);
+
+// views into s, nothing is copied
+boost::string_view trim_left(boost::string_view s);
+
+boost::string_view trim_right(boost::string_view s);
+
+boost::string_view trim(boost::string_view s);
+
+// boost::algorithm::trim_all in place: trims, then compacts every inner whitespace run to its first character
+void trim_all(std::string &s);
+
+void to_upper(std::string &s);
+
+void to_lower(std::string &s);
+
+std::string to_upper_copy(boost::string_view s);
+
+std::string to_lower_copy(boost::string_view s);
+
+}// namespace strings
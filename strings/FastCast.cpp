@@ -0,0 +1,455 @@
+#include "FastCast.h"
+
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace strings {
+
+namespace detail {
+// 128 bit approximations of 5^q for q in [-342, 308] and 10^k for k in [-292, 326], see PowerTables.cpp
+extern const uint64_t powers_of_five[651][2];
+extern const uint64_t powers_of_ten[619][2];
+}
+
+namespace {
+
+uint64_t load8(const char *p) {
+    uint64_t chunk;
+    std::memcpy(&chunk, p, 8); // little endian: p[0] in the lowest byte
+    return chunk;
+}
+
+// every byte in '0'..'9': adding 0x46 must not carry into the high bit (byte <= '9') and subtracting 0x30 must not
+// borrow (byte >= '0')
+bool is_eight_digits(uint64_t chunk) {
+    return !(((chunk + 0x4646464646464646) | (chunk - 0x3030303030303030)) & 0x8080808080808080);
+}
+
+// 8 digits -> number in three multiplications: pairs, then quads, then the octet
+uint32_t parse_eight_digits(uint64_t chunk) {
+    const uint64_t mask = 0x000000FF000000FF;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+    chunk -= 0x3030303030303030;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return uint32_t(chunk);
+}
+
+bool is_digit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+bool starts_with_nocase(const char *first, const char *last, const char *word) {
+    for (; *word; ++word, ++first) {
+        if (first == last || (*first | 0x20) != *word) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char digit_pairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+int count_digits(uint64_t n) {
+    int digits = 1;
+    for (;;) {
+        if (n < 10) return digits;
+        if (n < 100) return digits + 1;
+        if (n < 1000) return digits + 2;
+        if (n < 10000) return digits + 3;
+        n /= 10000;
+        digits += 4;
+    }
+}
+
+const double exact_powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Eisel-Lemire for w * 10^q, w != 0, returns the bits of the (positive) double.
+// Port of fast_float's compute_float<binary64>, the 128 bit product is always precise enough to round correctly
+// (Mushtak & Lemire, "Fast number parsing without fallback").
+uint64_t eisel_lemire(uint64_t w, int64_t q) {
+    const int mantissa_bits = 52;
+    if (q < -342) {
+        return 0;
+    }
+    if (q > 308) {
+        return uint64_t(0x7FF) << mantissa_bits;
+    }
+    int lz = __builtin_clzll(w);
+    w <<= lz;
+
+    const uint64_t *power = detail::powers_of_five[q + 342];
+    unsigned __int128 first = static_cast<unsigned __int128>(w) * power[0];
+    uint64_t high = uint64_t(first >> 64);
+    uint64_t low = uint64_t(first);
+    const uint64_t precision_mask = ~uint64_t(0) >> (mantissa_bits + 3);
+    if ((high & precision_mask) == precision_mask) { // the low half of the power may still carry into the result
+        unsigned __int128 second = static_cast<unsigned __int128>(w) * power[1];
+        uint64_t second_high = uint64_t(second >> 64);
+        low += second_high;
+        if (second_high > low) {
+            high++;
+        }
+    }
+
+    int upperbit = int(high >> 63);
+    int shift = upperbit + 64 - mantissa_bits - 3;
+    uint64_t mantissa = high >> shift;
+    // floor(log2(10^q)) = floor(q * log2(10)), 217706 / 2^16 ~ log2(10)
+    int64_t power2 = (((152170 + 65536) * q) >> 16) + 63 + upperbit - lz + 1023;
+
+    if (power2 <= 0) { // subnormal
+        if (-power2 + 1 >= 64) {
+            return 0;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < (uint64_t(1) << mantissa_bits) ? 0 : 1;
+        return (uint64_t(power2) << mantissa_bits) | (mantissa & ~(uint64_t(1) << mantissa_bits));
+    }
+
+    // exactly halfway between two doubles: round to even instead of up (only possible for small q)
+    if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == high) {
+        mantissa &= ~uint64_t(1);
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (uint64_t(2) << mantissa_bits)) {
+        mantissa = uint64_t(1) << mantissa_bits;
+        power2++;
+    }
+    mantissa &= ~(uint64_t(1) << mantissa_bits);
+    if (power2 >= 0x7FF) {
+        return uint64_t(0x7FF) << mantissa_bits;
+    }
+    return (uint64_t(power2) << mantissa_bits) | mantissa;
+}
+
+double from_bits(uint64_t bits) {
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// adds one digit to the significand, keeps at most 19 digits (10^19 - 1 fits in 64 bits)
+struct Significand {
+    uint64_t value = 0;
+    int digits = 0;
+    int64_t exponent = 0;
+    bool truncated = false;
+
+    void add(unsigned digit, bool fraction) {
+        if (digits < 19) {
+            value = value * 10 + digit;
+            digits += value != 0; // leading zeros are not significant
+            exponent -= fraction;
+        } else {
+            truncated |= digit != 0;
+            exponent += !fraction;
+        }
+    }
+
+    void add_eight(uint64_t chunk, bool fraction) {
+        value = value * 100000000 + parse_eight_digits(chunk);
+        digits += 8;
+        exponent -= fraction ? 8 : 0;
+    }
+
+    template<bool fraction>
+    const char *parse(const char *p, const char *last) {
+        while (value != 0 && digits <= 11 && last - p >= 8 && is_eight_digits(load8(p))) {
+            add_eight(load8(p), fraction);
+            p += 8;
+        }
+        for (; p != last && is_digit(*p); ++p) {
+            add(unsigned(*p - '0'), fraction);
+        }
+        return p;
+    }
+};
+
+
+// Schubfach (Giulietti, "The Schubfach way to render doubles"), after Bolz's C++ port: the shortest decimal in the
+// rounding interval of the double, the closest one to it when there are several.
+struct Decimal {
+    uint64_t digits;
+    int exponent;
+};
+
+// cp * g / 2^128 rounded to odd: the low bit is set when anything was cut off
+uint64_t round_to_odd(const uint64_t *g, uint64_t cp) {
+    unsigned __int128 x = static_cast<unsigned __int128>(cp) * g[1];
+    unsigned __int128 y = static_cast<unsigned __int128>(cp) * g[0] + uint64_t(x >> 64);
+    return uint64_t(y >> 64) | (uint64_t(y) > 1);
+}
+
+Decimal shortest_decimal(uint64_t ieee_significand, uint64_t ieee_exponent) {
+    uint64_t c;
+    int q;
+    if (ieee_exponent != 0) {
+        c = (uint64_t(1) << 52) | ieee_significand;
+        q = int(ieee_exponent) - 1075;
+        // small integers
+        if (q <= 0 && -q < 53 && (c & ((uint64_t(1) << -q) - 1)) == 0) {
+            return {c >> -q, 0};
+        }
+    } else {
+        c = ieee_significand;
+        q = -1074;
+    }
+
+    bool accept_bounds = c % 2 == 0; // round to even when parsing, so an even c owns its interval bounds
+    bool lower_boundary_is_closer = ieee_significand == 0 && ieee_exponent > 1;
+
+    // the interval [cbl, cbr] around cb = 4c, in units of 2^(q - 2)
+    uint64_t cbl = 4 * c - 2 + lower_boundary_is_closer;
+    uint64_t cb = 4 * c;
+    uint64_t cbr = 4 * c + 2;
+
+    // k = floor(log10(2^q)), or floor(log10(3/4 2^q)) when the lower boundary is closer
+    int k = (q * 1262611 - (lower_boundary_is_closer ? 524031 : 0)) >> 22;
+    // h = q + floor(log2(10^-k)) + 1
+    int h = q + ((-k * 1741647) >> 19) + 1;
+
+    const uint64_t *g = detail::powers_of_ten[-k + 292];
+    uint64_t vbl = round_to_odd(g, cbl << h);
+    uint64_t vb = round_to_odd(g, cb << h);
+    uint64_t vbr = round_to_odd(g, cbr << h);
+    uint64_t lower = vbl + !accept_bounds;
+    uint64_t upper = vbr - !accept_bounds;
+
+    uint64_t s = vb / 4;
+    if (s >= 10) { // one digit less
+        uint64_t sp = s / 10;
+        bool up_inside = lower <= 40 * sp;
+        bool wp_inside = 40 * sp + 40 <= upper;
+        if (up_inside != wp_inside) {
+            return {sp + wp_inside, k + 1};
+        }
+    }
+    bool u_inside = lower <= 4 * s;
+    bool w_inside = 4 * s + 4 <= upper;
+    if (u_inside != w_inside) {
+        return {s + w_inside, k};
+    }
+    uint64_t mid = 4 * s + 2;
+    bool round_up = vb > mid || (vb == mid && (s & 1) != 0);
+    return {s + round_up, k};
+}
+
+// digits * 10^exponent in printf %.17g notation, trailing zeros removed
+char *write_decimal(char *p, uint64_t digits, int exponent) {
+    while (digits % 10 == 0) {
+        digits /= 10;
+        exponent++;
+    }
+    char text[20];
+    int length = int(detail::format_integer(text, text + sizeof(text), digits, false).ptr - text);
+    int point = exponent + length - 1; // exponent of the first digit
+
+    if (point < -4 || point >= 17) {
+        *p++ = text[0];
+        if (length > 1) {
+            *p++ = '.';
+            p = std::copy(text + 1, text + length, p);
+        }
+        *p++ = 'e';
+        *p++ = point < 0 ? '-' : '+';
+        int magnitude = point < 0 ? -point : point;
+        if (magnitude < 10) {
+            *p++ = '0';
+        }
+        return detail::format_integer(p, p + 3, uint64_t(magnitude), false).ptr;
+    }
+    if (point < 0) {
+        *p++ = '0';
+        *p++ = '.';
+        p = std::fill_n(p, -point - 1, '0');
+        return std::copy(text, text + length, p);
+    }
+    if (exponent >= 0) {
+        p = std::copy(text, text + length, p);
+        return std::fill_n(p, exponent, '0');
+    }
+    p = std::copy(text, text + point + 1, p);
+    *p++ = '.';
+    return std::copy(text + point + 1, text + length, p);
+}
+
+}// namespace
+
+ParseResult detail::parse_digits(const char *first, const char *last, uint64_t &value) {
+    auto p = first;
+    while (p != last && *p == '0') {
+        ++p;
+    }
+    auto significant = p;
+    uint64_t result = 0;
+    // 19 digits never overflow
+    while (p - significant <= 11 && last - p >= 8 && is_eight_digits(load8(p))) {
+        result = result * 100000000 + parse_eight_digits(load8(p));
+        p += 8;
+    }
+    bool overflow = false;
+    for (; p != last && is_digit(*p); ++p) {
+        overflow |= __builtin_mul_overflow(result, 10, &result);
+        overflow |= __builtin_add_overflow(result, uint64_t(*p - '0'), &result);
+    }
+    if (p == first) {
+        return {first, std::errc::invalid_argument};
+    }
+    if (overflow) {
+        return {p, std::errc::result_out_of_range};
+    }
+    value = result;
+    return {p, std::errc()};
+}
+
+FormatResult detail::format_integer(char *first, char *last, uint64_t magnitude, bool negative) {
+    int length = count_digits(magnitude) + negative;
+    if (last - first < length) {
+        return {last, std::errc::value_too_large};
+    }
+    if (negative) {
+        *first = '-';
+    }
+    char *p = first + length;
+    while (magnitude >= 100) {
+        auto pair = (magnitude % 100) * 2;
+        magnitude /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (magnitude >= 10) {
+        *--p = digit_pairs[magnitude * 2 + 1];
+        *--p = digit_pairs[magnitude * 2];
+    } else {
+        *--p = char('0' + magnitude);
+    }
+    return {first + length, std::errc()};
+}
+
+ParseResult from_chars(const char *first, const char *last, double &value) {
+    auto p = first;
+    bool negative = p != last && *p == '-';
+    p += negative;
+
+    if (p != last && !is_digit(*p) && *p != '.') {
+        double special;
+        if (starts_with_nocase(p, last, "inf")) {
+            p += starts_with_nocase(p, last, "infinity") ? 8 : 3;
+            special = HUGE_VAL;
+        } else if (starts_with_nocase(p, last, "nan")) {
+            p += 3;
+            special = std::nan("");
+        } else {
+            return {first, std::errc::invalid_argument};
+        }
+        value = negative ? -special : special;
+        return {p, std::errc()};
+    }
+
+    Significand significand;
+    auto digits_begin = p;
+    while (p != last && *p == '0') {
+        ++p;
+    }
+    p = significand.parse<false>(p, last);
+    bool has_digits = p != digits_begin;
+    if (p != last && *p == '.') {
+        auto fraction_begin = ++p;
+        if (significand.value == 0) {
+            for (; p != last && *p == '0'; ++p) {
+                significand.exponent--;
+            }
+        }
+        p = significand.parse<true>(p, last);
+        has_digits |= p != fraction_begin;
+    }
+    if (!has_digits) {
+        return {first, std::errc::invalid_argument};
+    }
+
+    if (p != last && (*p == 'e' || *p == 'E')) {
+        auto e = p + 1;
+        bool negative_exponent = e != last && *e == '-';
+        e += e != last && (*e == '-' || *e == '+');
+        if (e != last && is_digit(*e)) {
+            int64_t exponent = 0;
+            for (; e != last && is_digit(*e); ++e) {
+                if (exponent < 100000) { // saturate, anything past this is zero or infinity anyway
+                    exponent = exponent * 10 + (*e - '0');
+                }
+            }
+            significand.exponent += negative_exponent ? -exponent : exponent;
+            p = e;
+        } // else: "1e" parses as 1 and leaves the 'e'
+    }
+
+    double result;
+    auto w = significand.value;
+    auto q = significand.exponent;
+    if (w == 0) {
+        result = 0;
+    } else if (!significand.truncated && q >= -22 && q <= 22 && w <= (uint64_t(1) << 53)) {
+        // Clinger's fast path: both operands are exact doubles, so one correctly rounded operation
+        result = q < 0 ? double(w) / exact_powers_of_ten[-q] : double(w) * exact_powers_of_ten[q];
+    } else {
+        auto bits = eisel_lemire(w, q);
+        // the dropped digits put the exact value between w and w + 1, fine if both round the same way
+        if (significand.truncated && bits != eisel_lemire(w + 1, q)) {
+            result = std::strtod(std::string(first + negative, p).c_str(), nullptr); // "C" locale decimal point
+        } else {
+            result = from_bits(bits);
+        }
+    }
+    if (std::isinf(result) || (result == 0 && w != 0)) {
+        return {p, std::errc::result_out_of_range};
+    }
+    value = negative ? -result : result;
+    return {p, std::errc()};
+}
+
+FormatResult to_chars(char *first, char *last, double value) {
+    char buffer[max_chars];
+    char *p = buffer;
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if (bits >> 63) {
+        *p++ = '-';
+    }
+    uint64_t ieee_significand = bits & ((uint64_t(1) << 52) - 1);
+    uint64_t ieee_exponent = (bits >> 52) & 0x7FF;
+
+    if (ieee_exponent == 0x7FF) {
+        const char *text = ieee_significand ? "nan" : "inf";
+        p = std::copy(text, text + 3, p);
+    } else if (ieee_exponent == 0 && ieee_significand == 0) {
+        *p++ = '0';
+    } else {
+        auto decimal = shortest_decimal(ieee_significand, ieee_exponent);
+        p = write_decimal(p, decimal.digits, decimal.exponent);
+    }
+    auto length = p - buffer;
+    if (last - first < length) {
+        return {last, std::errc::value_too_large};
+    }
+    return {std::copy(buffer, p, first), std::errc()};
+}
+
+}// namespace strings
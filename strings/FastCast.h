@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <typeinfo>
+#include <boost/utility/string_view.hpp>
+
+namespace strings {
+
+// Number <-> text conversion without iostreams, locales or allocation, a replacement for boost::lexical_cast on hot
+// paths. The interface follows std::from_chars / std::to_chars (C++17):
+// -> no leading whitespace, no '+', a '-' only for signed and floating point types
+// -> errors are returned, ec is std::errc() on success
+// -> invalid_argument: nothing was parsed, ptr == first
+// -> result_out_of_range: ptr is past the number, value is unchanged
+// -> to_chars returns value_too_large with ptr == last when the buffer is too small
+
+struct ParseResult {
+    const char *ptr;
+    std::errc ec;
+};
+
+struct FormatResult {
+    char *ptr;
+    std::errc ec;
+};
+
+namespace detail {
+// digits only, 8 at a time when they are checked and converted with SWAR (8 ascii digits in one uint64_t)
+ParseResult parse_digits(const char *first, const char *last, uint64_t &value);
+
+FormatResult format_integer(char *first, char *last, uint64_t magnitude, bool negative);
+
+template<typename Int>
+using IfInteger = typename std::enable_if<std::is_integral<Int>::value && !std::is_same<Int, bool>::value>::type;
+
+// the types with a from_chars / to_chars: integers other than bool, and double
+template<typename T>
+using IsNumber = std::integral_constant<bool, (std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+                                              std::is_same<T, double>::value>;
+}
+
+template<typename Int, typename = detail::IfInteger<Int>>
+ParseResult from_chars(const char *first, const char *last, Int &value) {
+    bool negative = std::is_signed<Int>::value && first != last && *first == '-';
+    uint64_t magnitude;
+    auto result = detail::parse_digits(first + negative, last, magnitude);
+    if (result.ec == std::errc::invalid_argument) {
+        return {first, result.ec};
+    }
+    uint64_t limit = uint64_t(std::numeric_limits<Int>::max()) + negative;
+    if (result.ec == std::errc::result_out_of_range || magnitude > limit) {
+        return {result.ptr, std::errc::result_out_of_range};
+    }
+    value = static_cast<Int>(negative ? 0 - magnitude : magnitude);
+    return result;
+}
+
+// Eisel-Lemire: exact for up to 19 significant digits with one or two 64x64 bit multiplications against a table of
+// 128 bit powers of five, correctly rounded (to nearest, ties to even).
+// Longer inputs that it cannot round with certainty fall back to strtod.
+ParseResult from_chars(const char *first, const char *last, double &value);
+
+template<typename Int, typename = detail::IfInteger<Int>>
+FormatResult to_chars(char *first, char *last, Int value) {
+    bool negative = value < 0;
+    uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    return detail::format_integer(first, last, magnitude, negative);
+}
+
+// Shortest text that parses back to the same double (Schubfach), in the notation of printf %.17g: "0.1", "1e+20",
+// "-inf", "nan". lexical_cast always writes 17 significant digits ("0.10000000000000001").
+FormatResult to_chars(char *first, char *last, double value);
+
+// enough for any integer or double
+constexpr std::size_t max_chars = 32;
+
+class BadCast : public std::bad_cast {
+public:
+    const char *what() const noexcept override { return "bad fast_cast: source is not a number of the target type"; }
+};
+
+// Throwing wrapper in the style of boost::lexical_cast:
+//   int n = fast_cast<int>("123");
+//   std::string s = fast_cast<std::string>(0.1);
+// The whole source has to be a number, out of range values throw as well. Numbers are integers other than bool, and
+// double: a float or bool converts to / from those explicitly.
+template<typename Target, typename Source>
+typename std::enable_if<detail::IsNumber<Target>::value, Target>::type fast_cast(const Source &source) {
+    boost::string_view text(source);
+    Target value;
+    auto result = from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+        throw BadCast();
+    }
+    return value;
+}
+
+template<typename Target, typename Source>
+typename std::enable_if<std::is_same<Target, std::string>::value && detail::IsNumber<Source>::value,
+        std::string>::type fast_cast(Source source) {
+    char buffer[max_chars];
+    auto result = to_chars(buffer, buffer + sizeof(buffer), source);
+    return std::string(buffer, result.ptr);
+}
+
+}// namespace strings
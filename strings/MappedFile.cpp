@@ -0,0 +1,43 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace strings {
+
+MappedFile::MappedFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        auto error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "fstat " + path);
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ > 0) { // mmap of length 0 fails, an empty file is an empty view
+        void *data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            auto error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "mmap " + path);
+        }
+        ::madvise(data, size_, MADV_SEQUENTIAL); // read ahead aggressively, drop pages behind
+        data_ = static_cast<const char *>(data);
+    }
+    ::close(fd); // the mapping stays valid
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        ::munmap(const_cast<char *>(data_), size_);
+    }
+}
+
+}// namespace strings
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <boost/utility/string_view.hpp>
+
+namespace strings {
+
+// Read-only memory map of a whole file (POSIX mmap), the pages are read by the kernel on demand.
+// Tokenizing a mapped file avoids copying multi-GB inputs through read() buffers.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    boost::string_view view() const { return boost::string_view(data_, size_); }
+
+    std::size_t size() const { return size_; }
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}// namespace strings
@@ -0,0 +1,201 @@
+#include "Tokenizer.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define STRINGS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace strings {
+
+namespace {
+
+const std::size_t max_avx2_delimiters = 8;
+const std::size_t max_sse42_delimiters = 16;
+
+uint64_t classify_scalar(const char *block, const CharSeparator &separator) {
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i++) {
+        auto c = static_cast<unsigned char>(block[i]);
+        mask |= uint64_t(separator.is_dropped(c) | separator.is_kept(c)) << i;
+    }
+    return mask;
+}
+
+#ifdef STRINGS_X86_SIMD
+__attribute__((target("avx2")))
+uint64_t classify_avx2(const char *block, const CharSeparator &separator) {
+    auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+    auto hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+    auto match_lo = _mm256_setzero_si256();
+    auto match_hi = _mm256_setzero_si256();
+    for (char delimiter : separator.delimiters()) {
+        auto needle = _mm256_set1_epi8(delimiter);
+        match_lo = _mm256_or_si256(match_lo, _mm256_cmpeq_epi8(lo, needle));
+        match_hi = _mm256_or_si256(match_hi, _mm256_cmpeq_epi8(hi, needle));
+    }
+    return uint64_t(uint32_t(_mm256_movemask_epi8(match_lo))) |
+           (uint64_t(uint32_t(_mm256_movemask_epi8(match_hi))) << 32);
+}
+
+__attribute__((target("sse4.2")))
+uint64_t classify_sse42(const char *block, const CharSeparator &separator) {
+    char set[16] = {};
+    std::memcpy(set, separator.delimiters().data(), separator.delimiters().size());
+    auto needles = _mm_loadu_si128(reinterpret_cast<const __m128i *>(set));
+    auto count = static_cast<int>(separator.delimiters().size());
+    const int mode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+    uint64_t mask = 0;
+    for (int i = 0; i < 4; i++) {
+        auto data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i * 16));
+        auto match = _mm_cmpestrm(needles, count, data, 16, mode);
+        mask |= uint64_t(uint32_t(_mm_cvtsi128_si32(match)) & 0xffff) << (i * 16);
+    }
+    return mask;
+}
+#endif
+
+void set_bits(uint64_t (&bits)[4], const char *chars) {
+    for (; *chars; chars++) {
+        auto c = static_cast<unsigned char>(*chars);
+        bits[c >> 6] |= uint64_t(1) << (c & 63);
+    }
+}
+
+}// namespace
+
+bool kernel_supported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::automatic:
+        case Kernel::scalar:
+            return true;
+#ifdef STRINGS_X86_SIMD
+        case Kernel::sse42:
+            return __builtin_cpu_supports("sse4.2");
+        case Kernel::avx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+CharSeparator::CharSeparator(const char *dropped, const char *kept, EmptyTokens empty_tokens, Kernel kernel)
+        : empty_tokens_(empty_tokens) {
+    set_bits(dropped_, dropped);
+    set_bits(kept_, kept);
+    for (int c = 0; c < 256; c++) {
+        if (is_dropped(c) || is_kept(c)) {
+            delimiters_.push_back(static_cast<char>(c));
+        }
+    }
+
+    if (kernel == Kernel::automatic) {
+        if (delimiters_.size() <= max_avx2_delimiters && kernel_supported(Kernel::avx2)) {
+            kernel = Kernel::avx2;
+        } else if (delimiters_.size() <= max_sse42_delimiters && kernel_supported(Kernel::sse42)) {
+            kernel = Kernel::sse42;
+        } else {
+            kernel = Kernel::scalar;
+        }
+    }
+    if (!kernel_supported(kernel) ||
+        (kernel == Kernel::avx2 && delimiters_.size() > max_avx2_delimiters) ||
+        (kernel == Kernel::sse42 && delimiters_.size() > max_sse42_delimiters)) {
+        throw std::invalid_argument("CharSeparator: kernel not supported for this cpu or delimiter set");
+    }
+    kernel_ = kernel;
+    classify_ = classify_scalar;
+#ifdef STRINGS_X86_SIMD
+    if (kernel_ == Kernel::avx2) {
+        classify_ = classify_avx2;
+    } else if (kernel_ == Kernel::sse42) {
+        classify_ = classify_sse42;
+    }
+#endif
+}
+
+Tokenizer::iterator::iterator(boost::string_view input, const CharSeparator &separator)
+        : separator_(&separator),
+          end_(input.data() + input.size()),
+          next_(input.data()),
+          done_(input.empty()) { // like boost::token_iterator, empty input has no tokens in either policy
+    if (!done_) {
+        advance();
+    }
+}
+
+const char *Tokenizer::iterator::find_delimiter(const char *from) {
+    while (from < end_) {
+        if (!block_ || from < block_ || from >= block_ + 64) {
+            block_ = from;
+            auto available = end_ - block_;
+            if (available >= 64) {
+                mask_ = separator_->classify(block_);
+            } else {
+                char tail[64] = {};
+                std::memcpy(tail, block_, available);
+                mask_ = separator_->classify(tail) & ((uint64_t(1) << available) - 1);
+            }
+        }
+        auto remaining = mask_ & (~uint64_t(0) << (from - block_));
+        if (remaining) {
+            return block_ + __builtin_ctzll(remaining);
+        }
+        from = block_ + 64;
+    }
+    return end_;
+}
+
+// the state machine of boost::char_separator, with the search for the end of a token done by find_delimiter
+void Tokenizer::iterator::advance() {
+    auto &separator = *separator_;
+    auto next = next_;
+    const char *start;
+
+    if (separator.empty_tokens() == EmptyTokens::drop) {
+        while (next != end_ && separator.is_dropped(*next)) {
+            ++next;
+        }
+        if (next == end_) {
+            done_ = true;
+            return;
+        }
+        start = next;
+        if (separator.is_kept(*next)) {
+            ++next;
+        } else {
+            next = find_delimiter(next);
+        }
+    } else {
+        start = next;
+        if (next == end_) {
+            if (output_done_) {
+                done_ = true;
+                return;
+            }
+            output_done_ = true; // empty token at the end
+        } else if (separator.is_kept(*next)) {
+            if (!output_done_) {
+                output_done_ = true;
+            } else {
+                ++next;
+                output_done_ = false;
+            }
+        } else if (!output_done_ && separator.is_dropped(*next)) {
+            output_done_ = true;
+        } else {
+            if (separator.is_dropped(*next)) {
+                start = ++next;
+            }
+            next = find_delimiter(next);
+            output_done_ = true;
+        }
+    }
+    token_ = boost::string_view(start, next - start);
+    next_ = next;
+}
+
+}// namespace strings
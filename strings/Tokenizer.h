@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <boost/utility/string_view.hpp>
+
+namespace strings {
+
+// same meaning as boost::drop_empty_tokens / boost::keep_empty_tokens
+enum class EmptyTokens {
+    drop,
+    keep
+};
+
+// instruction set used to find delimiters, automatic picks the best one the cpu supports
+enum class Kernel {
+    automatic,
+    scalar,
+    sse42,
+    avx2
+};
+
+bool kernel_supported(Kernel kernel);
+
+// Delimiter set with the semantics of boost::char_separator:
+// -> dropped delimiters separate tokens and are not returned
+// -> kept delimiters separate tokens and are returned as a token of their own
+// Delimiters are found 64 bytes at a time: every block is classified into a 64 bit mask of delimiter positions
+// -> avx2: one byte compare per delimiter per 32 bytes (up to 8 delimiters)
+// -> sse4.2: pcmpestrm matches up to 16 delimiters per 16 bytes in one instruction
+// -> scalar: 256 bit lookup table
+class CharSeparator {
+public:
+    explicit CharSeparator(const char *dropped, const char *kept = "", EmptyTokens empty_tokens = EmptyTokens::drop,
+                           Kernel kernel = Kernel::automatic);
+
+    bool is_dropped(unsigned char c) const { return (dropped_[c >> 6] >> (c & 63)) & 1; }
+
+    bool is_kept(unsigned char c) const { return (kept_[c >> 6] >> (c & 63)) & 1; }
+
+    EmptyTokens empty_tokens() const { return empty_tokens_; }
+
+    Kernel kernel() const { return kernel_; }
+
+    const std::string &delimiters() const { return delimiters_; }
+
+    // bit i is set when block[i] is a (dropped or kept) delimiter, block must have 64 readable bytes
+    uint64_t classify(const char *block) const { return classify_(block, *this); }
+
+private:
+    uint64_t dropped_[4] = {};
+    uint64_t kept_[4] = {};
+    std::string delimiters_;
+    EmptyTokens empty_tokens_;
+    Kernel kernel_;
+    uint64_t (*classify_)(const char *, const CharSeparator &);
+};
+
+// Tokenizer that returns boost::string_view tokens pointing into the input, where boost::tokenizer builds a
+// std::string per token. Nothing is allocated per token: the input (e.g. a MappedFile) must outlive the tokens.
+// The separator is copied, like boost::tokenizer copies its TokenizerFunc; iterators refer to that copy, so they
+// must not outlive the Tokenizer.
+class Tokenizer {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = boost::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const boost::string_view *;
+        using reference = const boost::string_view &;
+
+        iterator() = default;
+
+        iterator(boost::string_view input, const CharSeparator &separator);
+
+        reference operator*() const { return token_; }
+
+        pointer operator->() const { return &token_; }
+
+        iterator &operator++() {
+            advance();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator previous = *this;
+            advance();
+            return previous;
+        }
+
+        bool operator==(const iterator &other) const {
+            return done_ == other.done_ && (done_ || (next_ == other.next_ && token_.data() == other.token_.data()));
+        }
+
+        bool operator!=(const iterator &other) const { return !(*this == other); }
+
+    private:
+        void advance();
+
+        // first delimiter at or after `from`, or end_
+        const char *find_delimiter(const char *from);
+
+        const CharSeparator *separator_ = nullptr;
+        const char *end_ = nullptr;
+        const char *next_ = nullptr;
+        const char *block_ = nullptr;   // start of the classified 64 byte block
+        uint64_t mask_ = 0;             // delimiter positions in that block
+        bool output_done_ = false;
+        bool done_ = true;
+        boost::string_view token_;
+    };
+
+    Tokenizer(boost::string_view input, CharSeparator separator) : input_(input), separator_(std::move(separator)) {}
+
+    iterator begin() const { return iterator(input_, separator_); }
+
+    iterator end() const { return iterator(); }
+
+private:
+    boost::string_view input_;
+    CharSeparator separator_;
+};
+
+}// namespace strings
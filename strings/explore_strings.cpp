@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <boost/algorithm/string/trim_all.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/tokenizer.hpp>
+
+#include "Ascii.h"
+#include "FastCast.h"
+#include "Tokenizer.h"
+#include "MappedFile.h"
+#include "benchmark/Timer.h"
+
+// string_view tokenizer
+// boost::tokenizer (string_token_demo in boost_lib.cpp) assigns every token to a std::string: one allocation per token
+// longer than the small string buffer, and a copy of every byte.
+// A string_view token is just a pointer and a length into the input buffer.
+
+using namespace strings;
+
+namespace {
+std::vector<std::string> boost_tokens(const std::string &s, const char *dropped, const char *kept,
+                                      boost::empty_token_policy empty) {
+    boost::char_separator<char> sep(dropped, kept, empty);
+    boost::tokenizer<boost::char_separator<char>> tokens(s, sep);
+    return std::vector<std::string>(tokens.begin(), tokens.end());
+}
+
+std::vector<std::string> our_tokens(const std::string &s, const CharSeparator &separator) {
+    std::vector<std::string> result;
+    for (auto &&token : Tokenizer(s, separator)) {
+        result.push_back(token.to_string());
+    }
+    return result;
+}
+
+std::vector<Kernel> supported_kernels() {
+    std::vector<Kernel> kernels;
+    for (auto kernel : {Kernel::scalar, Kernel::sse42, Kernel::avx2}) {
+        if (kernel_supported(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+}
+
+TEST(tokenizer, string_token_demo) {
+    std::string s = "To be, or not to be?";
+
+    CharSeparator sep("o", " ", EmptyTokens::keep);
+    std::vector<std::string> expected{"T", "", " ", "be,", " ", "", "r", " ", "n", "t", " ", "t", "", " ", "be?"};
+    EXPECT_EQ(expected, our_tokens(s, sep));
+    EXPECT_EQ(boost_tokens(s, "o", " ", boost::keep_empty_tokens), our_tokens(s, sep));
+
+    // tokens point into s
+    auto first = *Tokenizer(s, sep).begin();
+    EXPECT_EQ(s.data(), first.data());
+
+    // the tokenizer keeps its own copy of a temporary separator
+    Tokenizer words(s, CharSeparator(" ,?"));
+    std::vector<std::string> tokens;
+    for (auto &&token : words) {
+        tokens.push_back(token.to_string());
+    }
+    EXPECT_EQ((std::vector<std::string>{"To", "be", "or", "not", "to", "be"}), tokens);
+}
+
+TEST(tokenizer, same_tokens_as_boost_for_every_kernel_and_policy) {
+    std::mt19937 random(42);
+    const std::string alphabet = "abc ,;\n\t.xyz";
+    for (int round = 0; round < 200; round++) {
+        std::string s;
+        auto length = random() % 300; // crosses the 64 byte blocks and the tail handling
+        for (std::size_t i = 0; i < length; i++) {
+            s.push_back(alphabet[random() % alphabet.size()]);
+        }
+        for (auto kernel : supported_kernels()) {
+            for (auto empty : {EmptyTokens::drop, EmptyTokens::keep}) {
+                auto boost_empty = empty == EmptyTokens::drop ? boost::drop_empty_tokens : boost::keep_empty_tokens;
+                CharSeparator sep(" \n\t", ",;", empty, kernel);
+                ASSERT_EQ(boost_tokens(s, " \n\t", ",;", boost_empty), our_tokens(s, sep)) << s;
+            }
+        }
+    }
+}
+
+TEST(tokenizer, many_delimiters_fall_back) {
+    // 20 delimiters: too many for avx2 (8) and sse4.2 (16)
+    CharSeparator sep("abcdefghijklmnopqrst");
+    EXPECT_EQ(Kernel::scalar, sep.kernel());
+    EXPECT_EQ(std::vector<std::string>({"1", "2", "3"}), our_tokens("1a2bt3", sep));
+    EXPECT_THROW(CharSeparator("abcdefghijklmnopqrst", "", EmptyTokens::drop, Kernel::avx2), std::invalid_argument);
+}
+
+TEST(tokenizer, empty_input) {
+    CharSeparator drop(" ");
+    EXPECT_TRUE(our_tokens("", drop).empty());
+    EXPECT_TRUE(our_tokens("    ", drop).empty());
+    CharSeparator keep(" ", "", EmptyTokens::keep);
+    EXPECT_EQ(boost_tokens("", " ", "", boost::keep_empty_tokens), our_tokens("", keep));
+}
+
+TEST(tokenizer, tokenize_mapped_file) {
+    auto path = testing::TempDir() + "tokenize_mapped_file.txt";
+    {
+        std::ofstream file(path);
+        file << "2021-01-10 12:00:01 INFO  started\n2021-01-10 12:00:02 WARN  slow subscriber\n";
+    }
+    MappedFile file(path);
+    CharSeparator sep(" \n");
+    std::vector<std::string> tokens;
+    for (auto &&token : Tokenizer(file.view(), sep)) {
+        tokens.push_back(token.to_string());
+    }
+    EXPECT_EQ(std::vector<std::string>({"2021-01-10", "12:00:01", "INFO", "started", "2021-01-10", "12:00:02",
+                                        "WARN", "slow", "subscriber"}), tokens);
+    EXPECT_THROW(MappedFile("/no/such/file"), std::system_error);
+}
+
+// 64MB of log lines, tokenized on " ,=\n"
+TEST(strings_benchmark, DISABLED_tokenize_log_boost_vs_string_view) {
+    auto path = testing::TempDir() + "tokenize_benchmark.log";
+    {
+        std::ofstream file(path);
+        std::mt19937 random(1);
+        std::size_t written = 0;
+        while (written < 64 * 1024 * 1024) {
+            std::string line = "2021-01-10 12:00:" + std::to_string(random() % 60) + " INFO subscriber=" +
+                               std::to_string(random()) + ", message=well done player scored goal number " +
+                               std::to_string(random() % 10) + "\n";
+            file << line;
+            written += line.size();
+        }
+    }
+    MappedFile file(path);
+    std::string copy = file.view().to_string(); // boost::tokenizer needs a container
+
+    std::size_t boost_count = 0;
+    std::size_t boost_bytes = 0;
+    {
+        benchmark::Timer t("boost::tokenizer, std::string tokens");
+        boost::char_separator<char> sep(" ,=\n");
+        boost::tokenizer<boost::char_separator<char>> tokens(copy, sep);
+        for (auto &&token : tokens) {
+            boost_count++;
+            boost_bytes += token.size();
+        }
+    }
+    for (auto kernel : supported_kernels()) {
+        std::size_t count = 0;
+        std::size_t bytes = 0;
+        CharSeparator sep(" ,=\n", "", EmptyTokens::drop, kernel);
+        {
+            const char *names[] = {"automatic", "scalar", "sse4.2", "avx2"};
+            benchmark::Timer t(std::string("string_view tokenizer on mapped file, ") + names[int(kernel)]);
+            for (auto &&token : Tokenizer(file.view(), sep)) {
+                count++;
+                bytes += token.size();
+            }
+        }
+        EXPECT_EQ(boost_count, count);
+        EXPECT_EQ(boost_bytes, bytes);
+    }
+}
+
+// fast_cast
+// boost::lexical_cast goes through a std::stringstream-like buffer: iostream state, the locale's num_get / num_put
+// facets and an exception on failure. from_chars / to_chars only look at the characters.
+// -> integers: 8 digits are validated and converted at once inside one uint64_t (SWAR)
+// -> doubles: Clinger's fast path, then Eisel-Lemire, strtod only for >19 digits that sit on a rounding boundary
+
+TEST(fast_cast, integers) {
+    EXPECT_EQ(123, fast_cast<int>("123"));
+    EXPECT_EQ(-2147483648, fast_cast<int>("-2147483648"));
+    EXPECT_EQ(18446744073709551615ull, fast_cast<unsigned long long>("18446744073709551615"));
+    EXPECT_EQ(42, fast_cast<int>("0000000000000000000000042"));
+    EXPECT_EQ("-9223372036854775808", fast_cast<std::string>(std::numeric_limits<int64_t>::min()));
+    EXPECT_EQ("0", fast_cast<std::string>(0));
+
+    EXPECT_THROW(fast_cast<int>("abcdefg"), BadCast);
+    EXPECT_THROW(fast_cast<int>("2147483648"), BadCast);
+    EXPECT_THROW(fast_cast<unsigned>("-1"), BadCast);
+    EXPECT_THROW(fast_cast<int>("12 "), BadCast);
+    EXPECT_THROW(fast_cast<int>(""), BadCast);
+
+    // from_chars reports instead of throwing
+    std::string s = "99999999999999999999x";
+    int64_t value = 7;
+    auto result = from_chars(s.data(), s.data() + s.size(), value);
+    EXPECT_EQ(std::errc::result_out_of_range, result.ec);
+    EXPECT_EQ('x', *result.ptr);
+    EXPECT_EQ(7, value);
+    result = from_chars(s.data() + 20, s.data() + s.size(), value);
+    EXPECT_EQ(std::errc::invalid_argument, result.ec);
+
+    std::mt19937_64 random(3);
+    for (int i = 0; i < 100000; i++) {
+        auto n = int64_t(random()) >> (random() % 64);
+        ASSERT_EQ(n, fast_cast<int64_t>(fast_cast<std::string>(n)));
+        ASSERT_EQ(std::to_string(n), fast_cast<std::string>(n));
+    }
+}
+
+TEST(fast_cast, doubles) {
+    EXPECT_EQ(3.14, fast_cast<double>("3.14"));
+    EXPECT_EQ(-1e-300, fast_cast<double>("-1e-300"));
+    EXPECT_EQ(0.5, fast_cast<double>(".5"));
+    EXPECT_EQ(4.9406564584124654e-324, fast_cast<double>("4.9406564584124654e-324"));
+    EXPECT_TRUE(std::isinf(fast_cast<double>("-Infinity")));
+    EXPECT_TRUE(std::isnan(fast_cast<double>("nan")));
+    EXPECT_THROW(fast_cast<double>("1e400"), BadCast);
+    EXPECT_THROW(fast_cast<double>("1e-400"), BadCast);
+    EXPECT_THROW(fast_cast<double>("+1"), BadCast);
+    EXPECT_THROW(fast_cast<double>("."), BadCast);
+
+    std::string s = "1.5e";
+    double d;
+    auto result = from_chars(s.data(), s.data() + s.size(), d);
+    EXPECT_EQ(1.5, d);
+    EXPECT_EQ('e', *result.ptr);
+
+    // shortest round trip
+    EXPECT_EQ("0.1", fast_cast<std::string>(0.1));
+    EXPECT_EQ("0.30000000000000004", fast_cast<std::string>(0.1 + 0.2));
+    EXPECT_EQ("1e+20", fast_cast<std::string>(1e20));
+    EXPECT_EQ("-0", fast_cast<std::string>(-0.0));
+    EXPECT_EQ("-inf", fast_cast<std::string>(-HUGE_VAL));
+    EXPECT_EQ("123456", fast_cast<std::string>(123456.0));
+    EXPECT_EQ("0.0001", fast_cast<std::string>(1e-4));
+    EXPECT_EQ("1e-05", fast_cast<std::string>(1e-5));
+    EXPECT_EQ("5e-324", fast_cast<std::string>(4.9406564584124654e-324));
+    EXPECT_EQ("1.7976931348623157e+308", fast_cast<std::string>(std::numeric_limits<double>::max()));
+    EXPECT_EQ("9007199254740994", fast_cast<std::string>(9007199254740994.0)); // 2^53 + 2
+    EXPECT_EQ("1.5", fast_cast<std::string>(1.5));
+    EXPECT_EQ("0.10000000000000001", boost::lexical_cast<std::string>(0.1));
+}
+
+TEST(fast_cast, doubles_agree_with_strtod) {
+    std::mt19937_64 random(5);
+    for (int i = 0; i < 200000; i++) {
+        // any finite double formats and parses back to itself, the first 2046 are the powers of two whose lower
+        // neighbour is closer
+        uint64_t bits = i < 2046 ? uint64_t(i + 1) << 52 : random();
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        if (!std::isfinite(d)) continue;
+        auto text = fast_cast<std::string>(d);
+        ASSERT_EQ(bits, [&] {
+            double parsed = fast_cast<double>(text);
+            uint64_t parsed_bits;
+            std::memcpy(&parsed_bits, &parsed, sizeof(parsed));
+            return parsed_bits;
+        }()) << text;
+        ASSERT_EQ(std::strtod(text.c_str(), nullptr), fast_cast<double>(text));
+        // the first precision that round trips gives the shortest digits, correctly rounded
+        char reference[max_chars];
+        for (int precision = 1; precision <= 17; precision++) {
+            std::snprintf(reference, sizeof(reference), "%.*e", precision - 1, d);
+            if (std::strtod(reference, nullptr) == d) break;
+        }
+        ASSERT_EQ(std::strtod(reference, nullptr), d);
+        std::string digits = text.substr(0, text.find('e'));
+        digits.erase(std::remove(digits.begin(), digits.end(), '.'), digits.end());
+        digits.erase(0, digits.find_first_not_of("-0"));
+        std::string reference_digits(reference, std::strchr(reference, 'e'));
+        reference_digits.erase(std::remove(reference_digits.begin(), reference_digits.end(), '.'),
+                               reference_digits.end());
+        reference_digits.erase(0, reference_digits.find_first_not_of('-'));
+        reference_digits.erase(reference_digits.find_last_not_of('0') + 1);
+        digits.erase(digits.find_last_not_of('0') + 1);
+        if (bits & ((uint64_t(1) << 52) - 1)) {
+            ASSERT_EQ(reference_digits, digits) << text;
+        } else {
+            // the rounding interval of a power of two is narrower below, the shortest digits can be rounded up
+            ASSERT_LE(digits.size(), reference_digits.size()) << text;
+        }
+
+        // random decimal strings, up to 30 digits so some take the truncated path
+        std::string decimal = std::to_string(random() % 1000000000) + std::to_string(random()) + "." +
+                              std::to_string(random()).substr(0, random() % 12) + "e" +
+                              std::to_string(int(random() % 660) - 340);
+        double parsed;
+        auto result = from_chars(decimal.data(), decimal.data() + decimal.size(), parsed);
+        double expected = std::strtod(decimal.c_str(), nullptr);
+        if (result.ec == std::errc()) {
+            ASSERT_EQ(expected, parsed) << decimal;
+        } else {
+            ASSERT_TRUE(std::isinf(expected) || expected == 0) << decimal;
+        }
+    }
+}
+
+TEST(strings_benchmark, DISABLED_parse_and_format_lexical_cast_vs_fast_cast) {
+    const int n = 1000000;
+    std::mt19937_64 random(9);
+    std::vector<std::string> integers;
+    std::vector<std::string> doubles;
+    for (int i = 0; i < n; i++) {
+        integers.push_back(std::to_string(int(random())));
+        double d;
+        do {
+            auto bits = random();
+            std::memcpy(&d, &bits, sizeof(d));
+        } while (!std::isfinite(d));
+        doubles.push_back(boost::lexical_cast<std::string>(d)); // 17 digits
+    }
+
+    int64_t sum = 0;
+    {
+        benchmark::Timer t("parse 1M int, boost::lexical_cast");
+        for (auto &s : integers) sum += boost::lexical_cast<int>(s);
+    }
+    {
+        benchmark::Timer t("parse 1M int, std::strtol");
+        for (auto &s : integers) sum -= std::strtol(s.c_str(), nullptr, 10);
+    }
+    {
+        benchmark::Timer t("parse 1M int, fast_cast");
+        for (auto &s : integers) sum += fast_cast<int>(s);
+    }
+    double total = 0;
+    {
+        benchmark::Timer t("parse 1M double, boost::lexical_cast");
+        for (auto &s : doubles) total += boost::lexical_cast<double>(s);
+    }
+    {
+        benchmark::Timer t("parse 1M double, std::strtod");
+        for (auto &s : doubles) total -= std::strtod(s.c_str(), nullptr);
+    }
+    {
+        benchmark::Timer t("parse 1M double, fast_cast");
+        for (auto &s : doubles) total += fast_cast<double>(s);
+    }
+    benchmark::DoNotOptimize(sum);
+    benchmark::DoNotOptimize(total);
+
+    std::size_t bytes = 0;
+    {
+        benchmark::Timer t("format 1M int, boost::lexical_cast");
+        for (auto &s : integers) bytes += boost::lexical_cast<std::string>(s.size() * 1000003).size();
+    }
+    {
+        benchmark::Timer t("format 1M int, to_chars");
+        char buffer[max_chars];
+        for (auto &s : integers) bytes += to_chars(buffer, buffer + max_chars, s.size() * 1000003).ptr - buffer;
+    }
+    std::vector<double> values;
+    for (auto &s : doubles) values.push_back(fast_cast<double>(s));
+    {
+        benchmark::Timer t("format 1M double, boost::lexical_cast (17 digits)");
+        for (auto d : values) bytes += boost::lexical_cast<std::string>(d).size();
+    }
+    {
+        benchmark::Timer t("format 1M double, to_chars (shortest)");
+        char buffer[max_chars];
+        for (auto d : values) bytes += to_chars(buffer, buffer + max_chars, d).ptr - buffer;
+    }
+    benchmark::DoNotOptimize(bytes);
+}
+
+// ASCII trim / trim_all / case conversion
+// string_algorthm_string in boost_lib.cpp: boost::algorithm asks the locale about every character.
+// For ASCII the answers are known, so 16 characters are classified with a few SSE2 compares.
+
+namespace {
+std::string random_text(std::mt19937 &random, std::size_t length) {
+    const std::string alphabet = "  \t\r\nabcXYZ019,.-_@";
+    std::string s;
+    for (std::size_t i = 0; i < length; i++) {
+        s.push_back(alphabet[random() % alphabet.size()]);
+    }
+    return s;
+}
+}
+
+TEST(ascii, string_algorthm_string) {
+    std::string t = "hello world\r\n";
+    EXPECT_EQ("hello world", strings::trim(t));
+    EXPECT_EQ(t.data(), strings::trim(t).data()); // a view, nothing copied
+
+    std::string t2 = "hello    world\r\n";
+    strings::trim_all(t2);
+    EXPECT_EQ("hello world", t2);
+
+    strings::to_upper(t2);
+    EXPECT_EQ("HELLO WORLD", t2);
+    EXPECT_EQ("HELLO WORLD\r\n", strings::to_upper_copy(t));
+    EXPECT_EQ("hello world\r\n", strings::to_lower_copy("HeLLo WoRLD\r\n"));
+
+    EXPECT_EQ("Matilda the hen", strings::trim("      \t Matilda the hen  \r\n   "));
+    EXPECT_EQ("", strings::trim(" \t\r\n\v\f                    "));
+}
+
+TEST(ascii, same_result_as_boost) {
+    std::mt19937 random(11);
+    for (int round = 0; round < 2000; round++) {
+        auto s = random_text(random, random() % 100);
+
+        EXPECT_EQ(boost::algorithm::trim_copy(s), strings::trim(s));
+        EXPECT_EQ(boost::algorithm::trim_left_copy(s), strings::trim_left(s));
+        EXPECT_EQ(boost::algorithm::trim_right_copy(s), strings::trim_right(s));
+
+        auto expected = s;
+        auto actual = s;
+        boost::algorithm::trim_all(expected);
+        strings::trim_all(actual);
+        ASSERT_EQ(expected, actual) << s;
+
+        EXPECT_EQ(boost::algorithm::to_upper_copy(s), strings::to_upper_copy(s));
+        EXPECT_EQ(boost::algorithm::to_lower_copy(s), strings::to_lower_copy(s));
+    }
+}
+
+TEST(ascii, non_ascii_takes_the_locale_path) {
+    std::string s = "  caf\xc3\xa9   cr\xc3\xa8me  ";
+    EXPECT_FALSE(strings::is_ascii(s));
+    EXPECT_TRUE(strings::is_ascii("plain ascii text, longer than one sse2 block"));
+
+    auto expected = s;
+    auto actual = s;
+    boost::algorithm::trim_all(expected);
+    strings::trim_all(actual);
+    EXPECT_EQ(expected, actual);
+
+    expected = s;
+    actual = s;
+    boost::algorithm::to_upper(expected);
+    strings::to_upper(actual);
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(boost::algorithm::trim_copy(s), strings::trim(s));
+}
+
+// normalizing 1M lines of user input: trim, collapse whitespace, upper case
+TEST(strings_benchmark, DISABLED_normalize_boost_vs_ascii) {
+    std::mt19937 random(13);
+    std::vector<std::string> lines;
+    for (int i = 0; i < 1000000; i++) {
+        lines.push_back("   " + random_text(random, 20 + random() % 100) + " \r\n");
+    }
+
+    auto boost_lines = lines;
+    {
+        benchmark::Timer t("boost::algorithm trim_copy + trim_all + to_upper");
+        for (auto &line : boost_lines) {
+            line = boost::algorithm::trim_copy(line);
+            boost::algorithm::trim_all(line);
+            boost::algorithm::to_upper(line);
+        }
+    }
+    auto ascii_lines = lines;
+    {
+        benchmark::Timer t("strings:: trim (view) + trim_all + to_upper, in place");
+        std::size_t trimmed = 0;
+        for (auto &line : ascii_lines) {
+            trimmed += strings::trim(line).size();
+            strings::trim_all(line);
+            strings::to_upper(line);
+        }
+        benchmark::DoNotOptimize(trimmed);
+    }
+    EXPECT_EQ(boost_lines, ascii_lines);
+}